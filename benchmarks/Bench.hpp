@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ds::bench {
+
+/// A benchmark runs its workload `iterations` times per call
+struct Benchmark {
+    std::string name;
+    std::function<void(uint64_t iterations)> run;
+    /// Items processed by a single iteration, used for the throughput column
+    double itemsPerIteration = 1.0;
+    /// What the throughput is measured in
+    std::string itemName = "ops";
+};
+
+/// A check runs before any benchmark, the run is aborted if any check fails
+struct Check {
+    std::string name;
+    std::function<bool()> run;
+};
+
+std::vector<Benchmark>& Benchmarks();
+std::vector<Check>& Checks();
+
+struct Registrar {
+    explicit Registrar(Benchmark benchmark) { Benchmarks().push_back(std::move(benchmark)); }
+    explicit Registrar(Check check) { Checks().push_back(std::move(check)); }
+};
+
+/// Prevents the compiler from optimizing away a computed value
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+} // namespace ds::bench
+
+#define DS_BENCH_CONCAT_IMPL(a, b) a##b
+#define DS_BENCH_CONCAT(a, b) DS_BENCH_CONCAT_IMPL(a, b)
+
+#define DS_BENCHMARK(...) static ::ds::bench::Registrar DS_BENCH_CONCAT(benchmarkRegistrar, __LINE__)(::ds::bench::Benchmark{__VA_ARGS__})
+#define DS_BENCHMARK_CHECK(...) static ::ds::bench::Registrar DS_BENCH_CONCAT(checkRegistrar, __LINE__)(::ds::bench::Check{__VA_ARGS__})
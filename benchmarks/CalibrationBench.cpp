@@ -0,0 +1,107 @@
+#include "Bench.hpp"
+
+#include <Daisy/Calibration.hpp>
+#include <Daisy/Crc32.hpp>
+#include <Daisy/Daisy.hpp>
+
+#include <cmath>
+#include <cstring>
+
+using namespace ds;
+using namespace ds::bench;
+
+/// A controller whose gyro reads 2% high with a bias of 10 counts, and whose accelerometer reads 8000 counts per g around 100
+static report::CalibrationReport SkewedCalibration() {
+    report::CalibrationReport calibration{};
+    calibration.reportId = report::CALIBRATION_REPORT_ID;
+    calibration.gyroPitchBias = calibration.gyroYawBias = calibration.gyroRollBias = 10;
+    calibration.gyroSpeedPlus = calibration.gyroSpeedMinus = 540;
+    const auto gyroReading = static_cast<int16_t>(std::lround(540.0f * NominalGyroCountsPerDegreePerSecond * 1.02f));
+    calibration.gyroPitchPlus = calibration.gyroYawPlus = calibration.gyroRollPlus = static_cast<int16_t>(10 + gyroReading);
+    calibration.gyroPitchMinus = calibration.gyroYawMinus = calibration.gyroRollMinus = static_cast<int16_t>(10 - gyroReading);
+    calibration.accelXPlus = calibration.accelYPlus = calibration.accelZPlus = 8100;
+    calibration.accelXMinus = calibration.accelYMinus = calibration.accelZMinus = -7900;
+    return calibration;
+}
+
+static bool IsNear(float value, float expected, float tolerance = 1e-3f) { return std::abs(value - expected) < tolerance; }
+
+static bool IsCalibrated(const ControllerInput& input) {
+    // the raw gyro readings are rounded to whole counts, which are a bit over 0.06 deg/s
+    return IsNear(input.angularVelocity.pitch, 90.0f, 0.05f) && IsNear(input.angularVelocity.yaw, -90.0f, 0.05f) &&
+           IsNear(input.angularVelocity.roll, 90.0f, 0.05f) &&
+           IsNear(input.acceleration.x, 1.0f) && IsNear(input.acceleration.y, -1.0f) && IsNear(input.acceleration.z, 0.0f);
+}
+
+/// Raw readings of 90 deg/s, -90 deg/s and 90 deg/s, and of 1 g, -1 g and 0 g with the accelerometer of @see SkewedCalibration
+static report::InputReportData CalibratedReport(const MotionCalibration& calibration) {
+    const auto raw = [](float value, float scale, float offset) { return static_cast<uint16_t>(static_cast<int16_t>(std::lround((value - offset) / scale))); };
+    report::InputReportData report{};
+    report.gyroPitch = raw(90.0f, calibration.gyroScale.pitch, calibration.gyroOffset.pitch);
+    report.gyroYaw = raw(-90.0f, calibration.gyroScale.yaw, calibration.gyroOffset.yaw);
+    report.gyroRoll = raw(90.0f, calibration.gyroScale.roll, calibration.gyroOffset.roll);
+    report.accelX = 100 + 8000;
+    report.accelY = static_cast<uint16_t>(100 - 8000);
+    report.accelZ = 100;
+    return report;
+}
+
+static bool CheckParseCalibration() {
+    const auto calibration = SkewedCalibration();
+    MotionCalibration parsed{};
+    if (!ParseCalibrationReport(reinterpret_cast<const uint8_t*>(&calibration), sizeof(calibration), false, &parsed))
+        return false;
+    if (!IsNear(parsed.gyroScale.pitch * NominalGyroCountsPerDegreePerSecond * 1.02f, 1.0f) || !IsNear(parsed.accelScale.x * 8000.0f, 1.0f))
+        return false;
+    return IsCalibrated(FromInputReport(CalibratedReport(parsed), parsed));
+}
+DS_BENCHMARK_CHECK("Calibration report gives bias-corrected deg/s and g", CheckParseCalibration);
+
+static bool CheckRejectCalibration() {
+    auto calibration = SkewedCalibration();
+    auto* bytes = reinterpret_cast<uint8_t*>(&calibration);
+    MotionCalibration parsed = NominalMotionCalibration;
+    // bluetooth reports without a valid crc
+    if (ParseCalibrationReport(bytes, sizeof(calibration), true, &parsed))
+        return false;
+    calibration.crc = Crc32(BluetoothFeatureCrcSeed, bytes, offsetof(report::CalibrationReport, crc), false);
+    if (!ParseCalibrationReport(bytes, sizeof(calibration), true, &parsed))
+        return false;
+
+    // an all-zero report, like a controller that didn't answer properly
+    report::CalibrationReport empty{};
+    empty.reportId = report::CALIBRATION_REPORT_ID;
+    parsed = NominalMotionCalibration;
+    return !ParseCalibrationReport(reinterpret_cast<const uint8_t*>(&empty), sizeof(empty), false, &parsed) &&
+           parsed.gyroScale.pitch == NominalMotionCalibration.gyroScale.pitch;
+}
+DS_BENCHMARK_CHECK("Corrupt calibration reports are rejected", CheckRejectCalibration);
+
+#if defined(DAISY_PLATFORM_VIRTUAL)
+static bool CheckManagerReadsCalibration() {
+    if (DaisyManager::Initialize() != Result::OK)
+        return false;
+    DaisyManager* manager = DaisyManager::Get();
+    VirtualManager* platform = manager->GetPlatform();
+
+    auto calibration = SkewedCalibration();
+    calibration.crc = Crc32(BluetoothFeatureCrcSeed, reinterpret_cast<const uint8_t*>(&calibration), offsetof(report::CalibrationReport, crc), false);
+    const auto calibrated = platform->CreateController(VirtualTransport::Bluetooth);
+    platform->SetFeatureReport(calibrated, &calibration, sizeof(calibration));
+    const auto uncalibrated = platform->CreateController(VirtualTransport::Usb);
+    manager->Tick();
+
+    MotionCalibration parsed{};
+    bool ok = manager->GetMotionCalibration(calibrated, &parsed) == Result::OK && !IsNear(parsed.gyroOffset.pitch, 0.0f);
+    ControllerInput input{};
+    platform->InjectReport(calibrated, CalibratedReport(parsed));
+    ok &= manager->GetControllerData(calibrated, &input) == Result::OK && IsCalibrated(input);
+
+    ok &= manager->GetMotionCalibration(uncalibrated, &parsed) == Result::OK && parsed.gyroScale.pitch == NominalMotionCalibration.gyroScale.pitch;
+    platform->InjectReport(uncalibrated, CalibratedReport(NominalMotionCalibration));
+    ok &= manager->GetControllerData(uncalibrated, &input) == Result::OK && IsNear(input.angularVelocity.pitch, 90.0f, 0.05f);
+    DaisyManager::Shutdown();
+    return ok;
+}
+DS_BENCHMARK_CHECK("Manager reads the calibration on connect", CheckManagerReadsCalibration);
+#endif
@@ -0,0 +1,198 @@
+#include "Bench.hpp"
+
+#include <Daisy/ControllerOutput.hpp>
+#include <Daisy/Daisy.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace ds;
+using namespace ds::bench;
+
+#if defined(DAISY_PLATFORM_VIRTUAL)
+constexpr size_t ContentionControllerCount = 4;
+/// Sent reports are taken every so often, the virtual platform would keep them all otherwise
+constexpr uint64_t SentReportsTakeInterval = 64;
+
+static report::OutputReportData RumbleOutput(uint64_t i) {
+    const auto value = static_cast<uint8_t>(i);
+    return OutputBuilder().SetLeftMotor(value).SetRightMotor(value).Build();
+}
+
+static bool IsExpectedResult(Result res) { return res == Result::OK || res == Result::TIMEOUT || res == Result::CONTROLLER_NOT_FOUND; }
+
+/// Readers and writers hammer the controllers while they keep getting disconnected and replaced by the ticking thread
+static bool CheckConcurrentHotplug() {
+    if (DaisyManager::Initialize() != Result::OK)
+        return false;
+    DaisyManager* manager = DaisyManager::Get();
+    VirtualManager* platform = manager->GetPlatform();
+    for (size_t i = 0; i < ContentionControllerCount; i++) {
+        platform->CreateController(i % 2 == 0 ? VirtualTransport::Usb : VirtualTransport::Bluetooth);
+    }
+    manager->Tick();
+
+    std::atomic<bool> running{true};
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < 4; thread++) {
+        threads.emplace_back([&, thread] {
+            std::vector<ControllerHandle> controllers;
+            ControllerInput input{};
+            for (uint64_t i = 0; running.load(std::memory_order_relaxed); i++) {
+                manager->AvailableControllers(&controllers);
+                for (auto controller : controllers) {
+                    Result res = Result::OK;
+                    if (thread % 2 == 0) {
+                        platform->InjectReport(controller, report::InputReportData{});
+                        res = manager->GetControllerData(controller, &input);
+                    } else {
+                        res = manager->SetControllerData(controller, RumbleOutput(i));
+                    }
+                    if (!IsExpectedResult(res))
+                        failed.store(true, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    std::vector<std::vector<uint8_t>> sentReports;
+    std::vector<ControllerHandle> controllers;
+    for (int round = 0; round < 200; round++) {
+        manager->AvailableControllers(&controllers);
+        for (auto controller : controllers) {
+            platform->TakeSentReports(controller, &sentReports);
+        }
+        platform->DestroyController(controllers[round % controllers.size()]);
+        platform->CreateController(round % 2 == 0 ? VirtualTransport::Usb : VirtualTransport::Bluetooth);
+        manager->Tick();
+    }
+
+    running.store(false, std::memory_order_relaxed);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const bool ok = !failed.load() && manager->AvailableControllers().size() == ContentionControllerCount;
+    DaisyManager::Shutdown();
+    return ok;
+}
+DS_BENCHMARK_CHECK("Manager survives concurrent reads, writes and hotplug", CheckConcurrentHotplug);
+
+/// A long wait for input on one thread must not hold up ticking and output on the others
+static bool CheckWaitDoesNotStallTick() {
+    if (DaisyManager::Initialize() != Result::OK)
+        return false;
+    DaisyManager* manager = DaisyManager::Get();
+    const auto controller = manager->GetPlatform()->CreateController(VirtualTransport::Usb);
+    manager->Tick();
+
+    std::thread waiter([manager] {
+        ControllerHandle controllers[1];
+        InputBatch batch{};
+        batch.capacity = 1;
+        batch.controllers = controllers;
+        manager->PollAll(&batch, 500);
+        manager->WaitForInput(500);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // once during each of the waits
+    bool ok = true;
+    for (uint64_t round = 0; round < 2; round++) {
+        const auto start = std::chrono::steady_clock::now();
+        manager->Tick();
+        ok &= manager->SetControllerData(controller, RumbleOutput(round + 1)) == Result::OK;
+        ok &= std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100);
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+    waiter.join();
+    DaisyManager::Shutdown();
+    return ok;
+}
+DS_BENCHMARK_CHECK("Waiting for input doesn't stall ticking or output", CheckWaitDoesNotStallTick);
+
+static bool CheckWaitSkipsBackgroundReaders() {
+    if (DaisyManager::Initialize() != Result::OK)
+        return false;
+    DaisyManager* manager = DaisyManager::Get();
+    VirtualManager* platform = manager->GetPlatform();
+    const auto controller = platform->CreateController(VirtualTransport::Usb);
+    manager->Tick();
+
+    // the reader takes the report, the wait must not return for it
+    bool ok = manager->StartBackgroundReader(controller, BackgroundReaderSettings{}) == Result::OK;
+    platform->InjectReport(controller, report::InputReportData{});
+    ok &= manager->WaitForInput(50) == Result::TIMEOUT;
+
+    ok &= manager->StopBackgroundReader(controller) == Result::OK;
+    platform->InjectReport(controller, report::InputReportData{});
+    ok &= manager->WaitForInput(50) == Result::OK;
+    DaisyManager::Shutdown();
+    return ok;
+}
+DS_BENCHMARK_CHECK("Waiting for input skips controllers with a background reader", CheckWaitSkipsBackgroundReaders);
+
+/// Every reader and writer thread runs the iterations against its own controller, readers and writers share controllers
+static void BenchmarkContention(size_t readers, size_t writers, bool ticking, uint64_t iterations) {
+    if (DaisyManager::Initialize() != Result::OK)
+        return;
+    DaisyManager* manager = DaisyManager::Get();
+    VirtualManager* platform = manager->GetPlatform();
+    std::vector<ControllerHandle> controllers;
+    for (size_t i = 0; i < ContentionControllerCount; i++) {
+        controllers.push_back(platform->CreateController(VirtualTransport::Usb));
+    }
+    manager->Tick();
+
+    std::atomic<bool> running{true};
+    std::thread ticker;
+    if (ticking) {
+        ticker = std::thread([&] {
+            while (running.load(std::memory_order_relaxed)) {
+                manager->Tick();
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t reader = 0; reader < readers; reader++) {
+        threads.emplace_back([&, reader] {
+            const auto controller = controllers[reader % controllers.size()];
+            const report::InputReportData report{};
+            ControllerInput input{};
+            for (uint64_t i = 0; i < iterations; i++) {
+                platform->InjectReport(controller, report);
+                manager->GetControllerData(controller, &input);
+                DoNotOptimize(input);
+            }
+        });
+    }
+    for (size_t writer = 0; writer < writers; writer++) {
+        threads.emplace_back([&, writer] {
+            const auto controller = controllers[writer % controllers.size()];
+            std::vector<std::vector<uint8_t>> sentReports;
+            for (uint64_t i = 0; i < iterations; i++) {
+                manager->SetControllerData(controller, RumbleOutput(i));
+                if (i % SentReportsTakeInterval == 0) {
+                    platform->TakeSentReports(controller, &sentReports);
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    running.store(false, std::memory_order_relaxed);
+    if (ticker.joinable()) {
+        ticker.join();
+    }
+    DaisyManager::Shutdown();
+}
+DS_BENCHMARK("Contention/1Reader1Writer", [](uint64_t iterations) { BenchmarkContention(1, 1, false, iterations); }, 2.0, "calls");
+DS_BENCHMARK("Contention/4Readers4Writers", [](uint64_t iterations) { BenchmarkContention(4, 4, false, iterations); }, 8.0, "calls");
+DS_BENCHMARK("Contention/4Readers4Writers/Ticking", [](uint64_t iterations) { BenchmarkContention(4, 4, true, iterations); }, 8.0, "calls");
+#endif
@@ -0,0 +1,66 @@
+#include "Bench.hpp"
+
+#include <Daisy/Crc32.hpp>
+#include <Daisy/Report.hpp>
+
+#include <array>
+#include <cstddef>
+#include <random>
+
+using namespace ds;
+using namespace ds::bench;
+
+static std::vector<uint8_t> RandomBytes(size_t size) {
+    std::mt19937 random(1234);
+    std::vector<uint8_t> bytes(size);
+    for (auto& byte : bytes) {
+        byte = static_cast<uint8_t>(random());
+    }
+    return bytes;
+}
+
+static bool CheckKernels() {
+    const auto bytes = RandomBytes(4096);
+    constexpr std::array<Crc32Kernel, 3> kernels = {Crc32Kernel::Slice8, Crc32Kernel::Slice16, Crc32Kernel::Clmul};
+    for (auto kernel : kernels) {
+        if (!IsCrc32KernelSupported(kernel))
+            continue;
+        // every size up to a few fold blocks, at every alignment, to cover all tail paths
+        for (size_t size = 0; size < 600; size++) {
+            for (size_t offset = 0; offset < 16; offset++) {
+                for (bool finalize : {false, true}) {
+                    const uint32_t expected = Crc32(Crc32Kernel::Table, BluetoothOutputCrcSeed, bytes.data() + offset, size, finalize);
+                    if (Crc32(kernel, BluetoothOutputCrcSeed, bytes.data() + offset, size, finalize) != expected)
+                        return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+DS_BENCHMARK_CHECK("Crc32 kernels match the table kernel", CheckKernels);
+
+constexpr size_t OutputReportCrcSize = offsetof(report::BluetoothOutputReport, crc);
+
+static void BenchmarkKernel(Crc32Kernel kernel, size_t size, uint64_t iterations) {
+    if (!IsCrc32KernelSupported(kernel))
+        return;
+    const auto bytes = RandomBytes(size);
+    uint32_t crc = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        crc = Crc32(kernel, crc, bytes.data(), bytes.size(), false);
+        DoNotOptimize(crc);
+    }
+}
+
+#define DS_CRC32_BENCHMARK(kernel, size, label)                                                                                                              \
+    DS_BENCHMARK("Crc32/" #kernel "/" label, [](uint64_t iterations) { BenchmarkKernel(Crc32Kernel::kernel, size, iterations); }, double(size), "bytes")
+
+DS_CRC32_BENCHMARK(Table, OutputReportCrcSize, "BluetoothOutputReport");
+DS_CRC32_BENCHMARK(Slice8, OutputReportCrcSize, "BluetoothOutputReport");
+DS_CRC32_BENCHMARK(Slice16, OutputReportCrcSize, "BluetoothOutputReport");
+DS_CRC32_BENCHMARK(Clmul, OutputReportCrcSize, "BluetoothOutputReport");
+DS_CRC32_BENCHMARK(Table, 4096, "4096");
+DS_CRC32_BENCHMARK(Slice8, 4096, "4096");
+DS_CRC32_BENCHMARK(Slice16, 4096, "4096");
+DS_CRC32_BENCHMARK(Clmul, 4096, "4096");
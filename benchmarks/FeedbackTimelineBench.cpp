@@ -0,0 +1,148 @@
+#include "Bench.hpp"
+
+#include <Daisy/ControllerOutput.hpp>
+#include <Daisy/FeedbackTimeline.hpp>
+#include <Daisy/OutputState.hpp>
+
+#include <cstring>
+
+using namespace ds;
+using namespace ds::bench;
+
+static bool SameTrigger(const report::TriggerData& left, const report::TriggerData& right) { return std::memcmp(&left, &right, sizeof(left)) == 0; }
+
+static bool CheckInterpolationAndRelease() {
+    FeedbackTimeline timeline;
+    const auto ramp = timeline.AddEffect(FeedbackEffect()
+                                             .AddKeyframe(FeedbackTrack::LeftMotor, 0, 0)
+                                             .AddKeyframe(FeedbackTrack::LeftMotor, 100, 200)
+                                             .AddKeyframe(FeedbackTrack::RightMotor, 0, 0, Interpolation::Smooth)
+                                             .AddKeyframe(FeedbackTrack::RightMotor, 100, 200));
+    FeedbackInstanceHandle instance;
+    bool ok = timeline.Play(ramp, 0, 0, &instance) == Result::OK;
+
+    // 4 ms ticks, the 13th one is at 48 ms
+    for (int tick = 0; tick < 13; tick++) {
+        timeline.Tick();
+    }
+    const auto& output = timeline.Output(0);
+    ok &= output.leftMotor == 96 && output.rightMotor == 94 && (output.flags1 & report::ChangeFlags1::EnableHaptics) == report::ChangeFlags1::EnableHaptics;
+
+    // the end holds the last keyframe, then the motors are turned off once
+    for (int tick = 13; tick < 26; tick++) {
+        timeline.Tick();
+    }
+    ok &= output.leftMotor == 200 && output.rightMotor == 200 && !timeline.IsPlaying(instance);
+    timeline.Tick();
+    ok &= output.leftMotor == 0 && output.rightMotor == 0 && (output.flags1 & report::ChangeFlags1::EnableHaptics) == report::ChangeFlags1::EnableHaptics;
+    timeline.Tick();
+    return ok && OutputState::IsEmpty(output) && OutputState::IsEmpty(timeline.Output(1));
+}
+DS_BENCHMARK_CHECK("Feedback timeline interpolates tracks and releases motors at the end", CheckInterpolationAndRelease);
+
+static bool CheckMixing() {
+    FeedbackTimeline timeline;
+    const auto red = timeline.AddEffect(FeedbackEffect()
+                                            .AddLightbarKeyframe(0, {255, 0, 0}, Interpolation::Step)
+                                            .AddLightbarKeyframe(1000, {255, 0, 0})
+                                            .AddKeyframe(FeedbackTrack::RightMotor, 0, 100));
+    const auto blue = timeline.AddEffect(FeedbackEffect()
+                                             .AddLightbarKeyframe(0, {0, 0, 255}, Interpolation::Step)
+                                             .AddLightbarKeyframe(1000, {0, 0, 255})
+                                             .AddKeyframe(FeedbackTrack::RightMotor, 0, 50));
+
+    // the higher priority wins the lightbar, the motors take the strongest instance
+    timeline.Play(red, 0, 1);
+    timeline.Play(blue, 0, 0);
+    timeline.Tick();
+    const auto& output = timeline.Output(0);
+    bool ok = output.lightbarColor.r == 255 && output.lightbarColor.b == 0 && output.rightMotor == 100;
+    ok &= (output.flags2 & report::ChangeFlags2::ToggleLedStrips) == report::ChangeFlags2::ToggleLedStrips &&
+          (output.flags2 & report::ChangeFlags2::TogglePlayerIndicator) == report::ChangeFlags2::None;
+
+    // ties go to the latest instance
+    timeline.Play(blue, 0, 1);
+    timeline.Tick();
+    return ok && output.lightbarColor.r == 0 && output.lightbarColor.b == 255 && output.rightMotor == 100;
+}
+DS_BENCHMARK_CHECK("Feedback timeline mixes instances by priority", CheckMixing);
+
+static bool CheckLoopingTriggers() {
+    constexpr auto Weapon = AdaptiveTriggerBuilder::Weapon(2, 6, 8);
+    constexpr auto Feedback = AdaptiveTriggerBuilder::Feedback(3, 5);
+    FeedbackTimeline timeline;
+    const auto loop = timeline.AddEffect(FeedbackEffect()
+                                             .AddTriggerKeyframe(TriggerSide::Left, 0, Weapon)
+                                             .AddTriggerKeyframe(TriggerSide::Left, 20, Feedback)
+                                             .AddTriggerKeyframe(TriggerSide::Left, 40, Weapon)
+                                             .SetLooping(true));
+    FeedbackInstanceHandle instance;
+    timeline.Play(loop, 2, 0, &instance);
+
+    const auto& output = timeline.Output(2);
+    bool ok = true;
+    for (int tick = 0; tick < 12; tick++) {
+        timeline.Tick();
+        // 40 ms loop, weapon for its first half
+        const int timeMs = (tick * 4) % 40;
+        ok &= SameTrigger(output.leftTrigger, timeMs < 20 ? Weapon : Feedback) &&
+              (output.flags1 & report::ChangeFlags1::LeftTriggerEffects) == report::ChangeFlags1::LeftTriggerEffects;
+    }
+
+    timeline.Stop(instance);
+    timeline.Tick();
+    return ok && output.leftTrigger.mode == report::TriggerMode::Off && timeline.InstanceCount() == 0;
+}
+DS_BENCHMARK_CHECK("Feedback timeline loops trigger effects and releases them on stop", CheckLoopingTriggers);
+
+static bool CheckSchedulerAndCapacity() {
+    FeedbackTimelineSettings settings{};
+    settings.controllerSlots = 2;
+    settings.instanceCapacity = 2;
+    FeedbackTimeline timeline(settings);
+    const auto effect = timeline.AddEffect(FeedbackEffect().AddKeyframe(FeedbackTrack::PlayerLeds, 0, 0x1f).SetLooping(true));
+
+    bool ok = timeline.Play(effect, 2) == Result::INVALID_PARAMETER && timeline.Play(effect + 1, 0) == Result::INVALID_PARAMETER;
+    ok &= timeline.Play(effect, 0) == Result::OK && timeline.Play(effect, 1) == Result::OK && timeline.Play(effect, 1) == Result::INVALID_PARAMETER;
+
+    // fixed 4 ms ticks no matter how the time is handed in, a long stall only catches up on 100 ms
+    ok &= timeline.Advance(std::chrono::milliseconds(10)) == 2 && timeline.Advance(std::chrono::milliseconds(2)) == 1;
+    ok &= timeline.Advance(std::chrono::seconds(10)) == 25;
+    ok &= timeline.Output(1).playerLedFlags == static_cast<report::PlayerLedFlags>(0x1f);
+    timeline.StopAll(1);
+    ok &= timeline.InstanceCount() == 1;
+
+    // rates beyond a tick per microsecond are clamped instead of ticking forever
+    settings.rateHz = UINT32_MAX;
+    FeedbackTimeline fastTimeline(settings);
+    return ok && fastTimeline.Advance(std::chrono::microseconds(3)) == 3;
+}
+DS_BENCHMARK_CHECK("Feedback timeline ticks at a fixed rate within its capacity", CheckSchedulerAndCapacity);
+
+static void BenchmarkTick(uint64_t iterations) {
+    FeedbackTimelineSettings settings{};
+    settings.controllerSlots = 16;
+    settings.instanceCapacity = 512;
+    FeedbackTimeline timeline(settings);
+    const auto pulse = timeline.AddEffect(FeedbackEffect()
+                                              .AddKeyframe(FeedbackTrack::LeftMotor, 0, 0)
+                                              .AddKeyframe(FeedbackTrack::LeftMotor, 150, 255, Interpolation::Smooth)
+                                              .AddKeyframe(FeedbackTrack::LeftMotor, 300, 0)
+                                              .AddKeyframe(FeedbackTrack::RightMotor, 0, 80, Interpolation::Step)
+                                              .AddKeyframe(FeedbackTrack::RightMotor, 200, 0)
+                                              .AddLightbarKeyframe(0, {0, 0, 0})
+                                              .AddLightbarKeyframe(150, {255, 64, 0}, Interpolation::Smooth)
+                                              .AddLightbarKeyframe(300, {0, 0, 0})
+                                              .AddTriggerKeyframe(TriggerSide::Left, 0, AdaptiveTriggerBuilder::Feedback(3, 5))
+                                              .AddTriggerKeyframe(TriggerSide::Right, 100, AdaptiveTriggerBuilder::Vibration(2, 6, 40))
+                                              .SetLooping(true));
+    for (uint32_t i = 0; i < settings.instanceCapacity; i++) {
+        timeline.Play(pulse, i % settings.controllerSlots, static_cast<uint8_t>(i % 3));
+    }
+
+    for (uint64_t i = 0; i < iterations; i++) {
+        timeline.Tick();
+        DoNotOptimize(timeline.Output(0));
+    }
+}
+DS_BENCHMARK("FeedbackTimeline/Tick/512", BenchmarkTick, 512.0, "instances");
@@ -0,0 +1,92 @@
+#include "Bench.hpp"
+
+#include <Daisy/Handle.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using namespace ds::bench;
+
+/// A map that had every other element removed, like controllers that came and went
+static SlotMap<uint64_t> MakeSparseMap(int32_t size, std::vector<Handle<uint64_t>>* outHandles = nullptr) {
+    SlotMap<uint64_t> map;
+    std::vector<Handle<uint64_t>> handles;
+    for (int32_t i = 0; i < size; i++) {
+        handles.push_back(map.Add(static_cast<uint64_t>(i)));
+    }
+    for (int32_t i = 0; i < size; i += 2) {
+        map.Remove(handles[i]);
+    }
+    if (outHandles) {
+        *outHandles = std::move(handles);
+    }
+    return map;
+}
+
+static bool CheckIteration() {
+    const auto map = MakeSparseMap(64);
+    uint64_t visited = 0;
+    uint64_t sum = 0;
+    for (auto [handle, value] : map) {
+        if (handle.Index() % 2 != 1 || map[handle] != value)
+            return false;
+        visited++;
+        sum += value;
+    }
+    return visited == 32 && map.Size() == 32 && sum == 32 * 32;
+}
+DS_BENCHMARK_CHECK("SlotMap iteration visits every live element once", CheckIteration);
+
+static bool CheckStaleHandles() {
+    std::vector<Handle<uint64_t>> handles;
+    auto map = MakeSparseMap(8, &handles);
+
+    // the freed slot gets reused, the old handle must not see the new element
+    const auto reused = map.Add(uint64_t{100});
+    if (reused.Index() != handles[6].Index() || map.Contains(handles[6]) || !map.Contains(reused) || map[reused] != 100)
+        return false;
+    if (Handle<uint64_t>::FromBits(reused.ToBits()) != reused)
+        return false;
+
+    // removing moves the last element, its handle has to keep working
+    map.Remove(handles[1]);
+    for (size_t i = 3; i < handles.size(); i += 2) {
+        if (!map.Contains(handles[i]) || map[handles[i]] != i)
+            return false;
+    }
+    map.Clear();
+    return map.Size() == 0 && !map.Contains(reused) && map.begin() == map.end();
+}
+DS_BENCHMARK_CHECK("SlotMap rejects stale handles", CheckStaleHandles);
+
+static void BenchmarkIteration(int32_t size, uint64_t iterations) {
+    auto map = MakeSparseMap(size);
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint64_t sum = 0;
+        for (auto [handle, value] : map) {
+            sum += value;
+        }
+        DoNotOptimize(sum);
+    }
+}
+DS_BENCHMARK("Handle/SlotMap/Iterate/8", [](uint64_t iterations) { BenchmarkIteration(8, iterations); }, 4.0, "elements");
+DS_BENCHMARK("Handle/SlotMap/Iterate/256", [](uint64_t iterations) { BenchmarkIteration(256, iterations); }, 128.0, "elements");
+
+static void BenchmarkLookup(uint64_t iterations) {
+    std::vector<Handle<uint64_t>> handles;
+    auto map = MakeSparseMap(256, &handles);
+    for (uint64_t i = 0; i < iterations; i++) {
+        DoNotOptimize(map.Get(handles[(i * 2 + 1) & 0xff]));
+    }
+}
+DS_BENCHMARK("Handle/SlotMap/Get", BenchmarkLookup);
+
+static void BenchmarkAddRemove(uint64_t iterations) {
+    auto map = MakeSparseMap(256);
+    for (uint64_t i = 0; i < iterations; i++) {
+        const auto handle = map.Add(uint64_t{i});
+        DoNotOptimize(handle);
+        map.Remove(handle);
+    }
+}
+DS_BENCHMARK("Handle/SlotMap/AddRemove", BenchmarkAddRemove);
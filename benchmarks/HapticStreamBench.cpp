@@ -0,0 +1,155 @@
+#include "Bench.hpp"
+
+#include <Daisy/Crc32.hpp>
+#include <Daisy/Daisy.hpp>
+#include <Daisy/HapticStream.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace ds;
+using namespace ds::bench;
+
+/// Interleaved stereo frames holding the same samples
+static std::vector<int16_t> StereoFrames(size_t frames, int16_t left, int16_t right) {
+    std::vector<int16_t> samples(2 * frames);
+    for (size_t frame = 0; frame < frames; frame++) {
+        samples[2 * frame] = left;
+        samples[2 * frame + 1] = right;
+    }
+    return samples;
+}
+
+static bool HasValidCrc(const report::BluetoothHapticsReport& report) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&report);
+    return Crc32(BluetoothOutputCrcSeed, bytes, offsetof(report::BluetoothHapticsReport, crc), false) == report.crc;
+}
+
+static bool CheckDownsampling() {
+    HapticStream stream({});
+    // 48 kHz to 3 kHz, 16 written frames per resampled one
+    const auto samples = StereoFrames(1024, 0x1000, -0x1000);
+    bool ok = stream.Write(samples.data(), 1024) == 1024;
+
+    report::BluetoothHapticsReport report{};
+    for (uint8_t packet = 0; packet < 2; packet++) {
+        ok &= stream.NextPacket(&report) && HasValidCrc(report) && report.reportId == report::BLUETOOTH_HAPTICS_REPORT_ID &&
+              report.tag == packet << 4 && report.samplesPacketId == report::HAPTICS_SAMPLES_PACKET_ID && report.samplesPacketLength == 64;
+        for (uint32_t frame = 0; frame < HapticPacketFrames; frame++) {
+            ok &= report.samples[2 * frame] == 0x10 && report.samples[2 * frame + 1] == -0x10;
+        }
+    }
+
+    // running dry sends one silent report, then nothing until the prebuffer fills again
+    ok &= stream.NextPacket(&report) && report.samples[0] == 0 && !stream.NextPacket(&report);
+    HapticStreamStats stats{};
+    stream.Stats(&stats);
+    return ok && stats.packets == 3 && stats.underruns == 1 && stats.silentFrames == HapticPacketFrames && stats.bufferedFrames == 0;
+}
+DS_BENCHMARK_CHECK("Haptic stream averages down to 3 kHz and packetizes", CheckDownsampling);
+
+static bool CheckUpsampling() {
+    HapticStreamSettings settings{};
+    settings.sampleRate = 1000;
+    settings.channels = 1;
+    settings.prebufferFrames = 9;
+    HapticStream stream(settings);
+    const int16_t samples[] = {0, 3 * 256, 6 * 256};
+    bool ok = stream.Write(samples, 3) == 3;
+
+    // three resampled frames per written one, interpolated from the previous frame
+    report::BluetoothHapticsReport report{};
+    ok &= stream.NextPacket(&report);
+    const int8_t expected[] = {0, 0, 0, 0, 1, 2, 3, 4, 5};
+    for (uint32_t frame = 0; frame < 9; frame++) {
+        ok &= report.samples[2 * frame] == expected[frame] && report.samples[2 * frame + 1] == expected[frame];
+    }
+    HapticStreamStats stats{};
+    stream.Stats(&stats);
+    return ok && stats.underruns == 1 && stats.silentFrames == HapticPacketFrames - 9;
+}
+DS_BENCHMARK_CHECK("Haptic stream interpolates up to 3 kHz", CheckUpsampling);
+
+static bool CheckBufferLimits() {
+    HapticStreamSettings settings{};
+    settings.bufferFrames = 64;
+    HapticStream stream(settings);
+    // only 64 resampled frames fit, the writer is told instead of waiting
+    const auto samples = StereoFrames(2000, 0x100, 0x100);
+    bool ok = stream.Write(samples.data(), 2000) == 1024;
+    HapticStreamStats stats{};
+    stream.Stats(&stats);
+    ok &= stats.bufferedFrames == 64 && stats.capacityFrames == 64 && stats.fillLevel == 1.0f;
+
+    // a partly filled report is padded with silence
+    report::BluetoothHapticsReport report{};
+    ok &= stream.NextPacket(&report) && stream.Write(samples.data(), 128) == 128;
+    ok &= stream.NextPacket(&report) && stream.NextPacket(&report) && report.samples[2 * 7] == 1 && report.samples[2 * 8] == 0;
+    stream.Stats(&stats);
+    return ok && stats.underruns == 1 && stats.silentFrames == HapticPacketFrames - 8 && stats.fillLevel == 0.0f;
+}
+DS_BENCHMARK_CHECK("Haptic stream never overfills and pads underruns with silence", CheckBufferLimits);
+
+#if defined(DAISY_PLATFORM_VIRTUAL)
+static bool CheckManagerStreamsHaptics() {
+    if (DaisyManager::Initialize() != Result::OK)
+        return false;
+    DaisyManager* manager = DaisyManager::Get();
+    VirtualManager* platform = manager->GetPlatform();
+    const auto usbController = platform->CreateController(VirtualTransport::Usb);
+    const auto controller = platform->CreateController(VirtualTransport::Bluetooth);
+    manager->Tick();
+
+    const auto samples = StereoFrames(2048, 0x2000, 0x2000);
+    size_t written = 0;
+    bool ok = manager->StartHapticStream(usbController) == Result::INVALID_PARAMETER;
+    // every written frame would resample into 1500 frames, more than the buffer holds
+    HapticStreamSettings slowSettings{};
+    slowSettings.sampleRate = 2;
+    ok &= manager->StartHapticStream(controller, slowSettings) == Result::INVALID_PARAMETER;
+    ok &= manager->WriteHapticSamples(controller, samples.data(), 2048, &written) == Result::INVALID_PARAMETER;
+    ok &= manager->StartHapticStream(controller) == Result::OK;
+    ok &= manager->WriteHapticSamples(controller, samples.data(), 2048, &written) == Result::OK && written == 2048;
+
+    // four reports of samples and a silent one once they ran out
+    std::vector<std::vector<uint8_t>> hapticsReports;
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (hapticsReports.size() < 5 && std::chrono::steady_clock::now() < timeout) {
+        std::this_thread::sleep_for(HapticPacketInterval);
+        std::vector<std::vector<uint8_t>> sentReports;
+        platform->TakeSentReports(controller, &sentReports);
+        for (auto& sent : sentReports) {
+            if (sent[0] == report::BLUETOOTH_HAPTICS_REPORT_ID) {
+                hapticsReports.push_back(std::move(sent));
+            }
+        }
+    }
+    ok &= hapticsReports.size() == 5;
+    for (size_t i = 0; ok && i < hapticsReports.size(); i++) {
+        const auto* haptics = reinterpret_cast<const report::BluetoothHapticsReport*>(hapticsReports[i].data());
+        ok &= hapticsReports[i].size() == sizeof(report::BluetoothHapticsReport) && haptics->samples[0] == (i < 4 ? 0x20 : 0);
+    }
+
+    HapticStreamStats stats{};
+    ok &= manager->GetHapticStreamStats(controller, &stats) == Result::OK && stats.packets == 5 && stats.underruns == 1;
+    ok &= manager->StopHapticStream(controller) == Result::OK && manager->GetHapticStreamStats(controller, &stats) == Result::INVALID_PARAMETER;
+    DaisyManager::Shutdown();
+    return ok;
+}
+DS_BENCHMARK_CHECK("Manager streams haptics reports at their cadence", CheckManagerStreamsHaptics);
+#endif
+
+static void BenchmarkWrite(uint64_t iterations) {
+    HapticStream stream({});
+    const auto samples = StereoFrames(1024, 0x1000, -0x1000);
+    report::BluetoothHapticsReport report{};
+    for (uint64_t i = 0; i < iterations; i++) {
+        DoNotOptimize(stream.Write(samples.data(), samples.size() / 2));
+        stream.NextPacket(&report);
+        stream.NextPacket(&report);
+        DoNotOptimize(report);
+    }
+}
+DS_BENCHMARK("HapticStream/Write+Packetize/48kHz", BenchmarkWrite, 1024.0, "frames");
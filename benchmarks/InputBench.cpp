@@ -0,0 +1,304 @@
+#include "Bench.hpp"
+
+#include <Daisy/Daisy.hpp>
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+
+using namespace ds;
+using namespace ds::bench;
+
+constexpr size_t SyntheticReportCount = 256;
+
+/// Reports with random sticks, buttons, motion and touch, like a controller being actively used
+static const std::array<report::InputReportData, SyntheticReportCount>& SyntheticReports() {
+    static const auto reports = [] {
+        std::array<report::InputReportData, SyntheticReportCount> reports{};
+        std::mt19937 random(5678);
+        for (auto& report : reports) {
+            auto* bytes = reinterpret_cast<uint8_t*>(&report);
+            for (size_t i = 0; i < sizeof(report); i++) {
+                bytes[i] = static_cast<uint8_t>(random());
+            }
+        }
+        return reports;
+    }();
+    return reports;
+}
+
+static void BenchmarkFromInputReport(uint64_t iterations) {
+    const auto& reports = SyntheticReports();
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (const auto& report : reports) {
+            ControllerInput input = FromInputReport(report);
+            DoNotOptimize(input);
+        }
+    }
+}
+DS_BENCHMARK("Input/FromInputReport", BenchmarkFromInputReport, double(SyntheticReportCount), "reports");
+
+/// The synthetic reports framed like the device sends them over bluetooth
+static const std::array<std::array<uint8_t, BluetoothInputReportSize>, SyntheticReportCount>& SyntheticBluetoothReports() {
+    static const auto reports = [] {
+        std::array<std::array<uint8_t, BluetoothInputReportSize>, SyntheticReportCount> reports{};
+        for (size_t i = 0; i < SyntheticReportCount; i++) {
+            reports[i][0] = 49;
+            reports[i][1] = static_cast<uint8_t>(i << 4);
+            std::memcpy(reports[i].data() + offsetof(report::BluetoothInputReport, data), &SyntheticReports()[i], sizeof(report::InputReportData));
+        }
+        return reports;
+    }();
+    return reports;
+}
+
+static bool CheckInputReportView() {
+    for (size_t i = 0; i < SyntheticReportCount; i++) {
+        InputReportView view(nullptr);
+        if (InputReportView::FromRawReport(SyntheticBluetoothReports()[i].data(), BluetoothInputReportSize, &view) != Result::OK)
+            return false;
+
+        // compared against the packed struct fields, which are loaded natively on little endian hosts
+        const ControllerInput input = FromInputReport(view);
+        const auto& data = SyntheticReports()[i];
+        const auto& point2 = data.touchData.point2;
+        if (input.analog.leftStick.x != data.x || input.analog.rightStick.y != data.rz || input.analog.r2 != data.ry ||
+            input.gyro.pitch != data.gyroPitch || input.gyro.roll != data.gyroRoll || input.accel.z != data.accelZ ||
+            input.sensorTimestamp != data.sensorTimestamp || input.touchData.point2.isTouching != point2.IsActive() ||
+            input.touchData.point2.pos.x != point2.GetX() || input.touchData.point2.pos.y != point2.GetY() ||
+            input.batteryData.batteryLevel != data.batteryData.GetPercentage() * 10)
+            return false;
+    }
+
+    // ps, touchpad and mute live in the third button byte
+    report::InputReportData data{};
+    data.buttons.buttons0 = 0x08;
+    data.buttons.buttons2 = 0x07;
+    return InputReportView(data).Buttons() == (PressedButtons::PS | PressedButtons::Touchpad | PressedButtons::Mute);
+}
+DS_BENCHMARK_CHECK("InputReportView decodes like FromInputReport", CheckInputReportView);
+
+/// Only the fields a typical game loop looks at, read in place from the transport buffer
+static void BenchmarkInputReportView(uint64_t iterations) {
+    const auto& reports = SyntheticBluetoothReports();
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (const auto& report : reports) {
+            InputReportView view(nullptr);
+            InputReportView::FromRawReport(report.data(), BluetoothInputReportSize, &view);
+            const auto leftStick = view.LeftStick();
+            const auto buttons = view.Buttons();
+            DoNotOptimize(leftStick);
+            DoNotOptimize(buttons);
+        }
+    }
+}
+DS_BENCHMARK("Input/InputReportView/SticksAndButtons", BenchmarkInputReportView, double(SyntheticReportCount), "reports");
+
+static bool CheckStickAxisEvents() {
+    InputEventSubscription subscription{};
+    subscription.axes = InputAxes::LeftStickX | InputAxes::R2;
+    InputEventDetector detector(subscription);
+    SpscRing<InputEvent> events(16);
+
+    ControllerInput input{};
+    input.analog.leftStick = {128, 128};
+    detector.Process(input, events);
+
+    // pushing left presses just like pushing right, the trigger compares its raw value
+    bool ok = true;
+    InputEvent event{};
+    for (const uint8_t x : {uint8_t(20), uint8_t(128), uint8_t(240), uint8_t(100)}) {
+        input.analog.leftStick.x = x;
+        detector.Process(input, events);
+    }
+    for (const auto type : {InputEventType::AxisPressed, InputEventType::AxisReleased, InputEventType::AxisPressed, InputEventType::AxisReleased}) {
+        ok &= events.Pop(&event) && event.type == type && event.axis == InputAxis::LeftStickX;
+    }
+    input.analog.r2 = 100;
+    detector.Process(input, events);
+    ok &= !events.Pop(&event);
+    input.analog.r2 = 200;
+    detector.Process(input, events);
+    ok &= events.Pop(&event) && event.type == InputEventType::AxisPressed && event.axis == InputAxis::R2 && event.axisValue == 200;
+    return ok && StickDeflection(0) == 255 && StickDeflection(128) == 0 && StickDeflection(255) == 254;
+}
+DS_BENCHMARK_CHECK("Input events press stick axes by deflection", CheckStickAxisEvents);
+
+static void BenchmarkInputEvents(bool subscribed, uint64_t iterations) {
+    InputEventSubscription subscription{};
+    if (subscribed) {
+        subscription.buttons = static_cast<PressedButtons>(0xffff);
+        subscription.hatSwitch = HatSwitch::Up | HatSwitch::Right | HatSwitch::Down | HatSwitch::Left;
+        subscription.axes = InputAxes::L2 | InputAxes::R2;
+    }
+    InputEventDetector detector(subscription);
+    SpscRing<InputEvent> events(64);
+
+    std::array<ControllerInput, SyntheticReportCount> inputs{};
+    for (size_t i = 0; i < SyntheticReportCount; i++) {
+        inputs[i] = FromInputReport(SyntheticReports()[i]);
+    }
+
+    InputEvent event{};
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (const auto& input : inputs) {
+            detector.Process(input, events);
+        }
+        while (events.Pop(&event)) {
+            DoNotOptimize(event);
+        }
+    }
+}
+DS_BENCHMARK("Input/InputEventDetector/Unsubscribed", [](uint64_t iterations) { BenchmarkInputEvents(false, iterations); }, double(SyntheticReportCount),
+             "reports");
+DS_BENCHMARK("Input/InputEventDetector/AllButtons", [](uint64_t iterations) { BenchmarkInputEvents(true, iterations); }, double(SyntheticReportCount),
+             "reports");
+
+#if defined(DAISY_PLATFORM_VIRTUAL)
+/// Read path through the manager: framing by the platform, report id check, decoding and caching
+static void BenchmarkGetControllerData(VirtualTransport transport, uint64_t iterations) {
+    if (DaisyManager::Initialize() != Result::OK)
+        return;
+    DaisyManager* manager = DaisyManager::Get();
+    VirtualManager* platform = manager->GetPlatform();
+    const auto controller = platform->CreateController(transport, SyntheticReportCount);
+    manager->Tick();
+
+    const auto& reports = SyntheticReports();
+    ControllerInput input{};
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (const auto& report : reports) {
+            platform->InjectReport(controller, report);
+            manager->GetControllerData(controller, &input);
+            DoNotOptimize(input);
+        }
+    }
+
+    DaisyManager::Shutdown();
+}
+DS_BENCHMARK("Input/GetControllerData/Usb", [](uint64_t iterations) { BenchmarkGetControllerData(VirtualTransport::Usb, iterations); },
+             double(SyntheticReportCount), "reports");
+DS_BENCHMARK("Input/GetControllerData/Bluetooth", [](uint64_t iterations) { BenchmarkGetControllerData(VirtualTransport::Bluetooth, iterations); },
+             double(SyntheticReportCount), "reports");
+#endif
+
+#if defined(DAISY_PLATFORM_VIRTUAL)
+constexpr size_t BatchControllerCount = 16;
+
+/// One report queued for every controller, then all of them read either one by one or batched
+static void BenchmarkMultiController(bool batched, uint64_t iterations) {
+    if (DaisyManager::Initialize() != Result::OK)
+        return;
+    DaisyManager* manager = DaisyManager::Get();
+    VirtualManager* platform = manager->GetPlatform();
+    for (size_t i = 0; i < BatchControllerCount; i++) {
+        platform->CreateController(i % 2 == 0 ? VirtualTransport::Usb : VirtualTransport::Bluetooth);
+    }
+    manager->Tick();
+
+    std::array<ControllerHandle, BatchControllerCount> handles{};
+    std::array<uint8_t, BatchControllerCount> leftStickX{};
+    std::array<uint8_t, BatchControllerCount> leftStickY{};
+    std::array<PressedButtons, BatchControllerCount> buttons{};
+    std::array<uint16_t, BatchControllerCount> gyroPitch{};
+    InputBatch batch{};
+    batch.capacity = BatchControllerCount;
+    batch.controllers = handles.data();
+    batch.leftStickX = leftStickX.data();
+    batch.leftStickY = leftStickY.data();
+    batch.buttons = buttons.data();
+    batch.gyroPitch = gyroPitch.data();
+
+    const auto& reports = SyntheticReports();
+    ControllerInput input{};
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (auto controller : manager->AvailableControllers()) {
+            platform->InjectReport(controller, reports[(i + controller.Index()) % reports.size()]);
+        }
+
+        if (batched) {
+            manager->PollAll(&batch, 0);
+            DoNotOptimize(leftStickX);
+        } else {
+            for (auto controller : manager->AvailableControllers()) {
+                manager->GetControllerData(controller, &input);
+                DoNotOptimize(input);
+            }
+        }
+    }
+
+    DaisyManager::Shutdown();
+}
+DS_BENCHMARK("Input/MultiController/16/GetControllerData", [](uint64_t iterations) { BenchmarkMultiController(false, iterations); },
+             double(BatchControllerCount), "reports");
+DS_BENCHMARK("Input/MultiController/16/PollAll", [](uint64_t iterations) { BenchmarkMultiController(true, iterations); }, double(BatchControllerCount),
+             "reports");
+#endif
+
+#if defined(__linux__)
+/// A full disk stops the recording at the first failed write, and stopping reports it
+static bool CheckRecordingWriteFailure() {
+    ReportRecorder recorder;
+    if (recorder.Open("/dev/full") != Result::OK)
+        return false;
+
+    // writes are buffered, they only fail once the buffer gets flushed
+    const std::array<uint8_t, 64> reportData{};
+    for (size_t i = 0; i < 1024 && recorder.IsOpen(); i++) {
+        recorder.RecordInput(0, reportData.data(), reportData.size());
+    }
+    return !recorder.IsOpen() && recorder.Close() == Result::FILE_IO;
+}
+DS_BENCHMARK_CHECK("Recording stops and reports the first failed write", CheckRecordingWriteFailure);
+#endif
+
+#if defined(DAISY_PLATFORM_REPLAY)
+constexpr size_t ReplayReportCount = 4096;
+
+/// Records synthetic usb traffic of one controller, the way @see DaisyManager::StartRecording would
+static const std::string& SyntheticRecording() {
+    static const std::string path = [] {
+        const std::string recordingPath = (std::filesystem::temp_directory_path() / "daisy_bench_replay.dsrc").string();
+        ReportRecorder recorder;
+        if (recorder.Open(recordingPath.c_str()) != Result::OK)
+            return std::string{};
+
+        recorder.RecordConnected(0, {64, 48});
+        std::array<uint8_t, 64> reportData{};
+        reportData[0] = 0x01;
+        for (size_t i = 0; i < ReplayReportCount; i++) {
+            const auto& report = SyntheticReports()[i % SyntheticReportCount];
+            std::memcpy(reportData.data() + 1, &report, sizeof(report));
+            recorder.RecordInput(0, reportData.data(), reportData.size());
+        }
+        recorder.RecordDisconnected(0);
+        return recordingPath;
+    }();
+    return path;
+}
+
+/// Whole read pipeline fed from a memory-mapped recording
+static void BenchmarkReplay(uint64_t iterations) {
+    if (SyntheticRecording().empty() || DaisyManager::Initialize() != Result::OK)
+        return;
+    DaisyManager* manager = DaisyManager::Get();
+    ReplayManager* platform = manager->GetPlatform();
+
+    ControllerInput input{};
+    for (uint64_t i = 0; i < iterations; i++) {
+        platform->Open(SyntheticRecording().c_str(), ReplayMode::AsFastAsPossible);
+        while (!platform->IsFinished()) {
+            manager->Tick();
+            for (auto controller : manager->AvailableControllers()) {
+                manager->GetControllerData(controller, &input);
+                DoNotOptimize(input);
+            }
+        }
+    }
+
+    DaisyManager::Shutdown();
+}
+DS_BENCHMARK("Input/Replay/AsFastAsPossible", BenchmarkReplay, double(ReplayReportCount), "reports");
+#endif
@@ -0,0 +1,138 @@
+#include "Bench.hpp"
+
+#include <Daisy/Daisy.hpp>
+#include <Daisy/InputDecoder.hpp>
+
+#include <array>
+#include <random>
+#include <vector>
+
+using namespace ds;
+using namespace ds::bench;
+
+constexpr size_t DecodeReportCount = 4096;
+
+static const std::vector<report::InputReportData>& RandomReports() {
+    static const auto reports = [] {
+        std::vector<report::InputReportData> reports(DecodeReportCount);
+        std::mt19937 random(4321);
+        for (auto& report : reports) {
+            auto* bytes = reinterpret_cast<uint8_t*>(&report);
+            for (size_t i = 0; i < sizeof(report); i++) {
+                bytes[i] = static_cast<uint8_t>(random());
+            }
+        }
+        return reports;
+    }();
+    return reports;
+}
+
+/// Every column of @see InputColumns, backed by vectors
+struct ColumnStorage {
+    explicit ColumnStorage(size_t size)
+        : leftStickX(size), leftStickY(size), rightStickX(size), rightStickY(size), l2(size), r2(size), buttons(size), hatSwitch(size), gyroPitch(size),
+          gyroYaw(size), gyroRoll(size), accelX(size), accelY(size), accelZ(size), sensorTimestamp(size), touch1Active(size), touch1Id(size), touch1X(size),
+          touch1Y(size), touch2Active(size), touch2Id(size), touch2X(size), touch2Y(size) {}
+
+    InputColumns Columns() {
+        return {leftStickX.data(), leftStickY.data(), rightStickX.data(), rightStickY.data(), l2.data(),           r2.data(),
+                buttons.data(),    hatSwitch.data(),  gyroPitch.data(),   gyroYaw.data(),     gyroRoll.data(),     accelX.data(),
+                accelY.data(),     accelZ.data(),     sensorTimestamp.data(), touch1Active.data(), touch1Id.data(), touch1X.data(),
+                touch1Y.data(),    touch2Active.data(), touch2Id.data(),  touch2X.data(),     touch2Y.data()};
+    }
+
+    std::vector<uint8_t> leftStickX, leftStickY, rightStickX, rightStickY, l2, r2;
+    std::vector<PressedButtons> buttons;
+    std::vector<HatSwitch> hatSwitch;
+    std::vector<uint16_t> gyroPitch, gyroYaw, gyroRoll, accelX, accelY, accelZ;
+    std::vector<uint32_t> sensorTimestamp;
+    std::vector<uint8_t> touch1Active, touch1Id;
+    std::vector<uint16_t> touch1X, touch1Y;
+    std::vector<uint8_t> touch2Active, touch2Id;
+    std::vector<uint16_t> touch2X, touch2Y;
+};
+
+static bool MatchesFromInputReport(ColumnStorage& columns, size_t i, const ControllerInput& input) {
+    const auto& point1 = input.touchData.point1;
+    const auto& point2 = input.touchData.point2;
+    return columns.leftStickX[i] == input.analog.leftStick.x && columns.leftStickY[i] == input.analog.leftStick.y &&
+           columns.rightStickX[i] == input.analog.rightStick.x && columns.rightStickY[i] == input.analog.rightStick.y && columns.l2[i] == input.analog.l2 &&
+           columns.r2[i] == input.analog.r2 && columns.buttons[i] == input.buttons && columns.hatSwitch[i] == input.hatSwitch &&
+           columns.gyroPitch[i] == input.gyro.pitch && columns.gyroYaw[i] == input.gyro.yaw && columns.gyroRoll[i] == input.gyro.roll &&
+           columns.accelX[i] == input.accel.x && columns.accelY[i] == input.accel.y && columns.accelZ[i] == input.accel.z &&
+           columns.sensorTimestamp[i] == input.sensorTimestamp && columns.touch1Active[i] == point1.isTouching && columns.touch1Id[i] == point1.id &&
+           columns.touch1X[i] == point1.pos.x && columns.touch1Y[i] == point1.pos.y && columns.touch2Active[i] == point2.isTouching &&
+           columns.touch2Id[i] == point2.id && columns.touch2X[i] == point2.pos.x && columns.touch2Y[i] == point2.pos.y;
+}
+
+static bool CheckKernels() {
+    const auto& reports = RandomReports();
+    constexpr std::array<InputDecodeKernel, 3> kernels = {InputDecodeKernel::Scalar, InputDecodeKernel::Sse41, InputDecodeKernel::Avx2};
+    for (auto kernel : kernels) {
+        if (!IsInputDecodeKernelSupported(kernel))
+            continue;
+        // counts around the block sizes, at an odd start, to cover the scalar tails
+        for (size_t count : {size_t{0}, size_t{1}, size_t{7}, size_t{8}, size_t{15}, size_t{16}, size_t{17}, size_t{33}, DecodeReportCount - 3}) {
+            ColumnStorage columns(count);
+            DecodeInputReports(kernel, reports.data() + 3, count, columns.Columns());
+            for (size_t i = 0; i < count; i++) {
+                if (!MatchesFromInputReport(columns, i, FromInputReport(reports[i + 3])))
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+DS_BENCHMARK_CHECK("Input decode kernels match FromInputReport", CheckKernels);
+
+static void BenchmarkDecodeAll(InputDecodeKernel kernel, uint64_t iterations) {
+    if (!IsInputDecodeKernelSupported(kernel))
+        return;
+    ColumnStorage columns(DecodeReportCount);
+    const InputColumns out = columns.Columns();
+    for (uint64_t i = 0; i < iterations; i++) {
+        DecodeInputReports(kernel, RandomReports().data(), DecodeReportCount, out);
+        DoNotOptimize(columns.leftStickX[0]);
+    }
+}
+
+/// Only what a motion pipeline reads
+static void BenchmarkDecodeMotion(InputDecodeKernel kernel, uint64_t iterations) {
+    if (!IsInputDecodeKernelSupported(kernel))
+        return;
+    ColumnStorage columns(DecodeReportCount);
+    InputColumns out{};
+    out.gyroPitch = columns.gyroPitch.data();
+    out.gyroYaw = columns.gyroYaw.data();
+    out.gyroRoll = columns.gyroRoll.data();
+    out.accelX = columns.accelX.data();
+    out.accelY = columns.accelY.data();
+    out.accelZ = columns.accelZ.data();
+    out.sensorTimestamp = columns.sensorTimestamp.data();
+    for (uint64_t i = 0; i < iterations; i++) {
+        DecodeInputReports(kernel, RandomReports().data(), DecodeReportCount, out);
+        DoNotOptimize(columns.gyroPitch[0]);
+    }
+}
+
+static void BenchmarkFromInputReport(uint64_t iterations) {
+    std::vector<ControllerInput> inputs(DecodeReportCount);
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (size_t report = 0; report < DecodeReportCount; report++) {
+            inputs[report] = FromInputReport(RandomReports()[report]);
+        }
+        DoNotOptimize(inputs[0]);
+    }
+}
+DS_BENCHMARK("InputDecode/FromInputReport/All", BenchmarkFromInputReport, double(DecodeReportCount), "reports");
+
+#define DS_INPUT_DECODE_BENCHMARK(kernel, columns)                                                                                                           \
+    DS_BENCHMARK("InputDecode/" #kernel "/" #columns, [](uint64_t iterations) { BenchmarkDecode##columns(InputDecodeKernel::kernel, iterations); },         \
+                 double(DecodeReportCount), "reports")
+
+DS_INPUT_DECODE_BENCHMARK(Scalar, All);
+DS_INPUT_DECODE_BENCHMARK(Sse41, All);
+DS_INPUT_DECODE_BENCHMARK(Avx2, All);
+DS_INPUT_DECODE_BENCHMARK(Scalar, Motion);
+DS_INPUT_DECODE_BENCHMARK(Sse41, Motion);
+DS_INPUT_DECODE_BENCHMARK(Avx2, Motion);
@@ -0,0 +1,102 @@
+#include "Bench.hpp"
+
+#include <Daisy/Daisy.hpp>
+#include <Daisy/LatencyHistogram.hpp>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace ds;
+using namespace ds::bench;
+
+static bool CheckPercentiles() {
+    LatencyHistogram histogram;
+    for (uint32_t value = 1; value <= 100000; value++) {
+        histogram.Record(value);
+    }
+    LatencyHistogramSnapshot snapshot{};
+    histogram.Snapshot(&snapshot);
+
+    // a bucket is never wider than 1/16 of its values
+    const auto isNear = [](uint32_t value, uint32_t expected) { return value >= expected && value <= expected + expected / 16; };
+    return snapshot.count == 100000 && snapshot.min == 1 && snapshot.max == 100000 && snapshot.Mean() == 50000.5 &&
+           isNear(snapshot.Percentile(0.5), 50000) && isNear(snapshot.Percentile(0.99), 99000) && snapshot.Percentile(1.0) == 100000 &&
+           snapshot.Percentile(0.0) == 1;
+}
+DS_BENCHMARK_CHECK("Latency histogram percentiles stay within a bucket", CheckPercentiles);
+
+static bool CheckConcurrentRecord() {
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (uint32_t thread = 0; thread < 4; thread++) {
+        threads.emplace_back([&histogram, thread] {
+            for (uint32_t i = 0; i < 100000; i++) {
+                histogram.Record(thread * 1000 + i % 1000);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    LatencyHistogramSnapshot snapshot{};
+    histogram.Snapshot(&snapshot);
+    uint64_t bucketed = 0;
+    for (auto bucket : snapshot.buckets) {
+        bucketed += bucket;
+    }
+    histogram.Reset();
+    LatencyHistogramSnapshot reset{};
+    histogram.Snapshot(&reset);
+    return snapshot.count == 400000 && bucketed == 400000 && snapshot.min == 0 && snapshot.max == 3999 && reset.count == 0 && reset.Percentile(0.5) == 0;
+}
+DS_BENCHMARK_CHECK("Latency histogram counts every concurrent record", CheckConcurrentRecord);
+
+#if defined(DAISY_PLATFORM_VIRTUAL)
+static bool CheckManagerRecordsLatency() {
+    if (DaisyManager::Initialize() != Result::OK)
+        return false;
+    DaisyManager* manager = DaisyManager::Get();
+    VirtualManager* platform = manager->GetPlatform();
+    const auto controller = platform->CreateController(VirtualTransport::Usb);
+    manager->Tick();
+
+    // reports sampled every 4 ms, the last one read 20 ms late
+    report::InputReportData report{};
+    ControllerInput input{};
+    for (int i = 0; i < 8; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(i == 7 ? 24 : 4));
+        report.sensorTimestamp += 12000;
+        platform->InjectReport(controller, report);
+        manager->GetControllerData(controller, &input);
+    }
+
+    LatencyStats stats{};
+    bool ok = manager->GetLatencyStats(controller, &stats) == Result::OK;
+    if constexpr (!StatsEnabled) {
+        DaisyManager::Shutdown();
+        return ok && stats.interArrival.count == 0 && stats.readWait.count == 0;
+    }
+    ok &= stats.interArrival.count == 7 && stats.interArrival.min >= 4000 && stats.interArrival.max >= 24000;
+    ok &= stats.readWait.count == 8 && stats.delivery.count == 0;
+    ok &= stats.queueDelay.count == 7 && stats.queueDelay.max >= 18000 && stats.queueDelay.max < 60000;
+
+    ok &= manager->ResetLatencyStats(controller) == Result::OK && manager->GetLatencyStats(controller, &stats) == Result::OK &&
+          stats.interArrival.count == 0 && stats.queueDelay.count == 0;
+    DaisyManager::Shutdown();
+    return ok;
+}
+DS_BENCHMARK_CHECK("Manager records report arrival and queueing delays", CheckManagerRecordsLatency);
+#endif
+
+static void BenchmarkRecord(uint64_t iterations) {
+    LatencyHistogram histogram;
+    for (uint64_t i = 0; i < iterations; i++) {
+        histogram.Record(4000 + (i & 1023));
+    }
+    LatencyHistogramSnapshot snapshot{};
+    histogram.Snapshot(&snapshot);
+    DoNotOptimize(snapshot);
+}
+DS_BENCHMARK("LatencyHistogram/Record", BenchmarkRecord, 1.0, "values");
@@ -0,0 +1,124 @@
+#include "Bench.hpp"
+
+#include <Daisy/Crc32.hpp>
+#include <Daisy/Daisy.hpp>
+#include <Daisy/LinkQuality.hpp>
+
+#include <array>
+#include <cstring>
+
+using namespace ds;
+using namespace ds::bench;
+
+using BluetoothFrame = std::array<uint8_t, BluetoothInputReportSize>;
+
+/// A valid bluetooth input report with the given sequence number
+static BluetoothFrame MakeFrame(uint32_t sequence, const report::InputReportData& data = {}) {
+    BluetoothFrame frame{};
+    frame[0] = report::BLUETOOTH_INPUT_REPORT_ID;
+    frame[1] = static_cast<uint8_t>(sequence << 4 | 0x1);
+    std::memcpy(frame.data() + offsetof(report::BluetoothInputReport, data), &data, sizeof(data));
+    const size_t crcOffset = frame.size() - sizeof(uint32_t);
+    const uint32_t crc = Crc32(BluetoothInputCrcSeed, frame.data(), crcOffset, false);
+    std::memcpy(frame.data() + crcOffset, &crc, sizeof(crc));
+    return frame;
+}
+
+static bool CheckLossAndCorruption() {
+    LinkQualityMonitor monitor;
+    uint32_t rejected = 0;
+    // 100 frames: every 20th one lost, every 25th one corrupted on the way
+    for (uint32_t sequence = 0; sequence < 100; sequence++) {
+        if (sequence % 20 == 10)
+            continue;
+        auto frame = MakeFrame(sequence);
+        if (sequence % 25 == 5) {
+            frame[20] ^= 0x40;
+        }
+        rejected += monitor.Process(frame.data(), frame.size()) ? 0 : 1;
+    }
+
+    LinkQuality quality{};
+    monitor.Snapshot(&quality);
+    return rejected == 3 && quality.framesReceived == 92 && quality.framesLost == 5 && quality.framesCorrupt == 3 && quality.windowFrames == 100 &&
+           quality.lossRate == 0.05f && quality.corruptionRate == 0.03f;
+}
+DS_BENCHMARK_CHECK("Link quality counts sequence gaps and crc failures", CheckLossAndCorruption);
+
+static bool CheckSlidingWindow() {
+    LinkQualityMonitor monitor;
+    // a burst of 10 lost frames, then a clean link long enough to push it out of the window
+    uint32_t sequence = 0;
+    for (; sequence < 50; sequence++) {
+        const auto frame = MakeFrame(sequence);
+        monitor.Process(frame.data(), frame.size());
+    }
+    sequence += 10;
+    const auto afterBurst = MakeFrame(sequence++);
+    monitor.Process(afterBurst.data(), afterBurst.size());
+
+    LinkQuality burst{};
+    monitor.Snapshot(&burst);
+    for (uint32_t i = 0; i < LinkQualityWindowFrames; i++, sequence++) {
+        const auto frame = MakeFrame(sequence);
+        monitor.Process(frame.data(), frame.size());
+    }
+    LinkQuality clean{};
+    monitor.Snapshot(&clean);
+    return burst.framesLost == 10 && burst.lossRate == 10.0f / 61.0f && clean.framesLost == 10 && clean.lossRate == 0.0f &&
+           clean.windowFrames == LinkQualityWindowFrames;
+}
+DS_BENCHMARK_CHECK("Link quality rates only cover the latest frames", CheckSlidingWindow);
+
+#if defined(DAISY_PLATFORM_VIRTUAL)
+static bool CheckManagerRejectsCorruptFrames() {
+    if (DaisyManager::Initialize() != Result::OK)
+        return false;
+    DaisyManager* manager = DaisyManager::Get();
+    VirtualManager* platform = manager->GetPlatform();
+    // the queue only holds 4 reports, like an os buffer overflowing while nobody reads
+    const auto controller = platform->CreateController(VirtualTransport::Bluetooth, 4);
+    manager->Tick();
+
+    report::InputReportData report{};
+    report.x = 10;
+    ControllerInput input{};
+    platform->InjectReport(controller, report);
+    bool ok = manager->GetControllerData(controller, &input) == Result::OK && input.analog.leftStick.x == 10;
+
+    for (int i = 0; i < 10; i++) {
+        platform->InjectReport(controller, report);
+    }
+    while (manager->PollControllerData(controller, &input) == Result::OK) {
+    }
+
+    // a corrupt report never replaces the last valid input
+    report.x = 200;
+    auto corrupt = MakeFrame(11, report);
+    corrupt[30] ^= 0x01;
+    platform->InjectRawReport(controller, corrupt.data(), corrupt.size());
+    ok &= manager->PollControllerData(controller, &input) == Result::TIMEOUT && input.analog.leftStick.x == 10;
+
+    LinkQuality quality{};
+    ok &= manager->GetLinkQuality(controller, &quality) == Result::OK;
+    ok &= quality.framesReceived == 5 && quality.framesLost == 6 && quality.framesCorrupt == 1;
+    DaisyManager::Shutdown();
+    return ok;
+}
+DS_BENCHMARK_CHECK("Manager drops corrupt bluetooth frames and counts lost ones", CheckManagerRejectsCorruptFrames);
+#endif
+
+static void BenchmarkProcess(uint64_t iterations) {
+    std::array<BluetoothFrame, 16> frames{};
+    for (uint32_t sequence = 0; sequence < frames.size(); sequence++) {
+        frames[sequence] = MakeFrame(sequence);
+    }
+
+    LinkQualityMonitor monitor;
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (const auto& frame : frames) {
+            DoNotOptimize(monitor.Process(frame.data(), frame.size()));
+        }
+    }
+}
+DS_BENCHMARK("LinkQuality/Process", BenchmarkProcess, 16.0, "reports");
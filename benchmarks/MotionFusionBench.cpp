@@ -0,0 +1,167 @@
+#include "Bench.hpp"
+
+#include <Daisy/Daisy.hpp>
+#include <Daisy/MotionFusion.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace ds;
+using namespace ds::bench;
+
+constexpr size_t MotionSampleCount = 1024;
+/// Report interval of a usb controller
+constexpr float MotionSampleInterval = 0.004f;
+
+/// Samples of a controller being waved around, a few without gravity or without elapsed time
+static std::vector<MotionSample> RandomSamples(uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> rate(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> accel(-2.0f, 2.0f);
+    std::vector<MotionSample> samples(MotionSampleCount);
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i].gyro = {rate(random), rate(random), rate(random)};
+        samples[i].accel = i % 97 == 0 ? Vec3<float>{0.0f, 0.0f, 0.0f} : Vec3<float>{accel(random), accel(random), accel(random)};
+        samples[i].dt = i % 89 == 0 ? 0.0f : MotionSampleInterval;
+    }
+    return samples;
+}
+
+static bool SameBits(float a, float b) { return std::memcmp(&a, &b, sizeof(float)) == 0; }
+
+/// Lanes of a bank, including the ones past the last full vector, step exactly like the scalar filter
+static bool CheckBankMatchesScalar(MotionFilter filter) {
+    constexpr size_t LaneCount = 7;
+    MotionFusionSettings settings{};
+    settings.filter = filter;
+    settings.ki = 0.05f;
+
+    std::vector<std::vector<MotionSample>> laneSamples;
+    for (size_t lane = 0; lane < LaneCount; lane++) {
+        laneSamples.push_back(RandomSamples(static_cast<uint32_t>(lane + 1)));
+    }
+
+    MotionFusionBank bank(LaneCount, settings);
+    std::vector<MotionFusionState> states(LaneCount);
+    std::vector<MotionSample> step(LaneCount);
+    for (size_t i = 0; i < MotionSampleCount; i++) {
+        for (size_t lane = 0; lane < LaneCount; lane++) {
+            step[lane] = laneSamples[lane][i];
+            UpdateMotionFusion(settings, step[lane], &states[lane]);
+        }
+        bank.Update(step.data());
+    }
+
+    for (size_t lane = 0; lane < LaneCount; lane++) {
+        const auto q = bank.Orientation(lane);
+        const auto& expected = states[lane].orientation;
+        if (!SameBits(q.w, expected.w) || !SameBits(q.x, expected.x) || !SameBits(q.y, expected.y) || !SameBits(q.z, expected.z))
+            return false;
+    }
+    return true;
+}
+DS_BENCHMARK_CHECK("MotionFusionBank matches scalar Madgwick", [] { return CheckBankMatchesScalar(MotionFilter::Madgwick); });
+DS_BENCHMARK_CHECK("MotionFusionBank matches scalar Mahony", [] { return CheckBankMatchesScalar(MotionFilter::Mahony); });
+
+/// A controller held still at a tilt ends up with an orientation that predicts the measured gravity
+static bool CheckConvergesToGravity(MotionFilter filter) {
+    MotionFusionSettings settings{};
+    settings.filter = filter;
+    settings.beta = 0.5f;
+    settings.kp = 2.0f;
+
+    const float tilt = 0.6f;
+    const MotionSample sample{{0.0f, 0.0f, 0.0f}, {0.0f, std::sin(tilt), std::cos(tilt)}, MotionSampleInterval};
+    MotionFusionState state{};
+    for (int i = 0; i < 5000; i++) {
+        UpdateMotionFusion(settings, sample, &state);
+    }
+
+    // world up rotated into the controller frame, Madgwick keeps circling the solution by about beta * dt
+    const auto& q = state.orientation;
+    const float upX = 2.0f * (q.x * q.z - q.w * q.y);
+    const float upY = 2.0f * (q.w * q.x + q.y * q.z);
+    const float upZ = q.w * q.w - q.x * q.x - q.y * q.y + q.z * q.z;
+    return std::abs(upX - sample.accel.x) < 1e-2f && std::abs(upY - sample.accel.y) < 1e-2f && std::abs(upZ - sample.accel.z) < 1e-2f;
+}
+DS_BENCHMARK_CHECK("Madgwick converges to a tilted gravity", [] { return CheckConvergesToGravity(MotionFilter::Madgwick); });
+DS_BENCHMARK_CHECK("Mahony converges to a tilted gravity", [] { return CheckConvergesToGravity(MotionFilter::Mahony); });
+
+#if defined(DAISY_PLATFORM_VIRTUAL)
+/// Turning at 90 deg/s for a second, read once at the end, ends up a quarter turn around the vertical axis
+static bool CheckManagerTracksEveryReport() {
+    if (DaisyManager::Initialize() != Result::OK)
+        return false;
+    DaisyManager* manager = DaisyManager::Get();
+    VirtualManager* platform = manager->GetPlatform();
+    const auto controller = platform->CreateController(VirtualTransport::Usb);
+    manager->Tick();
+
+    MotionFusionSettings settings{};
+    // gravity matches the identity orientation anyway, so only the gyroscope turns the controller
+    settings.beta = 0.0f;
+    bool ok = manager->EnableMotionFusion(controller, settings) == Result::OK;
+
+    InputBatch batch{};
+    ControllerHandle handle{};
+    batch.capacity = 1;
+    batch.controllers = &handle;
+    report::InputReportData report{};
+    report.accelY = static_cast<uint16_t>(NominalAccelCountsPerG);
+    report.gyroYaw = static_cast<uint16_t>(std::lround(90.0f * NominalGyroCountsPerDegreePerSecond));
+    const auto ticksPerReport = static_cast<uint32_t>(MotionSampleInterval * SensorTimestampTicksPerSecond);
+    // starts right before the wrap around of the sensor clock
+    report.sensorTimestamp = 0xffffffffu - 100 * ticksPerReport;
+    for (int i = 0; i <= 250; i++) {
+        platform->InjectReport(controller, report);
+        report.sensorTimestamp += ticksPerReport;
+        // reports pile up between polls, every one of them has to be integrated
+        if (i % 8 == 7) {
+            ok &= manager->PollAll(&batch, 0) == Result::OK;
+        }
+    }
+
+    ControllerInput input{};
+    ok &= manager->PollControllerData(controller, &input) == Result::OK;
+    // a quarter turn around world z is (cos 45°, 0, 0, sin 45°)
+    const auto& q = input.orientation;
+    ok &= std::abs(q.w - std::sqrt(0.5f)) < 1e-2f && std::abs(q.z - std::sqrt(0.5f)) < 1e-2f && std::abs(q.x) < 1e-3f && std::abs(q.y) < 1e-3f;
+
+    ok &= manager->DisableMotionFusion(controller) == Result::OK;
+    platform->InjectReport(controller, report);
+    ok &= manager->GetControllerData(controller, &input) == Result::OK && input.orientation.w == 1.0f;
+    DaisyManager::Shutdown();
+    return ok;
+}
+DS_BENCHMARK_CHECK("Manager fuses every report of a controller", CheckManagerTracksEveryReport);
+#endif
+
+static void BenchmarkScalar(MotionFilter filter, uint64_t iterations) {
+    MotionFusionSettings settings{};
+    settings.filter = filter;
+    const auto samples = RandomSamples(1);
+    MotionFusionState state{};
+    for (uint64_t i = 0; i < iterations; i++) {
+        UpdateMotionFusion(settings, samples[i % MotionSampleCount], &state);
+        DoNotOptimize(state);
+    }
+}
+DS_BENCHMARK("MotionFusion/Scalar/Madgwick", [](uint64_t iterations) { BenchmarkScalar(MotionFilter::Madgwick, iterations); }, 1.0, "samples");
+DS_BENCHMARK("MotionFusion/Scalar/Mahony", [](uint64_t iterations) { BenchmarkScalar(MotionFilter::Mahony, iterations); }, 1.0, "samples");
+
+/// Every iteration steps all controllers of the bank by one sample
+static void BenchmarkBank(MotionFilter filter, size_t laneCount, uint64_t iterations) {
+    MotionFusionSettings settings{};
+    settings.filter = filter;
+    const auto samples = RandomSamples(1);
+    MotionFusionBank bank(laneCount, settings);
+    const size_t steps = MotionSampleCount / laneCount;
+    for (uint64_t i = 0; i < iterations; i++) {
+        bank.Update(&samples[(i % steps) * laneCount]);
+        DoNotOptimize(bank);
+    }
+}
+DS_BENCHMARK("MotionFusion/Bank/16/Madgwick", [](uint64_t iterations) { BenchmarkBank(MotionFilter::Madgwick, 16, iterations); }, 16.0, "samples");
+DS_BENCHMARK("MotionFusion/Bank/16/Mahony", [](uint64_t iterations) { BenchmarkBank(MotionFilter::Mahony, 16, iterations); }, 16.0, "samples");
@@ -0,0 +1,154 @@
+#include "Bench.hpp"
+
+#include <Daisy/ControllerOutput.hpp>
+#include <Daisy/Daisy.hpp>
+
+#include <cstring>
+
+using namespace ds;
+using namespace ds::bench;
+using namespace ds::literals;
+
+static void BenchmarkOutputBuilder(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        const auto value = static_cast<uint8_t>(i);
+        const auto data = OutputBuilder()
+                              .SetLeftMotor(value)
+                              .SetRightMotor(value)
+                              .SetLeftTrigger(AdaptiveTriggerBuilder::Feedback(value % 10, 4))
+                              .SetRightTrigger(AdaptiveTriggerBuilder::Weapon(2, 6, 8))
+                              .SetMicLed(MicLed::On)
+                              .SetPlayerLed(PlayerLedFlags::Center)
+                              .SetLedColor({value, 0x40, 0x80})
+                              .Build();
+        DoNotOptimize(data);
+    }
+}
+DS_BENCHMARK("Output/OutputBuilder::Build", BenchmarkOutputBuilder);
+
+#define DS_TRIGGER_BENCHMARK(name, ...)                                                                                                                      \
+    DS_BENCHMARK("Output/AdaptiveTriggerBuilder::" #name, [](uint64_t iterations) {                                                                          \
+        for (uint64_t i = 0; i < iterations; i++) {                                                                                                          \
+            const auto value = static_cast<uint8_t>(i);                                                                                                      \
+            DoNotOptimize(value);                                                                                                                            \
+            const auto data = AdaptiveTriggerBuilder::name(__VA_ARGS__);                                                                                     \
+            DoNotOptimize(data);                                                                                                                             \
+        }                                                                                                                                                    \
+    })
+
+DS_TRIGGER_BENCHMARK(Off);
+DS_TRIGGER_BENCHMARK(Feedback, value % 10, 5);
+DS_TRIGGER_BENCHMARK(Weapon, value % 8, 8, 5);
+DS_TRIGGER_BENCHMARK(Vibration, value % 10, 6, 40);
+DS_TRIGGER_BENCHMARK(MultiplePositionFeedback, {0, 1, 2, 3, 4, 5, 6, 7, 8, static_cast<uint8_t>(value % 9)});
+DS_TRIGGER_BENCHMARK(SlopeFeedback, value % 5, 8, 1, 8);
+DS_TRIGGER_BENCHMARK(MultiplePositionVibration, {0, 1, 2, 3, 4, 5, 6, 7, 8, static_cast<uint8_t>(value % 9)}, 30);
+DS_TRIGGER_BENCHMARK(Bow, value % 4, 6, 5, 8);
+DS_TRIGGER_BENCHMARK(Galloping, value % 4, 9, 2, 5, 20);
+DS_TRIGGER_BENCHMARK(Machine, value % 4, 9, 1, 6, 40, 3);
+
+static void BenchmarkTriggerUtils(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        const float value = static_cast<float>(i & 0xff) / 255.0f;
+        const uint8_t zone = TriggerUtils::Zone(value);
+        const uint8_t strength = TriggerUtils::Strength(value);
+        DoNotOptimize(zone);
+        DoNotOptimize(strength);
+    }
+}
+DS_BENCHMARK("Output/TriggerUtils", BenchmarkTriggerUtils);
+
+// effects built from constants are compile-time constants
+static_assert(0.5_z == 5 && 1.0_s == 8 && TriggerUtils::Zone(0.25f) == 2 && TriggerUtils::Strength(0.8f) == 6);
+static_assert(AdaptiveTriggerBuilder::Feedback(7, 2).activeZones == 0x380 && AdaptiveTriggerBuilder::Feedback(7, 2).forceZones[2] == 0x40 &&
+              AdaptiveTriggerBuilder::Feedback(7, 2).forceZones[3] == 0x12);
+static_assert(AdaptiveTriggerBuilder::Weapon(0.2_z, 0.6_z, 1.0_s).activeZones == 0x24 && AdaptiveTriggerBuilder::Weapon(2, 5, 8).forceZones[0] == 7);
+static_assert(AdaptiveTriggerBuilder::SlopeFeedback(0, 9, 1, 8).forceZones[0] == 0x88 && AdaptiveTriggerBuilder::Feedback(3, 0).mode == report::TriggerMode::Off);
+
+constexpr TriggerEffectTable TriggerEffects{
+    TriggerEffect{"bow", AdaptiveTriggerBuilder::Bow(1, 6, 6, 8)},
+    TriggerEffect{"horse", AdaptiveTriggerBuilder::Galloping(0, 9, 2, 5, 20)},
+    TriggerEffect{"engine", AdaptiveTriggerBuilder::Machine(1, 9, 1, 6, 40, 3)},
+    TriggerEffect{"ramp", AdaptiveTriggerBuilder::MultiplePositionVibration({0, 1, 2, 3, 4, 5, 6, 7, 8, 8}, 30)},
+};
+static_assert(TriggerEffects.Size() == 4 && TriggerEffects.Find("pistol") == nullptr);
+static_assert(TriggerEffects.Find("horse")->mode == report::TriggerMode::Galloping);
+
+// the TriggerEffectTable doc example, kept compiling
+constexpr TriggerEffectTable DocumentedEffects{
+    TriggerEffect{"bow", AdaptiveTriggerBuilder::Bow(0.1_z, 0.7_z, 6, 8)},
+    TriggerEffect{"gun", AdaptiveTriggerBuilder::Weapon(2, 6, 8)},
+};
+static_assert(DocumentedEffects.Find("gun") != nullptr && DocumentedEffects.Find("bow")->mode == report::TriggerMode::Bow);
+
+static bool Matches(const report::TriggerData& data, std::array<uint8_t, 11> expected) { return std::memcmp(&data, expected.data(), expected.size()) == 0; }
+
+static bool CheckTriggerModes() {
+    // byte layouts of the effect factories credited in ControllerOutput.hpp
+    return Matches(*TriggerEffects.Find("bow"), {0x22, 0x42, 0x00, 0x3d, 0, 0, 0, 0, 0, 0, 0}) &&
+           Matches(TriggerEffects[1], {0x23, 0x01, 0x02, 0x15, 20, 0, 0, 0, 0, 0, 0}) &&
+           Matches(TriggerEffects[2], {0x27, 0x02, 0x02, 0x31, 40, 3, 0, 0, 0, 0, 0}) &&
+           Matches(TriggerEffects[3], {0x26, 0xfe, 0x03, 0x40, 0x34, 0xd6, 0x3f, 0, 0, 30, 0}) &&
+           Matches(AdaptiveTriggerBuilder::Bow(6, 6, 6, 8), {0x05, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}) &&
+           Matches(AdaptiveTriggerBuilder::Galloping(0, 9, 5, 2, 20), {0x05, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+}
+DS_BENCHMARK_CHECK("Trigger effect modes pack their parameters", CheckTriggerModes);
+
+static void BenchmarkCalculateCrc(uint64_t iterations) {
+    report::BluetoothOutputReport outputReport{};
+    outputReport.reportId = 0x31;
+    outputReport.outputMode = report::BluetoothOutputMode::DS5;
+    for (uint64_t i = 0; i < iterations; i++) {
+        outputReport.data.lightbarColor.r = static_cast<uint8_t>(i);
+        CalculateCrc(outputReport);
+        DoNotOptimize(outputReport.crc);
+    }
+}
+DS_BENCHMARK("Output/CalculateCrc", BenchmarkCalculateCrc, 1.0, "reports");
+
+static report::OutputReportData MakeFrameOutput(uint8_t value) {
+    return OutputBuilder()
+        .SetLeftMotor(value)
+        .SetRightMotor(0)
+        .SetLeftTrigger(AdaptiveTriggerBuilder::Feedback(5, 4))
+        .SetRightTrigger(AdaptiveTriggerBuilder::Weapon(2, 6, 8))
+        .SetMicLed(MicLed::Pulsating)
+        .SetLedColor({0x20, 0x40, 0x80})
+        .Build();
+}
+
+static bool CheckOutputDiff() {
+    OutputState state;
+    const auto first = MakeFrameOutput(10);
+    if (state.Diff(first).flags1 != first.flags1)
+        return false;
+    state.Apply(first);
+    if (!OutputState::IsEmpty(state.Diff(first)))
+        return false;
+
+    // only the motors changed, everything else must be dropped
+    const auto changed = state.Diff(MakeFrameOutput(20));
+    if (changed.flags1 != report::ChangeFlags1::EnableHaptics || changed.flags2 != report::ChangeFlags2::None)
+        return false;
+
+    // the same pulse is triggered again, it's a command and not state
+    report::OutputReportData pulse{};
+    pulse.flags3 = report::ChangeFlags3::UnInterruptableLed;
+    pulse.lightbarPulseOptions = report::LightbarPulseOptions::FadeOutBlue;
+    state.Apply(pulse);
+    return state.Diff(pulse).flags3 == report::ChangeFlags3::UnInterruptableLed;
+}
+DS_BENCHMARK_CHECK("OutputState drops unchanged flags", CheckOutputDiff);
+
+static void BenchmarkOutputDiff(uint64_t iterations) {
+    OutputState state;
+    for (uint64_t i = 0; i < iterations; i++) {
+        // the motor changes every 4th frame, like a game loop re-sending mostly identical output
+        const auto data = state.Diff(MakeFrameOutput(static_cast<uint8_t>(i >> 2)));
+        if (!OutputState::IsEmpty(data)) {
+            state.Apply(data);
+        }
+        DoNotOptimize(data);
+    }
+}
+DS_BENCHMARK("Output/OutputState::Diff", BenchmarkOutputDiff, 1.0, "reports");
@@ -0,0 +1,72 @@
+#include "Bench.hpp"
+
+#include <Daisy/Daisy.hpp>
+
+#include <vector>
+
+using namespace ds;
+using namespace ds::bench;
+
+#if defined(DAISY_PLATFORM_VIRTUAL)
+static bool CheckManagerCountsReports() {
+    if (DaisyManager::Initialize() != Result::OK)
+        return false;
+    DaisyManager* manager = DaisyManager::Get();
+    VirtualManager* platform = manager->GetPlatform();
+    const auto controller = platform->CreateController(VirtualTransport::Usb);
+    manager->Tick();
+
+    // two input reports around one that doesn't carry input, then a read finding nothing
+    const uint8_t unknownReport[] = {0x05, 0x00, 0x00, 0x00};
+    report::InputReportData report{};
+    platform->InjectReport(controller, report);
+    platform->InjectRawReport(controller, unknownReport, sizeof(unknownReport));
+    platform->InjectReport(controller, report);
+    ControllerInput input{};
+    manager->GetControllerData(controller, &input);
+    manager->GetControllerData(controller, &input);
+    manager->GetControllerData(controller, &input);
+
+    OutputBuilder output;
+    manager->SetControllerData(controller, output.SetLedColor({255, 0, 0}).Build());
+    std::vector<std::vector<uint8_t>> sentReports;
+    platform->TakeSentReports(controller, &sentReports);
+    uint64_t sentBytes = 0;
+    for (const auto& sent : sentReports) {
+        sentBytes += sent.size();
+    }
+
+    ControllerStats stats{};
+    bool ok = manager->GetStats(controller, &stats) == Result::OK;
+    if constexpr (StatsEnabled) {
+        ok &= stats.reportsRead == 3 && stats.reportsDiscarded == 1 && stats.timeouts == 1 && stats.queueFlushes == 0 &&
+              stats.bytesReceived == 2 * USBInputReportSize + sizeof(unknownReport) && stats.bytesSent == sentBytes && sentReports.size() == 2 &&
+              stats.sendFailures == 0;
+    } else {
+        ok &= stats.reportsRead == 0 && stats.bytesSent == 0;
+    }
+
+    // the counters of a controller outlive it in the global ones
+    platform->DestroyController(controller);
+    manager->Tick();
+    GlobalStats global{};
+    manager->GetGlobalStats(&global);
+    if constexpr (StatsEnabled) {
+        ok &= global.connections == 1 && global.disconnections == 1 && global.controllers.reportsRead == 3 && global.controllers.bytesSent == sentBytes;
+    } else {
+        ok &= global.connections == 0 && global.controllers.reportsRead == 0;
+    }
+    DaisyManager::Shutdown();
+    return ok;
+}
+DS_BENCHMARK_CHECK("Manager counts reads, discarded reports, timeouts and sent bytes", CheckManagerCountsReports);
+#endif
+
+static void BenchmarkStatCounter(uint64_t iterations) {
+    StatCounter counter;
+    for (uint64_t i = 0; i < iterations; i++) {
+        counter.Add(64);
+        DoNotOptimize(counter);
+    }
+}
+DS_BENCHMARK("Stats/StatCounter/Add", BenchmarkStatCounter, 1.0, "increments");
@@ -0,0 +1,225 @@
+#include "Bench.hpp"
+
+#include <Daisy/Daisy.hpp>
+#include <Daisy/TouchGestures.hpp>
+
+#include <cmath>
+#include <vector>
+
+using namespace ds;
+using namespace ds::bench;
+
+/// Sensor ticks between two reports, 4 ms
+constexpr uint32_t ReportInterval = 12000;
+
+/// One finger or none per report, with the report time in ms
+struct Stroke {
+    std::vector<ControllerInput> inputs;
+    uint32_t timestamp = 0;
+
+    void Wait(uint32_t ms) {
+        for (uint32_t elapsed = 0; elapsed < ms; elapsed += 4) {
+            Add({}, {});
+        }
+    }
+
+    void Add(TouchPoint point1, TouchPoint point2) {
+        ControllerInput input{};
+        input.sensorTimestamp = timestamp;
+        input.touchData.point1 = point1;
+        input.touchData.point2 = point2;
+        inputs.push_back(input);
+        timestamp += ReportInterval;
+    }
+
+    /// Moves a single finger in a straight line, one report every 4 ms
+    void Drag(uint8_t id, Vec2<uint16_t> from, Vec2<uint16_t> to, uint32_t ms) {
+        const uint32_t steps = ms / 4;
+        for (uint32_t i = 0; i <= steps; i++) {
+            const float t = steps == 0 ? 1.0f : static_cast<float>(i) / static_cast<float>(steps);
+            Add({true, id, Lerp(from, to, t)}, {});
+        }
+    }
+
+    static Vec2<uint16_t> Lerp(Vec2<uint16_t> from, Vec2<uint16_t> to, float t) {
+        return {static_cast<uint16_t>(std::lround(from.x + (to.x - from.x) * t)), static_cast<uint16_t>(std::lround(from.y + (to.y - from.y) * t))};
+    }
+};
+
+static std::vector<TouchGestureEvent> Recognize(const std::vector<ControllerInput>& inputs) {
+    TouchGestureRecognizer recognizer;
+    SpscRing<TouchGestureEvent> ring(256);
+    for (const auto& input : inputs) {
+        recognizer.Process(input, ring);
+    }
+
+    std::vector<TouchGestureEvent> events;
+    TouchGestureEvent event{};
+    while (ring.Pop(&event)) {
+        events.push_back(event);
+    }
+    return events;
+}
+
+static bool CheckTap() {
+    Stroke stroke;
+    stroke.Wait(8);
+    stroke.Drag(0, {960, 540}, {965, 542}, 80);
+    stroke.Wait(8);
+    const auto events = Recognize(stroke.inputs);
+    return events.size() == 1 && events[0].type == TouchGestureType::Tap && events[0].position.x == 960 && events[0].position.y == 540;
+}
+DS_BENCHMARK_CHECK("Short still touch is a tap", CheckTap);
+
+static bool CheckDoubleTap() {
+    Stroke stroke;
+    stroke.Drag(0, {960, 540}, {960, 540}, 60);
+    stroke.Wait(100);
+    stroke.Drag(1, {980, 550}, {980, 550}, 60);
+    stroke.Wait(8);
+    // a third tap right after starts over instead of making another double tap
+    stroke.Drag(2, {980, 550}, {980, 550}, 60);
+    stroke.Wait(8);
+    const auto events = Recognize(stroke.inputs);
+    return events.size() == 4 && events[0].type == TouchGestureType::Tap && events[1].type == TouchGestureType::Tap &&
+           events[2].type == TouchGestureType::DoubleTap && events[3].type == TouchGestureType::Tap;
+}
+DS_BENCHMARK_CHECK("Two quick taps make a double tap", CheckDoubleTap);
+
+static bool CheckSwipe() {
+    Stroke stroke;
+    // 800 units in 200 ms, lifted by the report 4 ms later, while slow strokes are nothing
+    stroke.Drag(0, {400, 500}, {1200, 540}, 200);
+    stroke.Wait(8);
+    stroke.Drag(1, {960, 900}, {960, 700}, 800);
+    stroke.Wait(8);
+    const auto events = Recognize(stroke.inputs);
+    return events.size() == 1 && events[0].type == TouchGestureType::Swipe && events[0].direction == SwipeDirection::Right &&
+           std::abs(events[0].value - 801.0f / 0.204f) < 10.0f && events[0].position.x == 1200;
+}
+DS_BENCHMARK_CHECK("Fast stroke is a swipe with its velocity", CheckSwipe);
+
+static bool CheckPinch() {
+    Stroke stroke;
+    // fingers 200 apart spreading to 400 apart while turning a quarter turn clockwise
+    stroke.Add({true, 0, {860, 540}}, {true, 1, {1060, 540}});
+    for (int i = 1; i <= 50; i++) {
+        const float angle = 1.5707964f * static_cast<float>(i) / 50.0f;
+        const float radius = 100.0f + 100.0f * static_cast<float>(i) / 50.0f;
+        const auto dx = static_cast<float>(radius * std::cos(angle));
+        const auto dy = static_cast<float>(radius * std::sin(angle));
+        stroke.Add({true, 0, {static_cast<uint16_t>(std::lround(960 - dx)), static_cast<uint16_t>(std::lround(540 - dy))}},
+                   {true, 1, {static_cast<uint16_t>(std::lround(960 + dx)), static_cast<uint16_t>(std::lround(540 + dy))}});
+    }
+    // lifting one finger ends the pinch, the other one isn't a tap or swipe afterwards
+    stroke.Add({true, 0, {960, 340}}, {});
+    stroke.Add({}, {});
+
+    const auto events = Recognize(stroke.inputs);
+    if (events.size() != 52 || events.front().phase != TouchGesturePhase::Begin || events.back().phase != TouchGesturePhase::End)
+        return false;
+    for (const auto& event : events) {
+        if (event.type != TouchGestureType::Pinch)
+            return false;
+    }
+    const auto& last = events[events.size() - 2];
+    return std::abs(last.value - 2.0f) < 0.02f && std::abs(last.rotation - 1.5707964f) < 0.02f && last.position.x == 960 && last.position.y == 540;
+}
+DS_BENCHMARK_CHECK("Two fingers spreading and turning pinch", CheckPinch);
+
+static bool CheckEdgeScroll() {
+    Stroke stroke;
+    // down along the right edge, then a stroke away from the edge that doesn't scroll
+    stroke.Drag(0, {1880, 300}, {1885, 700}, 400);
+    stroke.Wait(8);
+    stroke.Drag(1, {1880, 300}, {1500, 320}, 400);
+    stroke.Wait(8);
+    const auto events = Recognize(stroke.inputs);
+    if (events.size() < 3 || events.front().phase != TouchGesturePhase::Begin || events.back().phase != TouchGesturePhase::End)
+        return false;
+
+    float distance = 0.0f;
+    for (const auto& event : events) {
+        if (event.type != TouchGestureType::EdgeScroll || event.edge != TouchEdge::Right)
+            return false;
+        distance += event.value;
+    }
+    return std::abs(distance - 400.0f) < 1.0f;
+}
+DS_BENCHMARK_CHECK("Stroke along an edge scrolls", CheckEdgeScroll);
+
+#if defined(DAISY_PLATFORM_VIRTUAL)
+static bool CheckManagerRecognizesQueuedReports() {
+    if (DaisyManager::Initialize() != Result::OK)
+        return false;
+    DaisyManager* manager = DaisyManager::Get();
+    VirtualManager* platform = manager->GetPlatform();
+    const auto controller = platform->CreateController(VirtualTransport::Usb, 64);
+    manager->Tick();
+    bool ok = manager->SubscribeTouchGestures(controller) == Result::OK;
+
+    // the whole tap arrives between two polls
+    Stroke stroke;
+    stroke.Drag(0, {960, 540}, {960, 540}, 20);
+    stroke.Wait(8);
+    for (const auto& input : stroke.inputs) {
+        report::InputReportData report{};
+        report.sensorTimestamp = input.sensorTimestamp;
+        const auto& point = input.touchData.point1;
+        report.touchData.point1 = {static_cast<uint8_t>(point.isTouching ? point.id : 0x80), static_cast<uint8_t>(point.pos.x & 0xff),
+                                   static_cast<uint8_t>((point.pos.x >> 8) | ((point.pos.y & 0xf) << 4)), static_cast<uint8_t>(point.pos.y >> 4)};
+        report.touchData.point2.id = 0x80;
+        platform->InjectReport(controller, report);
+    }
+    ControllerHandle handle{};
+    InputBatch batch{};
+    batch.capacity = 1;
+    batch.controllers = &handle;
+    ok &= manager->PollAll(&batch, 0) == Result::OK;
+
+    TouchGestureEvent events[4]{};
+    size_t count = 0;
+    ok &= manager->GetTouchGestures(controller, events, 4, &count) == Result::OK && count == 1 && events[0].type == TouchGestureType::Tap &&
+          events[0].position.x == 960 && events[0].position.y == 540;
+    ok &= manager->SubscribeTouchGestures(controller, {}, 0) == Result::INVALID_PARAMETER;
+    DaisyManager::Shutdown();
+    return ok;
+}
+DS_BENCHMARK_CHECK("Manager recognizes gestures in reports drained by PollAll", CheckManagerRecognizesQueuedReports);
+#endif
+
+/// A mix of taps, swipes, edge scrolls and pinches
+static const Stroke& BenchmarkStroke() {
+    static const Stroke stroke = [] {
+        Stroke mix;
+        mix.Drag(0, {960, 540}, {962, 541}, 60);
+        mix.Wait(20);
+        mix.Drag(1, {400, 500}, {1200, 540}, 200);
+        mix.Wait(20);
+        mix.Drag(2, {1880, 300}, {1885, 700}, 200);
+        for (int i = 0; i <= 50; i++) {
+            mix.Add({true, 3, {static_cast<uint16_t>(860 - i * 2), 540}}, {true, 4, {static_cast<uint16_t>(1060 + i * 2), static_cast<uint16_t>(540 + i)}});
+        }
+        mix.Wait(20);
+        return mix;
+    }();
+    return stroke;
+}
+
+/// The mix played back over and over, with the timestamps running on
+static void BenchmarkProcess(uint64_t iterations) {
+    const auto& stroke = BenchmarkStroke();
+    TouchGestureRecognizer recognizer;
+    SpscRing<TouchGestureEvent> ring(256);
+    TouchGestureEvent event{};
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (auto input : stroke.inputs) {
+            input.sensorTimestamp += static_cast<uint32_t>(i) * stroke.timestamp;
+            recognizer.Process(input, ring);
+        }
+        while (ring.Pop(&event)) {
+            DoNotOptimize(event);
+        }
+    }
+}
+DS_BENCHMARK("TouchGestures/Process", BenchmarkProcess, double(BenchmarkStroke().inputs.size()), "reports");
@@ -0,0 +1,131 @@
+/// Self-contained benchmark runner, every benchmark gets calibrated to run for at least the minimum time
+
+#include "Bench.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+using namespace ds::bench;
+
+namespace ds::bench {
+
+std::vector<Benchmark>& Benchmarks() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+std::vector<Check>& Checks() {
+    static std::vector<Check> checks;
+    return checks;
+}
+
+} // namespace ds::bench
+
+static double RunTimed(const Benchmark& benchmark, uint64_t iterations) {
+    const auto start = std::chrono::steady_clock::now();
+    benchmark.run(iterations);
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+struct BenchmarkResult {
+    const Benchmark* benchmark;
+    uint64_t iterations;
+    double nsPerOp;
+    double itemsPerSecond;
+};
+
+static void WriteJsonString(FILE* file, const std::string& value) {
+    std::fputc('"', file);
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', file);
+            std::fputc(c, file);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            std::fprintf(file, "\\u%04x", c);
+        } else {
+            std::fputc(c, file);
+        }
+    }
+    std::fputc('"', file);
+}
+
+/// Writes the results in a flat json document, one object per benchmark, for tracking results across commits
+static bool WriteJson(const char* path, const std::vector<BenchmarkResult>& results, double minimumTimeMs) {
+    FILE* file = std::fopen(path, "w");
+    if (!file)
+        return false;
+
+    const std::time_t now = std::time(nullptr);
+    char date[32]{};
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    std::fprintf(file, "{\n  \"context\": {\n    \"date\": \"%s\",\n    \"min_time_ms\": %.1f\n  },\n  \"benchmarks\": [", date, minimumTimeMs);
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& result = results[i];
+        std::fprintf(file, "%s\n    {\"name\": ", i == 0 ? "" : ",");
+        WriteJsonString(file, result.benchmark->name);
+        std::fprintf(file, ", \"iterations\": %llu, \"ns_per_op\": %.4f, \"items_per_second\": %.6e, \"item\": ",
+                     static_cast<unsigned long long>(result.iterations), result.nsPerOp, result.itemsPerSecond);
+        WriteJsonString(file, result.benchmark->itemName);
+        std::fputc('}', file);
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+    return std::fclose(file) == 0;
+}
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    const char* jsonPath = nullptr;
+    double minimumTimeMs = 200.0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) {
+            minimumTimeMs = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            std::printf("usage: %s [--filter <substring>] [--min-time-ms <ms>] [--json <path>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    for (const auto& check : Checks()) {
+        if (!check.run()) {
+            std::printf("check failed: %s\n", check.name.c_str());
+            return 1;
+        }
+    }
+
+    std::vector<BenchmarkResult> results;
+    std::printf("%-56s %14s %12s %18s\n", "benchmark", "iterations", "ns/op", "throughput");
+    for (const auto& benchmark : Benchmarks()) {
+        if (filter && benchmark.name.find(filter) == std::string::npos)
+            continue;
+
+        uint64_t iterations = 1;
+        double elapsedNs = RunTimed(benchmark, iterations);
+        while (elapsedNs < minimumTimeMs * 1e6) {
+            const double scale = elapsedNs > 0.0 ? (minimumTimeMs * 1e6 * 1.2) / elapsedNs : 100.0;
+            iterations = static_cast<uint64_t>(static_cast<double>(iterations) * (scale < 100.0 ? scale : 100.0)) + 1;
+            elapsedNs = RunTimed(benchmark, iterations);
+        }
+
+        const double nsPerOp = elapsedNs / static_cast<double>(iterations);
+        const double itemsPerSecond = benchmark.itemsPerIteration * 1e9 / nsPerOp;
+        std::printf("%-56s %14llu %12.2f %12.3e %s/s\n", benchmark.name.c_str(), static_cast<unsigned long long>(iterations), nsPerOp, itemsPerSecond,
+                    benchmark.itemName.c_str());
+        results.push_back({&benchmark, iterations, nsPerOp, itemsPerSecond});
+    }
+
+    if (jsonPath && !WriteJson(jsonPath, results, minimumTimeMs)) {
+        std::printf("failed to write %s\n", jsonPath);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+/// An example showing how to drive controllers from coroutines
+
+#include <Daisy/Coroutines.hpp>
+
+#include <coroutine>
+#include <exception>
+#include <iostream>
+
+using namespace ds;
+
+/// Minimal fire-and-forget coroutine, an engine would use the task type of its own scheduler
+struct Task {
+    struct promise_type {
+        Task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+/// Mirrors the left stick on the lightbar until the controller goes away
+Task RunController(AwaitDispatcher& dispatcher, ControllerHandle controller) {
+    ControllerInput input{};
+    while (co_await dispatcher.NextInput(controller, &input) == Result::OK) {
+        const auto output = OutputBuilder{}.SetLedColor({input.analog.leftStick.x, input.analog.leftStick.y, 0}).Build();
+        if (co_await dispatcher.Send(controller, output) != Result::OK)
+            break;
+    }
+    std::cout << "Controller task finished" << std::endl;
+}
+
+Task WatchControllers(AwaitDispatcher& dispatcher) {
+    HotplugEvent event{};
+    while (co_await dispatcher.NextHotplugEvent(&event) == Result::OK) {
+        if (event.type == HotplugEvent::Type::Connected) {
+            std::cout << "A controller got connected" << std::endl;
+            RunController(dispatcher, event.controller);
+        } else {
+            std::cout << "A controller got disconnected" << std::endl;
+        }
+    }
+}
+
+int main() {
+    Result result = DaisyManager::Initialize();
+    if (result != Result::OK) {
+        std::cout << "Failed to initialize Daisy, reason: " << result.code << std::endl;
+        return -1;
+    }
+
+    AwaitDispatcher dispatcher(DaisyManager::Get());
+    WatchControllers(dispatcher);
+
+    while (1) {
+        dispatcher.Pump(16);
+    }
+}
@@ -0,0 +1,47 @@
+/// An example showing how to record controller traffic, the recording can be played back with the replay platform
+
+#include <Daisy/Daisy.hpp>
+
+#include <chrono>
+#include <iostream>
+
+using namespace ds;
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "recording.dsrc";
+
+    Result result = DaisyManager::Initialize();
+    if (result != Result::OK) {
+        std::cout << "Failed to initialize Daisy, reason: " << result.code << std::endl;
+        return -1;
+    }
+
+    result = DaisyManager::Get()->StartRecording(path);
+    if (result != Result::OK) {
+        std::cout << "Failed to start recording, reason: " << result.code << std::endl;
+        return -1;
+    }
+    std::cout << "Recording to " << path << " for 10 seconds" << std::endl;
+
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+        DaisyManager::Get()->Tick();
+
+        for (auto controller : DaisyManager::Get()->AvailableControllers()) {
+            ControllerInput controllerInput{};
+            if (DaisyManager::Get()->GetControllerData(controller, &controllerInput) != Result::OK)
+                continue;
+
+            auto outputData = OutputBuilder{}.SetLedColor({controllerInput.analog.l2, 0, controllerInput.analog.r2}).Build();
+            DaisyManager::Get()->SetControllerData(controller, outputData);
+        }
+    }
+
+    result = DaisyManager::Get()->StopRecording();
+    DaisyManager::Shutdown();
+    if (result != Result::OK) {
+        std::cout << "Recording is incomplete, reason: " << result.code << std::endl;
+        return -1;
+    }
+    return 0;
+}
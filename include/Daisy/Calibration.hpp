@@ -0,0 +1,45 @@
+#pragma once
+#include <Daisy/Report.hpp>
+#include <Daisy/Vec.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ds {
+
+/// Nominal gyroscope sensitivity, the ±2000 deg/s range over 16 bits, individual controllers deviate by a few percent
+constexpr float NominalGyroCountsPerDegreePerSecond = 32768.0f / 2000.0f;
+/// Nominal accelerometer sensitivity
+constexpr float NominalAccelCountsPerG = 8192.0f;
+
+/// @brief Conversion of the raw motion sensor readings of a controller, computed once when it connects
+///
+/// Every axis is converted as `raw * scale + offset`, the offset being the bias already multiplied by the scale.
+struct MotionCalibration {
+    /// deg/s per count
+    Rot<float> gyroScale;
+    /// deg/s
+    Rot<float> gyroOffset;
+    /// g per count
+    Vec3<float> accelScale;
+    /// g
+    Vec3<float> accelOffset;
+};
+
+/// Calibration assuming a perfect sensor, used until the factory calibration was read or if it's unusable
+constexpr MotionCalibration NominalMotionCalibration{
+    {1.0f / NominalGyroCountsPerDegreePerSecond, 1.0f / NominalGyroCountsPerDegreePerSecond, 1.0f / NominalGyroCountsPerDegreePerSecond},
+    {0.0f, 0.0f, 0.0f},
+    {1.0f / NominalAccelCountsPerG, 1.0f / NominalAccelCountsPerG, 1.0f / NominalAccelCountsPerG},
+    {0.0f, 0.0f, 0.0f},
+};
+
+/// @brief Computes the motion calibration from the calibration feature report, @see report::CalibrationReport
+/// @param reportData report data, starting with the report id
+/// @param reportSize report size
+/// @param bluetooth whether the report was read over bluetooth and carries a crc
+/// @param out calibration output
+/// @returns false for corrupt reports and calibrations too far off the nominal sensitivities, out is left untouched then
+bool ParseCalibrationReport(const uint8_t* reportData, size_t reportSize, bool bluetooth, MotionCalibration* out);
+
+} // namespace ds
@@ -6,6 +6,12 @@
 
 namespace ds {
 
+/// Sensor timestamp ticks per second, @see ControllerInput::sensorTimestamp
+constexpr float SensorTimestampTicksPerSecond = 3000000.0f;
+
+/// @brief Seconds between two sensor timestamps, wrap around included
+inline float SensorTimestampDelta(uint32_t previous, uint32_t current) { return static_cast<float>(current - previous) / SensorTimestampTicksPerSecond; }
+
 /// Analog controller data
 struct AnalogData {
     /// Left stick, range 0..=255
@@ -88,10 +94,14 @@ struct ControllerInput {
     PressedButtons buttons;
     /// Hat switch pressed buttons
     HatSwitch hatSwitch;
-    /// Gyroscope rotation
+    /// Raw gyroscope readings, signed values stored as unsigned
     Rot<uint16_t> gyro;
-    /// Accelerometer values
+    /// Raw accelerometer readings, signed values stored as unsigned
     Vec3<uint16_t> accel;
+    /// Calibrated angular velocity, deg/s
+    Rot<float> angularVelocity;
+    /// Calibrated acceleration, g
+    Vec3<float> acceleration;
     /// Touchpad data
     TouchData touchData;
     /// Trigger feedback data
@@ -100,6 +110,10 @@ struct ControllerInput {
     BatteryData batteryData;
     /// Device flags
     DeviceFlags flags;
+    /// Device timestamp of the report, from the motion sensor clock, wraps around
+    uint32_t sensorTimestamp;
+    /// Orientation of the controller, identity unless tracked, @see DaisyManager::EnableMotionFusion
+    Quat<float> orientation{1.0f, 0.0f, 0.0f, 0.0f};
 };
 
 } // namespace ds
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <Daisy/Vec.hpp>
 
 #include <array>
+#include <cstddef>
+#include <string_view>
 
 namespace ds {
 
@@ -12,17 +14,20 @@ public:
     /// @brief Returns zone index from a floating point value
     /// @param val zone float in range 0..=1
     /// @returns zone index for use with @see AdaptiveTriggerBuilder
-    static uint8_t Zone(float val);
+    static constexpr uint8_t Zone(float val) { return Round(val * 9.0); }
 
     /// @briefs Returns strength from a floating point value
     /// @params val strength float in range 0..=1
     /// @retuns strength for use with @see AdaptiveTriggerBuilder
-    static uint8_t Strength(float val);
+    static constexpr uint8_t Strength(float val) { return Round(val * 8.0); }
+
+    /// @brief Rounds half away from zero like std::round, which isn't constexpr
+    static constexpr uint8_t Round(double val) { return static_cast<uint8_t>(static_cast<int32_t>(val < 0.0 ? val - 0.5 : val + 0.5)); }
 };
 
 namespace literals {
-inline uint8_t operator""_z(long double val) { return TriggerUtils::Zone(static_cast<float>(val)); }
-inline uint8_t operator""_s(long double val) { return TriggerUtils::Strength(static_cast<float>(val)); }
+constexpr uint8_t operator""_z(long double val) { return TriggerUtils::Zone(static_cast<float>(val)); }
+constexpr uint8_t operator""_s(long double val) { return TriggerUtils::Strength(static_cast<float>(val)); }
 } // namespace literals
 
 using AudioFlags = ds::report::AudioFlags;
@@ -77,12 +82,18 @@ private:
 };
 
 // Factories credit: https://gist.github.com/Nielk1/6d54cc2c00d2201ccb8c2720ad7538db
+//
+// Every factory is constexpr, effects built from constants are TriggerData constants.
 class AdaptiveTriggerBuilder {
 public:
     /// Resets all effects
     ///
     /// @returns Trigger data for the effect
-    static ds::report::TriggerData Off();
+    static constexpr ds::report::TriggerData Off() {
+        ds::report::TriggerData data{};
+        data.mode = ds::report::TriggerMode::Off;
+        return data;
+    }
 
     /// Trigger will resist movement beyond the start position
     /// Trigger feedback data will report 0 before the effect, and 1 while the effect is triggered
@@ -91,7 +102,20 @@ public:
     /// @param resistanceForce force of trigger resistance, must be in the range 0..=8
     /// @returns Trigger data for the effect
     /// @note @see TriggerUtils
-    static ds::report::TriggerData Feedback(uint8_t startZone, uint8_t resistanceForce);
+    static constexpr ds::report::TriggerData Feedback(uint8_t startZone, uint8_t resistanceForce) {
+        if (resistanceForce == 0)
+            return Off();
+
+        ds::report::TriggerData data{};
+        data.mode = ds::report::TriggerMode::Feedback;
+        uint64_t forceZones = 0;
+        for (uint8_t i = startZone; i < 10; i++) {
+            forceZones |= static_cast<uint64_t>(resistanceForce) << (3u * i);
+            data.activeZones |= static_cast<uint16_t>(1u << i);
+        }
+        PackZones(forceZones, data);
+        return data;
+    }
 
     /// Trigger will resist movement beyond the start position until the end position
     /// Trigger feedback data will report 0 before the effect, 1 while the effect is triggered, 2 after the end position
@@ -101,7 +125,16 @@ public:
     /// @param resistanceForce force of trigger resistance, must be in the range 0..=8
     /// @returns Trigger data for the effect
     /// @note @see TriggerUtils
-    static ds::report::TriggerData Weapon(uint8_t startZone, uint8_t endZone, uint8_t resistanceForce);
+    static constexpr ds::report::TriggerData Weapon(uint8_t startZone, uint8_t endZone, uint8_t resistanceForce) {
+        if (resistanceForce == 0)
+            return Off();
+
+        ds::report::TriggerData data{};
+        data.mode = ds::report::TriggerMode::Weapon;
+        data.activeZones = StartAndEndZones(startZone, endZone);
+        data.forceZones[0] = static_cast<uint8_t>(resistanceForce - 1);
+        return data;
+    }
 
     /// Trigger will vibrate with the input amplitude and frequency beyond the start position
     /// Trigger feedback data will report 0 before the effect, and 1 while the effect is triggered
@@ -111,14 +144,34 @@ public:
     /// @param frequency frequency of the automatic cycling action in hertz
     /// @returns Trigger data for the effect
     /// @note @see TriggerUtils
-    static ds::report::TriggerData Vibration(uint8_t startZone, uint8_t amplitude, uint8_t frequency);
+    static constexpr ds::report::TriggerData Vibration(uint8_t startZone, uint8_t amplitude, uint8_t frequency) {
+        if (amplitude == 0 || frequency == 0)
+            return Off();
+
+        ds::report::TriggerData data{};
+        data.mode = ds::report::TriggerMode::Vibration;
+        const auto strength = static_cast<uint64_t>((amplitude - 1) & 0x07);
+        uint64_t amplitudeZones = 0;
+        for (uint8_t i = startZone; i < 10; i++) {
+            amplitudeZones |= strength << (3u * i);
+            data.activeZones |= static_cast<uint16_t>(1u << i);
+        }
+        PackZones(amplitudeZones, data);
+        data.frequency = frequency;
+        return data;
+    }
 
     /// Trigger will resist movement at varying strengths in 10 regions
     ///
     /// @param strengths array of 10 resistance values for zones 0 through 9, each strength must be in the range 0..=8
     /// @returns Trigger data for the effect
     /// @note @see TriggerUtils
-    static ds::report::TriggerData MultiplePositionFeedback(std::array<uint8_t, 10> strengths);
+    static constexpr ds::report::TriggerData MultiplePositionFeedback(std::array<uint8_t, 10> strengths) {
+        ds::report::TriggerData data{};
+        data.mode = ds::report::TriggerMode::Feedback;
+        PackStrengths(strengths, data);
+        return data;
+    }
 
     /// Trigger will resist movement at a linear range of strengths
     ///
@@ -128,7 +181,158 @@ public:
     /// @param endStrength resistance of the trigger at the end, must be in range 0..=8
     /// @returns Trigger data for the effect
     /// @note @see TriggerUtils
-    static ds::report::TriggerData SlopeFeedback(uint8_t startZone, uint8_t endZone, uint8_t startStrength, uint8_t endStrength);
+    static constexpr ds::report::TriggerData SlopeFeedback(uint8_t startZone, uint8_t endZone, uint8_t startStrength, uint8_t endStrength) {
+        if (startZone >= endZone || endZone > 9 || startStrength == 0 || endStrength == 0)
+            return Off();
+
+        std::array<uint8_t, 10> strengths{};
+        const float slope = static_cast<float>(endStrength - startStrength) / static_cast<float>(endZone - startZone);
+        for (uint8_t i = startZone; i < 10; i++) {
+            strengths[i] = i <= endZone ? TriggerUtils::Round(startStrength + slope * static_cast<float>(i - startZone)) : endStrength;
+        }
+        return MultiplePositionFeedback(strengths);
+    }
+
+    /// Trigger will vibrate at varying amplitudes in 10 regions
+    /// Trigger feedback data will report 0 before the effect, and 1 while the effect is triggered
+    ///
+    /// @param amplitudes array of 10 amplitudes for zones 0 through 9, each amplitude must be in the range 0..=8
+    /// @param frequency frequency of the automatic cycling action in hertz
+    /// @returns Trigger data for the effect
+    /// @note @see TriggerUtils
+    static constexpr ds::report::TriggerData MultiplePositionVibration(std::array<uint8_t, 10> amplitudes, uint8_t frequency) {
+        if (frequency == 0)
+            return Off();
+
+        ds::report::TriggerData data{};
+        data.mode = ds::report::TriggerMode::Vibration;
+        PackStrengths(amplitudes, data);
+        data.frequency = frequency;
+        return data;
+    }
+
+    /// Trigger will resist movement between the start and end position, and snap back once pulled past the end like a bow string
+    /// Trigger feedback data will report 0 before the effect, 1 while the effect is triggered, 2 after the end position
+    ///
+    /// @param startZone starting zone of the trigger effect, must be in range 0..=8
+    /// @param endZone ending zone of the trigger effect, must be in range (startZone+1)..=8
+    /// @param strength resistance while pulling, must be in range 0..=8
+    /// @param snapForce force pushing the trigger back once released, must be in range 0..=8
+    /// @returns Trigger data for the effect
+    /// @note @see TriggerUtils
+    static constexpr ds::report::TriggerData Bow(uint8_t startZone, uint8_t endZone, uint8_t strength, uint8_t snapForce) {
+        if (startZone >= endZone || endZone > 8 || strength == 0 || snapForce == 0)
+            return Off();
+
+        ds::report::TriggerData data{};
+        data.mode = ds::report::TriggerMode::Bow;
+        data.activeZones = StartAndEndZones(startZone, endZone);
+        data.forceZones[0] = static_cast<uint8_t>(((strength - 1) & 0x07) | ((snapForce - 1) & 0x07) << 3);
+        return data;
+    }
+
+    /// Trigger will kick back twice per cycle between the start and end position, like the hooves of a galloping horse
+    /// Trigger feedback data will report 0 before the effect, 1 while the effect is triggered, 2 after the end position
+    ///
+    /// @param startZone starting zone of the trigger effect, must be in range 0..=8
+    /// @param endZone ending zone of the trigger effect, must be in range (startZone+1)..=9
+    /// @param firstFoot time of the first kick within a cycle, must be in range 0..=6
+    /// @param secondFoot time of the second kick within a cycle, must be in range (firstFoot+1)..=7
+    /// @param frequency cycles per second
+    /// @returns Trigger data for the effect
+    static constexpr ds::report::TriggerData Galloping(uint8_t startZone, uint8_t endZone, uint8_t firstFoot, uint8_t secondFoot, uint8_t frequency) {
+        if (startZone >= endZone || endZone > 9 || firstFoot >= secondFoot || secondFoot > 7 || frequency == 0)
+            return Off();
+
+        ds::report::TriggerData data{};
+        data.mode = ds::report::TriggerMode::Galloping;
+        data.activeZones = StartAndEndZones(startZone, endZone);
+        data.forceZones[0] = static_cast<uint8_t>((secondFoot & 0x07) | (firstFoot & 0x07) << 3);
+        data.forceZones[1] = frequency;
+        return data;
+    }
+
+    /// Trigger will vibrate between the start and end position, alternating between two amplitudes like a running machine
+    /// Trigger feedback data will report 0 before the effect, 1 while the effect is triggered, 2 after the end position
+    ///
+    /// @param startZone starting zone of the trigger effect, must be in range 0..=8
+    /// @param endZone ending zone of the trigger effect, must be in range (startZone+1)..=9
+    /// @param amplitudeA first amplitude, must be in range 0..=7
+    /// @param amplitudeB second amplitude, must be in range 0..=7
+    /// @param frequency frequency of the vibration in hertz
+    /// @param period time spent on one amplitude before switching to the other, in tenths of a second
+    /// @returns Trigger data for the effect
+    static constexpr ds::report::TriggerData Machine(uint8_t startZone, uint8_t endZone, uint8_t amplitudeA, uint8_t amplitudeB, uint8_t frequency,
+                                                     uint8_t period) {
+        if (startZone >= endZone || endZone > 9 || amplitudeA > 7 || amplitudeB > 7 || frequency == 0)
+            return Off();
+
+        ds::report::TriggerData data{};
+        data.mode = ds::report::TriggerMode::Machine;
+        data.activeZones = StartAndEndZones(startZone, endZone);
+        data.forceZones[0] = static_cast<uint8_t>((amplitudeA & 0x07) | (amplitudeB & 0x07) << 3);
+        data.forceZones[1] = frequency;
+        data.forceZones[2] = period;
+        return data;
+    }
+
+private:
+    static constexpr uint16_t StartAndEndZones(uint8_t startZone, uint8_t endZone) { return static_cast<uint16_t>((1u << startZone) | (1u << endZone)); }
+
+    /// Packs 3 bit values of 10 zones, little endian
+    static constexpr void PackZones(uint64_t zones, ds::report::TriggerData& data) {
+        for (size_t i = 0; i < sizeof(data.forceZones); i++) {
+            data.forceZones[i] = static_cast<uint8_t>((zones >> (8 * i)) & 0xff);
+        }
+    }
+
+    /// Packs a 1..=8 value per zone, zones at 0 stay inactive
+    static constexpr void PackStrengths(const std::array<uint8_t, 10>& strengths, ds::report::TriggerData& data) {
+        uint64_t zones = 0;
+        for (uint8_t i = 0; i < 10; i++) {
+            if (strengths[i] > 0) {
+                zones |= static_cast<uint64_t>((strengths[i] - 1) & 0x07) << (3u * i);
+                data.activeZones |= static_cast<uint16_t>(1u << i);
+            }
+        }
+        PackZones(zones, data);
+    }
 };
 
-} // namespace ds
\ No newline at end of file
+/// Named trigger effect, @see TriggerEffectTable
+struct TriggerEffect {
+    std::string_view name;
+    ds::report::TriggerData data;
+};
+
+/// @brief Fixed library of trigger effects, meant to be built at compile time
+///
+/// ```c++
+/// constexpr TriggerEffectTable Effects{
+///     TriggerEffect{"bow", AdaptiveTriggerBuilder::Bow(0.1_z, 0.7_z, 6, 8)},
+///     TriggerEffect{"gun", AdaptiveTriggerBuilder::Weapon(2, 6, 8)},
+/// };
+/// static_assert(Effects.Find("gun") != nullptr);
+/// ```
+template <size_t N>
+struct TriggerEffectTable {
+    std::array<TriggerEffect, N> effects;
+
+    [[nodiscard]] constexpr size_t Size() const { return N; }
+    [[nodiscard]] constexpr const ds::report::TriggerData& operator[](size_t index) const { return effects[index].data; }
+
+    /// @brief Looks up an effect by name
+    /// @returns the effect, or nullptr if there's none with the name
+    [[nodiscard]] constexpr const ds::report::TriggerData* Find(std::string_view name) const {
+        for (const auto& effect : effects) {
+            if (effect.name == name)
+                return &effect.data;
+        }
+        return nullptr;
+    }
+};
+
+template <typename... Effects>
+TriggerEffectTable(Effects...) -> TriggerEffectTable<sizeof...(Effects)>;
+
+} // namespace ds
@@ -0,0 +1,317 @@
+#pragma once
+#include <Daisy/Daisy.hpp>
+
+#if !defined(__cpp_impl_coroutine)
+#error "Daisy/Coroutines.hpp requires C++20 coroutines, link against the DaisyCoroutines target"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ds {
+
+/// Controller connection or disconnection, @see AwaitDispatcher::NextHotplugEvent
+struct HotplugEvent {
+    enum class Type : uint8_t {
+        Connected,
+        Disconnected,
+    };
+
+    Type type = Type::Connected;
+    ControllerHandle controller{};
+    /// User data of a disconnected controller, like the disconnection callback receives
+    void* userData = nullptr;
+};
+
+/// @brief Awaitable controller input, output and hotplug events for coroutine schedulers
+///
+/// Instead of a polling loop, coroutines await the operations and a single loop calls @see AwaitDispatcher::Pump,
+/// which waits for the platform to signal input and resumes every awaiter that became ready on the calling thread.
+/// Awaiting is allocation free, awaiters are linked through the awaitables living in the coroutine frames.
+///
+/// The dispatcher installs its own connection callbacks for as long as it lives, they still call the ones set before
+/// and those are put back when the dispatcher gets destroyed. Callbacks set while it lives replace the dispatcher's.
+/// Coroutines still suspended when the dispatcher gets destroyed are never resumed.
+class AwaitDispatcher {
+private:
+    struct Waiter {
+        std::coroutine_handle<> handle{};
+        Waiter* next = nullptr;
+        Result result = Result::OK;
+    };
+
+    /// FIFO of suspended awaiters
+    struct WaiterList {
+        Waiter* head = nullptr;
+        Waiter* tail = nullptr;
+
+        [[nodiscard]] bool Empty() const { return head == nullptr; }
+
+        void Push(Waiter* waiter) {
+            waiter->next = nullptr;
+            if (tail) {
+                tail->next = waiter;
+            } else {
+                head = waiter;
+            }
+            tail = waiter;
+        }
+
+        Waiter* Pop() {
+            Waiter* waiter = head;
+            if (waiter) {
+                head = waiter->next;
+                if (!head)
+                    tail = nullptr;
+            }
+            return waiter;
+        }
+
+        /// Moves every waiter the predicate accepts into another list, keeping the order of both
+        template <typename Pred>
+        void MoveIf(WaiterList& to, Pred pred) {
+            WaiterList kept{};
+            while (Waiter* waiter = Pop()) {
+                if (pred(waiter)) {
+                    to.Push(waiter);
+                } else {
+                    kept.Push(waiter);
+                }
+            }
+            *this = kept;
+        }
+    };
+
+public:
+    class InputAwaitable : private Waiter {
+    public:
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            handle = awaiting;
+            std::lock_guard lock(dispatcher->mutex);
+            // a report that is already queued completes the await right away
+            result = dispatcher->manager->PollControllerData(controller, out);
+            if (result != Result::TIMEOUT)
+                return false;
+            dispatcher->inputWaiters.Push(this);
+            return true;
+        }
+        Result await_resume() const noexcept { return result; }
+
+    private:
+        friend class AwaitDispatcher;
+        InputAwaitable(AwaitDispatcher* dispatcher, ControllerHandle controller, ControllerInput* out)
+            : dispatcher(dispatcher), controller(controller), out(out) {}
+
+        AwaitDispatcher* dispatcher;
+        ControllerHandle controller;
+        ControllerInput* out;
+    };
+
+    class SendAwaitable : private Waiter {
+    public:
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            handle = awaiting;
+            result = dispatcher->manager->SetControllerData(controller, data);
+            if (result != Result::OK)
+                return false;
+
+            std::lock_guard lock(dispatcher->mutex);
+            // only output held back by the output scheduler has to be waited for
+            if (!dispatcher->IsOutputQueued(this))
+                return false;
+            dispatcher->sendWaiters.Push(this);
+            return true;
+        }
+        Result await_resume() const noexcept { return result; }
+
+    private:
+        friend class AwaitDispatcher;
+        SendAwaitable(AwaitDispatcher* dispatcher, ControllerHandle controller, const report::OutputReportData& data)
+            : dispatcher(dispatcher), controller(controller), data(data) {}
+
+        AwaitDispatcher* dispatcher;
+        ControllerHandle controller;
+        report::OutputReportData data;
+    };
+
+    class HotplugAwaitable : private Waiter {
+    public:
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            handle = awaiting;
+            std::lock_guard lock(dispatcher->hotplugMutex);
+            if (!dispatcher->hotplugEvents.empty()) {
+                *out = dispatcher->hotplugEvents.front();
+                dispatcher->hotplugEvents.pop_front();
+                return false;
+            }
+            dispatcher->hotplugWaiters.Push(this);
+            return true;
+        }
+        Result await_resume() const noexcept { return result; }
+
+    private:
+        friend class AwaitDispatcher;
+        HotplugAwaitable(AwaitDispatcher* dispatcher, HotplugEvent* out) : dispatcher(dispatcher), out(out) {}
+
+        AwaitDispatcher* dispatcher;
+        HotplugEvent* out;
+    };
+
+public:
+    /// @brief Creates a dispatcher for an initialized manager
+    /// @param manager manager, e.g. @see DaisyManager::Get
+    explicit AwaitDispatcher(DaisyManager* manager)
+        : manager(manager), previousConnected(manager->GetControllerConnected()), previousDisconnected(manager->GetControllerDisconnected()) {
+        manager->OnControllerConnected([this](ControllerHandle controller) {
+            PushHotplugEvent({HotplugEvent::Type::Connected, controller, nullptr});
+            if (previousConnected) {
+                (*previousConnected)(controller);
+            }
+        });
+        manager->OnControllerDisconnected([this](ControllerHandle controller, void* userData) {
+            PushHotplugEvent({HotplugEvent::Type::Disconnected, controller, userData});
+            if (previousDisconnected) {
+                (*previousDisconnected)(controller, userData);
+            }
+        });
+
+        // controllers connected before the dispatcher existed are reported like new ones,
+        // the ones that got connected since the callback was set are already queued by it
+        manager->AvailableControllers(&controllers);
+        std::lock_guard lock(hotplugMutex);
+        for (auto controller : controllers) {
+            if (!IsConnectionQueued(controller)) {
+                hotplugEvents.push_back({HotplugEvent::Type::Connected, controller, nullptr});
+            }
+        }
+    }
+
+    ~AwaitDispatcher() {
+        if (previousConnected) {
+            manager->OnControllerConnected(*previousConnected);
+        } else {
+            manager->ClearControllerConnected();
+        }
+        if (previousDisconnected) {
+            manager->OnControllerDisconnected(*previousDisconnected);
+        } else {
+            manager->ClearControllerDisconnected();
+        }
+    }
+
+    AwaitDispatcher(const AwaitDispatcher&) = delete;
+    AwaitDispatcher& operator=(const AwaitDispatcher&) = delete;
+
+    /// @brief Awaits the next input of a controller
+    /// @param controller controller handle
+    /// @param out input output, must stay valid until the await completes
+    ///
+    /// Completes without suspending if a report is already queued, with CONTROLLER_NOT_FOUND once the controller is gone.
+    /// Several coroutines awaiting the same controller receive successive reports.
+    [[nodiscard]] InputAwaitable NextInput(ControllerHandle controller, ControllerInput* out) { return {this, controller, out}; }
+
+    /// @brief Sends output to a controller, @see DaisyManager::SetControllerData
+    /// @param controller controller handle
+    /// @param data output report data
+    ///
+    /// Completes once the report was written, which for output queued by the output scheduler is when the budget allows.
+    [[nodiscard]] SendAwaitable Send(ControllerHandle controller, const report::OutputReportData& data) { return {this, controller, data}; }
+
+    /// @brief Awaits the next controller connection or disconnection
+    /// @param out event output, must stay valid until the await completes
+    ///
+    /// Controllers that were already connected when the dispatcher got created are reported first.
+    [[nodiscard]] HotplugAwaitable NextHotplugEvent(HotplugEvent* out) { return {this, out}; }
+
+    /// @brief Ticks the manager, waits for input and resumes the awaiters that became ready
+    /// @param timeoutMs how long to wait for any controller to send a report
+    ///
+    /// Every controller gets read, also the ones nobody awaits, their newest input stays available through
+    /// @see DaisyManager::PollControllerData. Awaiters are resumed on the calling thread.
+    /// If the platform fails to wait, this sleeps for the timeout instead, so a pumping loop never spins.
+    void Pump(uint32_t timeoutMs) {
+        manager->Tick();
+        const Result waited = manager->WaitForInput(timeoutMs);
+        if (waited != Result::OK && waited != Result::TIMEOUT) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        }
+        manager->PumpOutput();
+
+        WaiterList ready{};
+        {
+            std::lock_guard lock(hotplugMutex);
+            while (!hotplugWaiters.Empty() && !hotplugEvents.empty()) {
+                auto* waiter = static_cast<HotplugAwaitable*>(hotplugWaiters.Pop());
+                *waiter->out = hotplugEvents.front();
+                hotplugEvents.pop_front();
+                ready.Push(waiter);
+            }
+        }
+        {
+            std::lock_guard lock(mutex);
+            inputWaiters.MoveIf(ready, [this](Waiter* waiter) {
+                auto* input = static_cast<InputAwaitable*>(waiter);
+                input->result = manager->PollControllerData(input->controller, input->out);
+                return input->result != Result::TIMEOUT;
+            });
+            // drained so waiting doesn't return right away for reports nobody awaits
+            manager->AvailableControllers(&controllers);
+            ControllerInput input{};
+            for (auto controller : controllers) {
+                manager->PollControllerData(controller, &input);
+            }
+
+            sendWaiters.MoveIf(ready, [this](Waiter* waiter) { return !IsOutputQueued(static_cast<SendAwaitable*>(waiter)); });
+        }
+
+        // the waiter lives in the coroutine frame, which may be gone once resumed
+        while (Waiter* waiter = ready.Pop()) {
+            waiter->handle.resume();
+        }
+    }
+
+private:
+    void PushHotplugEvent(const HotplugEvent& event) {
+        std::lock_guard lock(hotplugMutex);
+        hotplugEvents.push_back(event);
+    }
+
+    /// Checks whether a connection of the controller is already queued, the hotplug lock must be held
+    bool IsConnectionQueued(ControllerHandle controller) const {
+        return std::any_of(hotplugEvents.begin(), hotplugEvents.end(),
+                           [controller](const HotplugEvent& event) { return event.type == HotplugEvent::Type::Connected && event.controller == controller; });
+    }
+
+    /// Checks whether output of a send awaiter still waits for the output budget, a gone controller completes the send
+    bool IsOutputQueued(SendAwaitable* send) {
+        OutputStats stats{};
+        send->result = manager->GetOutputStats(send->controller, &stats);
+        return send->result == Result::OK && stats.queueDepth != 0;
+    }
+
+private:
+    DaisyManager* manager;
+    /// Connection callbacks set before the dispatcher, called after its own and put back on destruction
+    std::optional<DaisyManager::ControllerConnected> previousConnected;
+    std::optional<DaisyManager::ControllerDisconnected> previousDisconnected;
+    /// Guards the input and send awaiters, held while reading controllers so no report slips past a new awaiter
+    std::mutex mutex;
+    WaiterList inputWaiters{};
+    WaiterList sendWaiters{};
+    /// Guards the hotplug awaiters and events, separate because events get pushed from inside the tick
+    std::mutex hotplugMutex;
+    WaiterList hotplugWaiters{};
+    std::deque<HotplugEvent> hotplugEvents{};
+    /// Scratch for reading every controller, kept to not allocate on every pump
+    std::vector<ControllerHandle> controllers{};
+};
+
+} // namespace ds
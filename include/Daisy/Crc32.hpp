@@ -1,8 +1,49 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 
 namespace ds {
 
-uint32_t Crc32(uint32_t startingValue, uint8_t* data, size_t dataSize, bool finalize);
+/// Crc of the bluetooth output report header (0xa2), used as the starting value for output reports
+constexpr uint32_t BluetoothOutputCrcSeed = 0xeada2d49;
+/// Crc of the bluetooth input report header (0xa1), used as the starting value for input reports
+constexpr uint32_t BluetoothInputCrcSeed = 0x73d37cf3;
+/// Crc of the bluetooth feature report header (0xa3), used as the starting value for feature reports
+constexpr uint32_t BluetoothFeatureCrcSeed = 0x9ddd1ddf;
 
-}
\ No newline at end of file
+/// Crc32 implementations, all of them produce identical results
+enum class Crc32Kernel : uint8_t {
+    /// One byte per iteration through a 256-entry table
+    Table,
+    /// Eight bytes per iteration through eight tables
+    Slice8,
+    /// Sixteen bytes per iteration through sixteen tables
+    Slice16,
+    /// Carry-less multiplication folding (PCLMULQDQ), tails are handled by @see Crc32Kernel::Slice16
+    Clmul,
+};
+
+/// @brief Computes a crc32 using the fastest kernel supported by the cpu
+/// @param startingValue crc to continue from
+/// @param data data to hash
+/// @param dataSize data size
+/// @param finalize whether the result should be inverted
+uint32_t Crc32(uint32_t startingValue, const uint8_t* data, size_t dataSize, bool finalize);
+
+/// @brief Computes a crc32 using a specific kernel
+///
+/// The kernel must be supported by the cpu, @see IsCrc32KernelSupported
+uint32_t Crc32(Crc32Kernel kernel, uint32_t startingValue, const uint8_t* data, size_t dataSize, bool finalize);
+
+/// @brief Checks whether a kernel can run on this cpu
+bool IsCrc32KernelSupported(Crc32Kernel kernel);
+
+/// @brief Gets the kernel picked by the runtime cpu dispatch
+Crc32Kernel ActiveCrc32Kernel();
+
+/// @brief Verifies the crc stored in the last 4 bytes of a bluetooth input report
+/// @param reportData report data, starting with the report id
+/// @param reportSize report size, including the crc
+bool CheckBluetoothInputCrc(const uint8_t* reportData, size_t reportSize);
+
+} // namespace ds
@@ -1,25 +1,178 @@
 #pragma once
+#include <Daisy/Atomic.hpp>
+#include <Daisy/Calibration.hpp>
 #include <Daisy/ControllerInput.hpp>
 #include <Daisy/ControllerOutput.hpp>
 #include <Daisy/Handle.hpp>
+#include <Daisy/HapticStream.hpp>
+#include <Daisy/InputEvents.hpp>
+#include <Daisy/InputReportView.hpp>
+#include <Daisy/LatencyHistogram.hpp>
+#include <Daisy/LinkQuality.hpp>
+#include <Daisy/MotionFusion.hpp>
+#include <Daisy/OutputState.hpp>
+#include <Daisy/Recording.hpp>
 #include <Daisy/Result.hpp>
+#include <Daisy/SpscRing.hpp>
+#include <Daisy/Stats.hpp>
+#include <Daisy/TouchGestures.hpp>
+
+#if defined(DAISY_PLATFORM_VIRTUAL)
+#include <Daisy/virtual/VirtualManager.hpp>
+#elif defined(DAISY_PLATFORM_REPLAY)
+#include <Daisy/replay/ReplayManager.hpp>
+#elif defined(_WIN32)
 #include <Daisy/windows/WindowsManager.hpp>
+#elif defined(__linux__)
+#include <Daisy/linux/LinuxManager.hpp>
+#endif
 
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <vector>
 
 namespace ds {
 
+#if defined(DAISY_PLATFORM_VIRTUAL)
+using PlatformManager = VirtualManager;
+#elif defined(DAISY_PLATFORM_REPLAY)
+using PlatformManager = ReplayManager;
+#elif defined(_WIN32)
 using PlatformManager = WindowsManager;
+#elif defined(__linux__)
+using PlatformManager = LinuxManager;
+#else
+#error "Daisy doesn't support this platform yet"
+#endif
 using ControllerHandle = PlatformManager::ControllerHandle;
 
+/// @brief Decodes every field of a report at once
+/// @param report view of the input report data
+/// @param calibration motion sensor calibration of the controller, @see DaisyManager::GetMotionCalibration
+/// @returns decoded controller input
+ControllerInput FromInputReport(InputReportView report, const MotionCalibration& calibration = NominalMotionCalibration);
+
+/// @brief Decodes the input data of a report
+/// @param report input report data
+/// @param calibration motion sensor calibration of the controller, @see DaisyManager::GetMotionCalibration
+/// @returns decoded controller input
+ControllerInput FromInputReport(const report::InputReportData& report, const MotionCalibration& calibration = NominalMotionCalibration);
+
+/// @brief Calculates the crc of a bluetooth output report and stores it in the report
+/// @param outputReport output report, everything before the crc field must already be filled in
+void CalculateCrc(report::BluetoothOutputReport& outputReport);
+
+/// Settings of a per-controller background reader
+struct BackgroundReaderSettings {
+    /// Number of decoded inputs the reader can buffer before the overflow policy kicks in, rounded up to a power of two
+    uint32_t ringDepth = 16;
+    /// What happens when the ring is full
+    OverflowPolicy overflowPolicy = OverflowPolicy::DropOldest;
+};
+
+/// @brief Caller-owned struct-of-arrays input of several controllers, filled by @see DaisyManager::PollAll
+///
+/// Every array is indexed by controller slot, the slot of a controller is its index in @see DaisyManager::AvailableControllers,
+/// so slots stay the same until the next @see DaisyManager::Tick. Arrays must hold at least `capacity` elements,
+/// fields whose array is null are skipped.
+struct InputBatch {
+    /// Number of slots every array can hold
+    size_t capacity = 0;
+    /// Number of slots filled by the last poll
+    size_t count = 0;
+
+    /// Controller of every slot
+    ControllerHandle* controllers = nullptr;
+    /// Whether a new report arrived during the last poll, otherwise the last known input is filled in
+    uint8_t* updated = nullptr;
+
+    /// Sticks, range 0..=255
+    uint8_t* leftStickX = nullptr;
+    uint8_t* leftStickY = nullptr;
+    uint8_t* rightStickX = nullptr;
+    uint8_t* rightStickY = nullptr;
+    /// Triggers, range 0..=255
+    uint8_t* l2 = nullptr;
+    uint8_t* r2 = nullptr;
+
+    PressedButtons* buttons = nullptr;
+    HatSwitch* hatSwitch = nullptr;
+
+    uint16_t* gyroPitch = nullptr;
+    uint16_t* gyroYaw = nullptr;
+    uint16_t* gyroRoll = nullptr;
+    uint16_t* accelX = nullptr;
+    uint16_t* accelY = nullptr;
+    uint16_t* accelZ = nullptr;
+
+    /// Touch points, a point that isn't touching keeps its last position
+    uint8_t* touch1Active = nullptr;
+    uint16_t* touch1X = nullptr;
+    uint16_t* touch1Y = nullptr;
+    uint8_t* touch2Active = nullptr;
+    uint16_t* touch2X = nullptr;
+    uint16_t* touch2Y = nullptr;
+};
+
+/// Output report counters of a controller
+struct OutputStats {
+    /// Reports written to the device
+    uint64_t sentReports = 0;
+    /// Reports skipped because they wouldn't change the state of the controller
+    uint64_t suppressedReports = 0;
+    /// Reports merged into a newer one while waiting for the output budget
+    uint64_t coalescedReports = 0;
+    /// Outputs waiting for the output budget, at most one because of coalescing
+    uint32_t queueDepth = 0;
+    /// Reports written per second, measured over the last second
+    float sendRateHz = 0.0f;
+};
+
+/// Input timing histograms of a controller, values in microseconds
+struct LatencyStats {
+    /// Time between the arrival of consecutive reports, its spread is the jitter of the report cadence
+    LatencyHistogramSnapshot interArrival;
+    /// Time blocking reads waited for a report
+    LatencyHistogramSnapshot readWait;
+    /// Time reports were held up between being sampled and arriving, beyond the fastest arrival of the last seconds,
+    /// estimated from the sensor timestamps
+    LatencyHistogramSnapshot queueDelay;
+    /// Time inputs waited in the ring of a background reader before being handed out, direct reads hand them out as they arrive
+    LatencyHistogramSnapshot delivery;
+};
+
+/// @brief Output budget of bluetooth controllers
+///
+/// All bluetooth controllers usually share a single radio, flooding it with output starves input reports.
+/// With a budget set, output of bluetooth controllers is queued, coalesced with newer output and sent round-robin
+/// whenever the budget allows. Usb controllers are never throttled.
+struct OutputSchedulerSettings {
+    /// Output bytes per second all bluetooth controllers may send together, 0 disables the limit
+    uint32_t bluetoothBytesPerSecond = 0;
+    /// Reports per second a single bluetooth controller may send, 0 disables the limit
+    uint32_t bluetoothReportRateHz = 0;
+};
+
 /// @brief Controller manager
 ///
 /// The manager should be first initialized by making a call to @see DaisyManager::Initialize
 ///
 /// Then you should periodically call @see DaisyManager::Tick for device connection/disconnection
 /// events to get processed.
+///
+/// All methods can be called from multiple threads, e.g. input read on an input thread while an audio thread sets output.
+/// Every controller has separate input and output locks, so calls for different controllers never wait on each other,
+/// and neither do input and output calls for the same controller; the platforms don't serialize them at the device either
+/// (Windows handles are overlapped). The virtual platform does, behind a single lock, so the contention benchmarks only
+/// cover the locking of the manager. @see DaisyManager::Tick removes disconnected
+/// controllers only once no call is using them anymore, a call with a removed controller returns CONTROLLER_NOT_FOUND.
+/// The connection callbacks run on the ticking thread and may call back into the manager.
+/// The replay platform is meant to be read from a single thread.
 class DaisyManager {
 public:
     using ControllerConnected = std::function<void(ControllerHandle handle)>;
@@ -43,12 +196,36 @@ public:
 public:
     /// @bief Ticks the manager
     ///
-    /// This must be called every so-often for the device disconnect/connect events to take effect
+    /// This must be called every so-often for the device disconnect/connect events to take effect.
+    /// Connecting and disconnecting waits for calls on other threads to finish, which are held off meanwhile.
     void Tick();
 
+    /// @brief Get the underlying platform manager
+    ///
+    /// Mostly useful with the virtual platform, to create controllers and inject reports
+    PlatformManager* GetPlatform() { return &platform; }
+
+    /// @brief Starts recording the raw reports of all controllers
+    /// @param path recording file, replaced if it exists
+    /// @return result code
+    ///
+    /// Every input and output report, along with controller connections and disconnections, is appended with a host timestamp.
+    /// Recordings can be played back with @see ReplayManager.
+    Result StartRecording(const char* path);
+
+    /// @brief Stops recording, flushing the recording file
+    /// @return result code, FILE_IO if a write failed, recording stops at the first failed write
+    Result StopRecording() { return recorder.Close(); }
+
     /// @brief Get available controllers
+    ///
+    /// The vector changes on @see DaisyManager::Tick, other threads should take a copy instead
     [[nodiscard]] const std::vector<ControllerHandle>& AvailableControllers() const;
 
+    /// @brief Copies the available controllers, safe while another thread ticks
+    /// @param out controllers output
+    void AvailableControllers(std::vector<ControllerHandle>* out);
+
     /// @brief Get controller data for a controller at the specified index
     /// @param controller controller handle
     /// @param out input data to be set on successfull fetch
@@ -57,14 +234,220 @@ public:
     /// If the controller doesn't exist, returns default instance of the struct
     Result GetControllerData(ControllerHandle controller, ControllerInput* out);
 
+    /// @brief Reads the newest input of a controller without waiting
+    /// @param controller controller handle
+    /// @param out input output, the last known input if no report arrived
+    /// @return result code, TIMEOUT if no report arrived since the last read
+    Result PollControllerData(ControllerHandle controller, ControllerInput* out);
+
+    /// @brief Waits until any controller has a report queued
+    /// @param timeoutMs maximum time to wait
+    /// @return result code, TIMEOUT if no report arrived in time
+    ///
+    /// Controllers with a background reader are not waited on.
+    Result WaitForInput(uint32_t timeoutMs);
+
+    /// @brief Reads input of all controllers in one pass
+    /// @param batch arrays to fill
+    /// @param timeoutMs how long to wait for any controller to send a report, 0 doesn't wait at all
+    /// @return result code
+    ///
+    /// All controllers are waited on together, after which every queued report gets drained without blocking.
+    /// Ticking and calls for other controllers don't wait for the wait. Controllers beyond the batch capacity are skipped.
+    Result PollAll(InputBatch* batch, uint32_t timeoutMs);
+
+    /// @brief Starts reporting input changes of a controller as events
+    /// @param controller controller handle
+    /// @param subscription changes to report
+    /// @param queueDepth number of events that can be queued before the oldest ones get dropped, rounded up to a power of two
+    /// @return result code
+    ///
+    /// Every received report is compared with the previous one, including the older reports drained by @see DaisyManager::PollAll
+    /// and the ones buffered by a background reader, so short presses between two reads aren't lost.
+    /// Subscribing again replaces the subscription and clears the queue.
+    Result SubscribeInputEvents(ControllerHandle controller, InputEventSubscription subscription, uint32_t queueDepth = 64);
+
+    /// @brief Stops reporting input changes of a controller as events
+    /// @param controller controller handle
+    /// @return result code
+    Result UnsubscribeInputEvents(ControllerHandle controller);
+
+    /// @brief Takes queued input events of a controller, oldest first
+    /// @param controller controller handle
+    /// @param outEvents events output
+    /// @param capacity number of events outEvents can hold
+    /// @param outCount number of events taken
+    /// @return result code
+    Result GetInputEvents(ControllerHandle controller, InputEvent* outEvents, size_t capacity, size_t* outCount);
+
+    /// @brief Starts recognizing touchpad gestures of a controller
+    /// @param controller controller handle
+    /// @param settings gesture thresholds
+    /// @param queueDepth number of gestures that can be queued before the oldest ones get dropped, rounded up to a power of two
+    /// @return result code
+    ///
+    /// Like input events, gestures are recognized from every received report, including the ones drained by
+    /// @see DaisyManager::PollAll and buffered by a background reader. Subscribing again restarts recognition and clears the queue.
+    Result SubscribeTouchGestures(ControllerHandle controller, TouchGestureSettings settings = {}, uint32_t queueDepth = 32);
+
+    /// @brief Stops recognizing touchpad gestures of a controller
+    /// @param controller controller handle
+    /// @return result code
+    Result UnsubscribeTouchGestures(ControllerHandle controller);
+
+    /// @brief Takes queued touchpad gestures of a controller, oldest first
+    /// @param controller controller handle
+    /// @param outEvents gestures output
+    /// @param capacity number of gestures outEvents can hold
+    /// @param outCount number of gestures taken
+    /// @return result code
+    Result GetTouchGestures(ControllerHandle controller, TouchGestureEvent* outEvents, size_t capacity, size_t* outCount);
+
+    /// @brief Starts tracking the orientation of a controller
+    /// @param controller controller handle
+    /// @param settings filter settings
+    /// @return result code
+    ///
+    /// Every received report is fed to the filter, timed by the sensor timestamps, including the older reports drained
+    /// by @see DaisyManager::PollAll and the ones buffered by a background reader. The orientation is returned in
+    /// @see ControllerInput::orientation. Enabling again replaces the settings and restarts from the identity orientation.
+    Result EnableMotionFusion(ControllerHandle controller, MotionFusionSettings settings = {});
+
+    /// @brief Stops tracking the orientation of a controller, inputs go back to the identity orientation
+    /// @param controller controller handle
+    /// @return result code
+    Result DisableMotionFusion(ControllerHandle controller);
+
     /// @brief Set controller data for a controller at the specified index
     /// @param controller controller handle
     /// @param data output report data, can be built with @see ds::OutputBuilder
     /// @return result code
     ///
     /// If the controller doesn't exist or setting the data fails, returns false
+    ///
+    /// Change flags whose fields equal the last sent ones are dropped from the report, and if none remain no report is sent at all,
+    /// @see DaisyManager::SetOutputSuppression
     Result SetControllerData(ControllerHandle controller, const ds::report::OutputReportData& data);
 
+    /// @brief Sets the output budget of bluetooth controllers, unlimited by default
+    /// @param settings budget settings
+    ///
+    /// Queued output is sent by @see DaisyManager::Tick and @see DaisyManager::SetControllerData,
+    /// or explicitly with @see DaisyManager::PumpOutput.
+    void SetOutputSchedulerSettings(OutputSchedulerSettings settings);
+
+    /// @brief Sends queued output as far as the output budget allows
+    void PumpOutput();
+
+    /// @brief Enables or disables dropping redundant output, enabled by default
+    /// @param enabled whether redundant output should be dropped
+    void SetOutputSuppression(bool enabled) { outputSuppression.Store(enabled, std::memory_order_relaxed); }
+
+    /// @brief Forgets the last sent output of a controller, the next @see DaisyManager::SetControllerData is sent as-is
+    /// @param controller controller handle
+    ///
+    /// Useful when the state of the controller was changed behind the manager's back
+    Result ResetOutputState(ControllerHandle controller);
+
+    /// @brief Get output report counters of a controller
+    /// @param controller controller handle
+    /// @param out counters output
+    Result GetOutputStats(ControllerHandle controller, OutputStats* out);
+
+    /// @brief Starts streaming haptic samples to the voice coil actuators of a bluetooth controller
+    /// @param controller controller handle
+    /// @param settings format of the written samples and buffer settings
+    /// @return result code, INVALID_PARAMETER for usb controllers, which play haptics through their usb audio device,
+    /// or for settings whose sample rate is so low that a single written frame resamples into more frames than fit the buffer
+    ///
+    /// A dedicated thread sends a haptics report every @see HapticPacketInterval while samples are buffered, written samples
+    /// are buffered by @see DaisyManager::WriteHapticSamples. Haptics reports aren't limited by the output budget.
+    /// Starting again replaces the stream and discards what was buffered. The stream is stopped automatically on disconnect.
+    Result StartHapticStream(ControllerHandle controller, HapticStreamSettings settings = {});
+
+    /// @brief Stops the haptic stream of a controller, if any
+    /// @param controller controller handle
+    /// @return result code
+    Result StopHapticStream(ControllerHandle controller);
+
+    /// @brief Buffers samples for the haptic stream of a controller
+    /// @param controller controller handle
+    /// @param samples 16 bit PCM samples in the format given to @see DaisyManager::StartHapticStream
+    /// @param frames number of frames, samples of all channels at the same time
+    /// @param outWritten number of frames buffered, fewer than given if the buffer filled up
+    /// @return result code, INVALID_PARAMETER if the controller has no haptic stream
+    ///
+    /// Never waits for the buffer, frames that didn't fit have to be written again later.
+    Result WriteHapticSamples(ControllerHandle controller, const int16_t* samples, size_t frames, size_t* outWritten);
+
+    /// @brief Get the buffer fill level and underruns of the haptic stream of a controller
+    /// @param controller controller handle
+    /// @param out stats output
+    /// @return result code, INVALID_PARAMETER if the controller has no haptic stream
+    Result GetHapticStreamStats(ControllerHandle controller, HapticStreamStats* out);
+
+    /// @brief Get the report counters of a controller
+    /// @param controller controller handle
+    /// @param out counters output
+    /// @return result code
+    ///
+    /// Counting is a relaxed atomic store next to work the manager does anyway. Built with DAISY_STATS off, nothing is
+    /// counted and all counters stay zero.
+    Result GetStats(ControllerHandle controller, ControllerStats* out);
+
+    /// @brief Get the counters of all controllers together and of the controller connections
+    /// @param out counters output
+    void GetGlobalStats(GlobalStats* out);
+
+    /// @brief Get the bluetooth frame loss and corruption of a controller
+    /// @param controller controller handle
+    /// @param out link quality output
+    /// @return result code
+    ///
+    /// Bluetooth input reports with a wrong crc are dropped like reports without input data, the last valid input stays
+    /// in place. Gaps in their sequence numbers count as lost frames. Usb controllers report all zeros.
+    Result GetLinkQuality(ControllerHandle controller, LinkQuality* out);
+
+    /// @brief Get the input timing histograms of a controller
+    /// @param controller controller handle
+    /// @param out histograms output
+    /// @return result code
+    ///
+    /// Every report is timestamped when the read returns it and correlated with its sensor timestamp, whichever way it
+    /// was read. Recording never blocks the reading threads, the histograms keep counting until reset. Built with
+    /// DAISY_STATS off, nothing is recorded.
+    Result GetLatencyStats(ControllerHandle controller, LatencyStats* out);
+
+    /// @brief Clears the input timing histograms of a controller
+    /// @param controller controller handle
+    /// @return result code
+    Result ResetLatencyStats(ControllerHandle controller);
+
+    /// @brief Starts a dedicated reader thread for the controller
+    /// @param controller controller handle
+    /// @param settings ring settings
+    /// @return result code
+    ///
+    /// The thread continuously reads and decodes reports into a lock-free ring, after which
+    /// @see DaisyManager::GetControllerData only pops the newest input without touching the device.
+    /// If the ring is empty the last known input is returned. The reader is stopped automatically on disconnect.
+    Result StartBackgroundReader(ControllerHandle controller, BackgroundReaderSettings settings = {});
+
+    /// @brief Stops the reader thread of the controller, if any
+    /// @param controller controller handle
+    /// @return result code
+    Result StopBackgroundReader(ControllerHandle controller);
+
+    /// @brief Get the motion sensor calibration of a controller
+    /// @param controller controller handle
+    /// @param out calibration output
+    /// @return result code
+    ///
+    /// The factory calibration is read once when the controller connects, controllers whose calibration can't be read
+    /// or is implausible use @see NominalMotionCalibration. It's applied to @see ControllerInput::angularVelocity
+    /// and @see ControllerInput::acceleration of every decoded report.
+    Result GetMotionCalibration(ControllerHandle controller, MotionCalibration* out);
+
     /// @brief Get custom user data for the controller
     /// @param controller controller handle
     /// @param outUserData user data output
@@ -80,6 +463,8 @@ public:
     void OnControllerConnected(ControllerConnected callback) { connectedCallback = callback; }
     /// @brief Clears the callback that gets invoked when a controller gets connected
     void ClearControllerConnected() { connectedCallback = {}; }
+    /// @brief Gets the callback that gets invoked when a controller gets connected, if one is set
+    [[nodiscard]] const std::optional<ControllerConnected>& GetControllerConnected() const { return connectedCallback; }
 
     /// @brief Sets the callback that gets invoked when a controller get disconnected
     /// @param callback callback to call
@@ -89,9 +474,44 @@ public:
     void OnControllerDisconnected(ControllerDisconnected callback) { disconnectedCallback = callback; }
     /// @briefs Clears the callback that gets invoked when a controller gets disconnected
     void ClearControllerDisconnected() { disconnectedCallback = {}; }
+    /// @brief Gets the callback that gets invoked when a controller gets disconnected, if one is set
+    [[nodiscard]] const std::optional<ControllerDisconnected>& GetControllerDisconnected() const { return disconnectedCallback; }
 
 private:
+    /// Reads one report from the controller into a caller buffer of at least @see BluetoothInputReportSize bytes
+    /// @param out view of the input data inside the buffer
+    /// @param tracker counters and timing state of the reading thread, nullptr to not record the read
+    /// @returns UNKNOWN_INPUT_REPORT for reports that don't carry input data or fail the bluetooth crc check
+    Result ReadInputReport(ControllerHandle controller, const report::HidReportProperties& reportProperties, uint8_t* reportData, InputReportView* out,
+                           struct ReadTracker* tracker, bool wait = true);
+    /// Waits for reports in short slices that each take the platform lock, so a pending tick never waits out the whole timeout
+    Result WaitForReports(uint32_t timeoutMs);
+    /// Takes the platform lock for a worker thread without ever blocking on it, the tick holding it might be waiting for the thread to exit
+    /// @returns the lock, which doesn't own the mutex if running got cleared before it could be taken
+    std::shared_lock<std::shared_mutex> TryLockPlatform(const AtomicBool& running);
+    /// Drains the queued reports of a controller without blocking, into its cached input
+    /// @returns whether a new report was received
+    bool DrainInput(ControllerHandle controller, struct ControllerCache* cache);
+    /// Takes the inputs buffered by the background reader of a controller
+    /// @returns whether a new input was received
+    static bool ConsumeBackgroundReader(struct ControllerCache* cache);
+    /// Runs a decoded input through motion fusion and event detection and caches it
+    static void ReceiveInput(struct ControllerCache* cache, ControllerInput input);
+    void BackgroundReaderLoop(ControllerHandle controller, report::HidReportProperties reportProperties, MotionCalibration calibration,
+                              struct ReadTracker tracker, struct BackgroundReader* reader);
+
+    /// Sends output right away, dropping whatever wouldn't change the controller state
+    Result TransmitOutput(ControllerHandle controller, const report::HidReportProperties& reportProperties, struct ControllerCache* cache,
+                          const report::OutputReportData& controllerData);
+    [[nodiscard]] bool IsOutputScheduled(const report::HidReportProperties& reportProperties) const;
+    /// @see DaisyManager::PumpOutput, for callers already holding the platform lock
+    void PumpPendingOutput();
+
+    void HapticStreamLoop(ControllerHandle controller, struct ControllerCache* cache, struct HapticStreamer* streamer);
+
     void SendInitialReport(ControllerHandle controller);
+    /// Reads the factory calibration into a new controller record, leaving the nominal one if that fails
+    void ReadCalibration(ControllerHandle controller, struct ControllerCache* cache);
 
     void OnControllerConnected(ControllerHandle controller);
     void OnControllerDisconnected(ControllerHandle controller);
@@ -101,6 +521,23 @@ private:
 
 private:
     PlatformManager platform;
+    /// Held exclusively while ticking the platform, every call using a controller holds it shared
+    std::shared_mutex platformMutex;
+    AtomicBool tickPending = false;
+    ReportRecorder recorder;
+    AtomicBool outputSuppression = true;
+    /// Whether the scheduler settings limit anything, readable without the scheduler lock
+    AtomicBool outputScheduled = false;
+    /// Guards the scheduler state below, taken before any controller output lock
+    std::mutex outputSchedulerMutex;
+    OutputSchedulerSettings outputSchedulerSettings{};
+    /// Output bytes the bluetooth controllers may still send, refilled over time
+    double outputBudgetBytes = 0.0;
+    std::chrono::steady_clock::time_point outputBudgetRefill{};
+    /// Connected controller index the next round-robin pass starts at
+    size_t outputCursor = 0;
+    /// Connection counts and the counters of the controllers that disconnected, only changed while ticking
+    GlobalStats globalStats{};
     std::optional<ControllerConnected> connectedCallback;
     std::optional<ControllerDisconnected> disconnectedCallback;
 };
@@ -0,0 +1,185 @@
+#pragma once
+#include <Daisy/Assert.hpp>
+#include <Daisy/Handle.hpp>
+#include <Daisy/Report.hpp>
+#include <Daisy/Result.hpp>
+#include <Daisy/Vec.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ds {
+
+/// Single byte tracks of a feedback effect
+enum class FeedbackTrack : uint8_t {
+    LeftMotor,
+    RightMotor,
+    LightbarRed,
+    LightbarGreen,
+    LightbarBlue,
+    /// @see report::PlayerLedFlags, never interpolated
+    PlayerLeds,
+};
+constexpr size_t FeedbackTrackCount = 6;
+
+enum class TriggerSide : uint8_t { Left, Right };
+
+/// How a track gets from a keyframe to the next one
+enum class Interpolation : uint8_t {
+    /// Holds the value until the next keyframe
+    Step,
+    Linear,
+    /// Eases in and out (smoothstep)
+    Smooth,
+};
+
+struct FeedbackKeyframe {
+    uint32_t timeMs;
+    uint8_t value;
+    /// Interpolation towards the next keyframe
+    Interpolation interpolation;
+};
+
+struct TriggerKeyframe {
+    uint32_t timeMs;
+    report::TriggerData data;
+};
+
+/// @brief Keyframed motor, lightbar, player led and trigger tracks played together
+///
+/// A track drives its part of the output from its first keyframe on and holds its last keyframe until the effect ends.
+/// Trigger effects switch at their keyframes. The effect lasts until its latest keyframe, looping effects start over then.
+class FeedbackEffect {
+public:
+    /// @brief Adds a keyframe to a track, keyframes can be added in any order
+    FeedbackEffect& AddKeyframe(FeedbackTrack track, uint32_t timeMs, uint8_t value, Interpolation interpolation = Interpolation::Linear);
+    /// @brief Adds a keyframe to all three lightbar tracks
+    FeedbackEffect& AddLightbarKeyframe(uint32_t timeMs, Color<uint8_t> color, Interpolation interpolation = Interpolation::Linear);
+    /// @brief Adds a trigger effect switched to at the given time, @see AdaptiveTriggerBuilder
+    FeedbackEffect& AddTriggerKeyframe(TriggerSide side, uint32_t timeMs, report::TriggerData data);
+    /// @brief Makes the effect start over after its latest keyframe instead of ending
+    FeedbackEffect& SetLooping(bool looping);
+
+    [[nodiscard]] uint32_t DurationMs() const { return durationMs; }
+    [[nodiscard]] bool IsLooping() const { return looping; }
+
+private:
+    friend class FeedbackTimeline;
+
+    std::array<std::vector<FeedbackKeyframe>, FeedbackTrackCount> tracks;
+    std::array<std::vector<TriggerKeyframe>, 2> triggers;
+    uint32_t durationMs = 0;
+    bool looping = false;
+};
+
+using FeedbackEffectId = uint32_t;
+
+/// Playback state of an effect instance, @see FeedbackTimeline::Play
+struct FeedbackInstance {
+    FeedbackEffectId effect;
+    uint32_t controllerSlot;
+    uint8_t priority;
+    /// Instances started later win ties of priority
+    uint64_t serial;
+    /// Effect time of the next tick, us
+    uint64_t timeUs;
+    /// Keyframe every track is at, so evaluating a tick never searches
+    std::array<uint32_t, FeedbackTrackCount> trackCursors;
+    std::array<uint32_t, 2> triggerCursors;
+};
+
+using FeedbackInstanceHandle = Handle<FeedbackInstance>;
+
+struct FeedbackTimelineSettings {
+    /// Ticks per second, every tick evaluates all instances once; clamped to 1 - 1000000
+    uint32_t rateHz = 250;
+    /// Number of controller slots, instances play on a slot below this
+    uint32_t controllerSlots = 8;
+    /// Number of instances that can play at once, all storage is allocated up front
+    uint32_t instanceCapacity = 256;
+};
+
+/// @brief Plays keyframed feedback effects at a fixed rate and produces the output of every controller
+///
+/// Effects are registered once, any number of instances of them can play on every controller slot, e.g.
+/// @see ControllerHandle::Index. Every tick evaluates all instances in one pass over densely stored state without allocating.
+///
+/// Instances on the same controller are combined per track: motors take the strongest instance, every other track the
+/// instance with the highest priority, ties going to the latest started one. Once no instance drives the motors or a trigger
+/// anymore, they're reset to off; the lightbar and player leds keep their last color.
+///
+/// The output of a controller only has the change flags of the tracks driven or reset in the latest tick, so it can be
+/// sent with @see DaisyManager::SetControllerData after every tick, unchanged parts are suppressed there.
+/// A timeline is meant to be used from one thread.
+class FeedbackTimeline {
+public:
+    explicit FeedbackTimeline(FeedbackTimelineSettings settings = {});
+
+    /// @brief Registers an effect, effects can't be removed again
+    /// @returns id to play the effect with
+    FeedbackEffectId AddEffect(const FeedbackEffect& effect);
+
+    /// @brief Starts playing an effect on a controller slot, from its beginning at the next tick
+    /// @param effect effect id
+    /// @param controllerSlot controller slot
+    /// @param priority tracks of higher priority instances override lower ones
+    /// @param out handle of the instance, optional
+    /// @return result code, INVALID_PARAMETER for an unknown effect or slot, or if the instance capacity is used up
+    Result Play(FeedbackEffectId effect, uint32_t controllerSlot, uint8_t priority = 0, FeedbackInstanceHandle* out = nullptr);
+
+    /// @brief Stops an instance, the tracks it drove are released at the next tick
+    void Stop(FeedbackInstanceHandle instance);
+    /// @brief Stops every instance on a controller slot
+    void StopAll(uint32_t controllerSlot);
+    /// @brief Checks whether an instance is still playing, instances of effects that don't loop stop at their end
+    [[nodiscard]] bool IsPlaying(FeedbackInstanceHandle instance) const { return instances.Contains(instance); }
+    [[nodiscard]] size_t InstanceCount() const { return instances.Size(); }
+
+    /// @brief Runs the ticks due after some time passed
+    /// @param elapsed time since the last call
+    /// @returns number of ticks run, if more are behind than a tenth of a second they are skipped
+    uint32_t Advance(std::chrono::microseconds elapsed);
+
+    /// @brief Evaluates every instance once and advances them by one tick
+    void Tick();
+
+    /// @brief Get the output a controller slot got in the latest tick
+    /// @param controllerSlot controller slot, below @see FeedbackTimelineSettings::controllerSlots
+    [[nodiscard]] const report::OutputReportData& Output(uint32_t controllerSlot) const {
+        DS_ASSERT(controllerSlot < outputs.size(), "Invalid controller slot");
+        return outputs[controllerSlot];
+    }
+
+private:
+    /// Tracks of a controller slot being combined during a tick
+    struct SlotMix {
+        std::array<uint8_t, FeedbackTrackCount> values;
+        /// Priority and serial of the instance currently driving every track, 0 if none does
+        std::array<uint64_t, FeedbackTrackCount> owners;
+        std::array<report::TriggerData, 2> triggers;
+        std::array<uint64_t, 2> triggerOwners;
+        /// Whether the motors and triggers were driven in the previous tick, to release them once
+        bool motorsDriven;
+        std::array<bool, 2> triggersDriven;
+    };
+
+    void Evaluate(FeedbackInstance& instance, SlotMix& mix) const;
+    void BuildOutput(SlotMix& mix, report::OutputReportData& output) const;
+
+private:
+    FeedbackTimelineSettings settings;
+    uint64_t tickUs;
+    uint64_t pendingUs = 0;
+    uint64_t nextSerial = 0;
+    std::vector<FeedbackEffect> effects;
+    SlotMap<FeedbackInstance> instances;
+    /// Instances that ended in the current tick, removed after it
+    std::vector<FeedbackInstanceHandle> ended;
+    std::vector<SlotMix> mixes;
+    std::vector<report::OutputReportData> outputs;
+};
+
+} // namespace ds
@@ -1,73 +1,77 @@
 #pragma once
 #include <Daisy/Assert.hpp>
 
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+/// @brief Reference to an element of a @see SlotMap
+///
+/// Besides the slot index the handle carries the generation of the slot, which changes whenever the element in it gets removed,
+/// so a handle to a removed element never refers to an element that later reuses the slot.
 template <typename Obj>
 class Handle {
 public:
     static constexpr int32_t InvalidIndex = -1;
 
 public:
-    Handle() : index(InvalidIndex) {}
-    Handle(int32_t index) : index(index) {}
+    Handle() : index(InvalidIndex), generation(0) {}
+    explicit Handle(int32_t index, uint32_t generation = 0) : index(index), generation(generation) {}
 
-    bool operator==(const Handle& other) const { return index == other.index; }
+    bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
     bool operator!=(const Handle& other) const { return !(*this == other); }
 
     [[nodiscard]] bool IsValid() const { return index != InvalidIndex; }
     [[nodiscard]] int32_t Index() const { return index; }
+    [[nodiscard]] uint32_t Generation() const { return generation; }
+
+    /// @brief Packs the handle into 64 bits, e.g. to pass it through os user data
+    [[nodiscard]] uint64_t ToBits() const { return static_cast<uint64_t>(generation) << 32 | static_cast<uint32_t>(index); }
+    /// @brief Unpacks a handle packed by @see Handle::ToBits
+    static Handle FromBits(uint64_t bits) { return Handle(static_cast<int32_t>(bits & UINT32_MAX), static_cast<uint32_t>(bits >> 32)); }
 
 private:
     int32_t index;
+    uint32_t generation;
 };
 
+/// @brief Generational slot map
+///
+/// Elements are stored densely, so iterating only touches live elements, and every slot remembers where its element is.
+/// Add, remove and lookup are O(1). Removing moves the last element into the freed position, so element addresses
+/// and the iteration order are not stable across removals.
 template <typename T>
-class HandleVec {
+class SlotMap {
 private:
-    struct VecSlot {
-        T data = {};
-        bool isFree = true;
+    static constexpr uint32_t FreeSlot = UINT32_MAX;
+
+    struct Slot {
+        /// Position of the element in the dense storage, @see FreeSlot if the slot is unused
+        uint32_t denseIndex = FreeSlot;
+        uint32_t generation = 0;
     };
 
 public:
     template <bool Const = false>
     struct Iterator {
-        using iterator_category = std::bidirectional_iterator_tag;
+        using iterator_category = std::forward_iterator_tag;
         using difference_type = std::ptrdiff_t;
         using value_type = T;
         using pointer = std::conditional_t<Const, std::pair<Handle<T>, T const*>, std::pair<Handle<T>, T*>>;
         using reference = std::conditional_t<Const, std::pair<Handle<T>, T const&>, std::pair<Handle<T>, T&>>;
-        using data_ptr = std::conditional_t<Const, std::vector<VecSlot> const*, std::vector<VecSlot>*>;
+        using map_ptr = std::conditional_t<Const, SlotMap const*, SlotMap*>;
 
         Iterator() = default;
-        explicit Iterator(std::vector<VecSlot>* data) : data(data) {}
+        Iterator(map_ptr map, size_t index) : map(map), index(index) {}
 
-        reference operator*() const { return {Handle<T>(index), data->at(index).data}; }
-        pointer operator->() const { return {Handle<T>(index), &data->at(index)->data}; }
+        reference operator*() const { return {map->denseHandles[index], map->dense[index]}; }
+        pointer operator->() const { return {map->denseHandles[index], &map->dense[index]}; }
 
         Iterator& operator++() {
             index++;
-
-            int32_t foundIndex = 0;
-            bool found = false;
-            const int32_t dataSize = static_cast<int32_t>(data->size());
-            for (int32_t i = index; i < dataSize; i++) {
-                if (data->at(i).isFree)
-                    continue;
-
-                foundIndex = i;
-                found = true;
-            }
-
-            if (!found) { // convert into end sentinel
-                data = nullptr;
-                index = 0;
-            }
-
-            index = foundIndex;
             return *this;
         }
 
@@ -77,83 +81,105 @@ public:
             return tmp;
         }
 
-        constexpr bool operator==(const Iterator& other) const { return data == other.data && index == other.index; }
+        constexpr bool operator==(const Iterator& other) const { return map == other.map && index == other.index; }
         constexpr bool operator!=(const Iterator& other) const { return !(*this == other); }
 
     private:
-        data_ptr data = nullptr;
-        int32_t index = 0;
+        map_ptr map = nullptr;
+        size_t index = 0;
     };
 
 public:
-    HandleVec() = default;
+    SlotMap() = default;
 
     Handle<T> Add(T&& element) {
-        if (!freeHandles.empty()) {
-            Handle<T> handle = freeHandles.back();
-            freeHandles.pop_back();
-
-            list[handle.Index()] = {std::move(element), false};
-            return handle;
+        uint32_t slotIndex = 0;
+        if (!freeSlots.empty()) {
+            slotIndex = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slotIndex = static_cast<uint32_t>(slots.size());
+            slots.push_back({});
         }
 
-        Handle<T> handle(static_cast<int32_t>(list.size()));
-        list.push_back({std::move(element), false});
+        Slot& slot = slots[slotIndex];
+        slot.denseIndex = static_cast<uint32_t>(dense.size());
+        const Handle<T> handle(static_cast<int32_t>(slotIndex), slot.generation);
+        dense.push_back(std::move(element));
+        denseHandles.push_back(handle);
         return handle;
     }
 
     T Remove(Handle<T> handle) {
-        DS_ASSERT(static_cast<int32_t>(list.size()) > handle.Index(), "Invalid handle");
-        freeHandles.push_back(handle);
+        DS_ASSERT(Contains(handle), "Invalid handle");
+        Slot& slot = slots[handle.Index()];
+        const uint32_t denseIndex = slot.denseIndex;
+
+        T value = std::move(dense[denseIndex]);
+        if (denseIndex != dense.size() - 1) {
+            dense[denseIndex] = std::move(dense.back());
+            denseHandles[denseIndex] = denseHandles.back();
+            slots[denseHandles[denseIndex].Index()].denseIndex = denseIndex;
+        }
+        dense.pop_back();
+        denseHandles.pop_back();
 
-        T value = std::move(list[handle.Index()].data);
-        list[handle.Index()] = std::move(VecSlot{});
+        slot.denseIndex = FreeSlot;
+        slot.generation++;
+        freeSlots.push_back(static_cast<uint32_t>(handle.Index()));
         return value;
     }
 
-    [[nodiscard]] bool Contains(Handle<T> handle) {
-        if (handle.Index() >= static_cast<int32_t>(list.size()))
+    [[nodiscard]] bool Contains(Handle<T> handle) const {
+        if (handle.Index() < 0 || handle.Index() >= static_cast<int32_t>(slots.size()))
             return false;
-        return !list[handle.Index()].isFree;
+        const Slot& slot = slots[handle.Index()];
+        return slot.denseIndex != FreeSlot && slot.generation == handle.Generation();
+    }
+    /// Number of live elements
+    [[nodiscard]] size_t Size() const { return dense.size(); }
+
+    /// @brief Allocates storage up front, adding and removing up to that many elements doesn't allocate afterwards
+    void Reserve(size_t capacity) {
+        slots.reserve(capacity);
+        freeSlots.reserve(capacity);
+        dense.reserve(capacity);
+        denseHandles.reserve(capacity);
     }
-    [[nodiscard]] size_t Size() const { return list.size(); }
 
     void Clear() {
-        freeHandles.clear();
-        freeHandles.resize(list.size());
-        for (size_t i = 0; i < list.size(); i++) {
-            freeHandles[i] = i;
-            list[i] = std::move(VecSlot{});
+        for (const auto& handle : denseHandles) {
+            Slot& slot = slots[handle.Index()];
+            slot.denseIndex = FreeSlot;
+            slot.generation++;
+            freeSlots.push_back(static_cast<uint32_t>(handle.Index()));
         }
+        dense.clear();
+        denseHandles.clear();
     }
 
     [[nodiscard]] T& Get(Handle<T> handle) {
-        DS_ASSERT(static_cast<int32_t>(list.size()) > handle.Index(), "Invalid handle");
-        return list[handle.Index()].data;
+        DS_ASSERT(Contains(handle), "Invalid handle");
+        return dense[slots[handle.Index()].denseIndex];
     }
     [[nodiscard]] const T& Get(Handle<T> handle) const {
-        DS_ASSERT(static_cast<int32_t>(list.size()) > handle.Index(), "Invalid handle");
-        return list[handle.Index()].data;
+        DS_ASSERT(Contains(handle), "Invalid handle");
+        return dense[slots[handle.Index()].denseIndex];
     }
 
     T& operator[](Handle<T> handle) { return this->Get(handle); }
     const T& operator[](Handle<T> handle) const { return this->Get(handle); }
 
-    Iterator<true> begin() const {
-        if (list.empty())
-            return Iterator{};
-        return Iterator(&list);
-    }
-    Iterator<true> end() const { return Iterator{}; }
+    Iterator<true> begin() const { return Iterator<true>(this, 0); }
+    Iterator<true> end() const { return Iterator<true>(this, dense.size()); }
 
-    Iterator<false> begin() {
-        if (list.empty())
-            return Iterator{};
-        return Iterator(&list);
-    }
-    Iterator<false> end() { return Iterator{}; }
+    Iterator<false> begin() { return Iterator<false>(this, 0); }
+    Iterator<false> end() { return Iterator<false>(this, dense.size()); }
 
 private:
-    std::vector<VecSlot> list;
-    std::vector<Handle<T>> freeHandles;
-};
\ No newline at end of file
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::vector<T> dense;
+    /// Handle of every element in the dense storage, in the same order
+    std::vector<Handle<T>> denseHandles;
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include <Daisy/Report.hpp>
+#include <Daisy/SpscRing.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace ds {
+
+/// Sample rate the voice coil actuators play at over bluetooth
+constexpr uint32_t HapticSampleRate = 3000;
+/// Stereo frames carried by one haptics report
+constexpr uint32_t HapticPacketFrames = 32;
+/// Time one haptics report plays for, the cadence they have to be sent at
+constexpr std::chrono::microseconds HapticPacketInterval(1000000 * HapticPacketFrames / HapticSampleRate);
+
+/// One stereo frame at @see HapticSampleRate
+struct HapticFrame {
+    int8_t left;
+    int8_t right;
+};
+
+struct HapticStreamSettings {
+    /// Sample rate of the written samples, resampled to @see HapticSampleRate
+    uint32_t sampleRate = 48000;
+    /// Channels of the written samples, 1 or 2, mono is played on both actuators
+    uint32_t channels = 2;
+    /// Resampled frames the stream can buffer, rounded up to a power of two; 1024 frames are about a third of a second
+    uint32_t bufferFrames = 1024;
+    /// Resampled frames buffered before playback starts or resumes after running dry
+    uint32_t prebufferFrames = 2 * HapticPacketFrames;
+};
+
+/// Buffer fill level and underruns of a haptic stream
+struct HapticStreamStats {
+    /// Resampled frames waiting to be sent
+    uint32_t bufferedFrames = 0;
+    uint32_t capacityFrames = 0;
+    /// bufferedFrames / capacityFrames
+    float fillLevel = 0.0f;
+    /// Reports that ran out of samples before they were full, including the last one of every playback
+    uint64_t underruns = 0;
+    /// Frames of silence inserted into those reports
+    uint64_t silentFrames = 0;
+    /// Reports taken for sending
+    uint64_t packets = 0;
+};
+
+/// @brief Resamples PCM samples and packetizes them into bluetooth haptics reports
+///
+/// Written samples are resampled right away (averaging when downsampling, linear interpolation when upsampling) into a
+/// lock-free ring, the reports are cut from the ring at their fixed cadence. One thread may write while another one
+/// takes reports, neither ever waits for the other.
+///
+/// A report that can't be filled completely is padded with silence and counts as an underrun, after which playback
+/// pauses until the prebuffer is filled again.
+class HapticStream {
+public:
+    /// @param settings stream settings, with a sample rate above zero and 1 or 2 channels
+    explicit HapticStream(const HapticStreamSettings& settings);
+
+    /// @brief Resamples and buffers samples, must only be called from one thread at a time
+    /// @param samples 16 bit PCM samples, interleaved if there are two channels
+    /// @param frames number of frames, samples of all channels at the same time
+    /// @returns number of frames taken, fewer than given if the buffer filled up
+    size_t Write(const int16_t* samples, size_t frames);
+
+    /// @brief Takes the next report, must only be called from one thread at a time
+    /// @param out report output, the whole report including the crc is written
+    /// @returns false if playback is paused and there's nothing to send
+    bool NextPacket(report::BluetoothHapticsReport* out);
+
+    /// @brief Copies the fill level and counters, from any thread
+    /// @param out stats output
+    void Stats(HapticStreamStats* out) const;
+
+private:
+    /// Feeds one frame to the resampler, which emits zero or more resampled frames
+    void Resample(int32_t left, int32_t right);
+
+private:
+    HapticStreamSettings settings;
+    SpscRing<HapticFrame> ring;
+    /// Resampled frames a single written frame can emit at most
+    uint32_t maxFramesPerWrite = 1;
+
+    /// Writer side resampler state, its clock counts in units of 1 / (sampleRate * @see HapticSampleRate) seconds
+    uint32_t phase = 0;
+    int32_t sumLeft = 0;
+    int32_t sumRight = 0;
+    uint32_t summed = 0;
+    int32_t previousLeft = 0;
+    int32_t previousRight = 0;
+
+    /// Reader side state
+    bool playing = false;
+    uint8_t sequence = 0;
+    std::atomic<uint64_t> underruns{0};
+    std::atomic<uint64_t> silentFrames{0};
+    std::atomic<uint64_t> packets{0};
+};
+
+} // namespace ds
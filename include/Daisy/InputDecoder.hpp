@@ -0,0 +1,73 @@
+#pragma once
+#include <Daisy/ControllerInput.hpp>
+#include <Daisy/Report.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ds {
+
+/// @brief Caller-owned columnar output of @see DecodeInputReports
+///
+/// Every array must hold at least as many elements as reports are decoded, columns whose array is null are skipped.
+/// Values are identical to the matching fields of @see FromInputReport.
+struct InputColumns {
+    /// Sticks, range 0..=255
+    uint8_t* leftStickX = nullptr;
+    uint8_t* leftStickY = nullptr;
+    uint8_t* rightStickX = nullptr;
+    uint8_t* rightStickY = nullptr;
+    /// Triggers, range 0..=255
+    uint8_t* l2 = nullptr;
+    uint8_t* r2 = nullptr;
+
+    PressedButtons* buttons = nullptr;
+    HatSwitch* hatSwitch = nullptr;
+
+    uint16_t* gyroPitch = nullptr;
+    uint16_t* gyroYaw = nullptr;
+    uint16_t* gyroRoll = nullptr;
+    uint16_t* accelX = nullptr;
+    uint16_t* accelY = nullptr;
+    uint16_t* accelZ = nullptr;
+    uint32_t* sensorTimestamp = nullptr;
+
+    /// Touch points, 1 while touching
+    uint8_t* touch1Active = nullptr;
+    uint8_t* touch1Id = nullptr;
+    uint16_t* touch1X = nullptr;
+    uint16_t* touch1Y = nullptr;
+    uint8_t* touch2Active = nullptr;
+    uint8_t* touch2Id = nullptr;
+    uint16_t* touch2X = nullptr;
+    uint16_t* touch2Y = nullptr;
+};
+
+/// Input report batch decoders, all of them produce identical results
+enum class InputDecodeKernel : uint8_t {
+    /// One report at a time through @see InputReportView
+    Scalar,
+    /// Eight reports per iteration, fields are loaded per report and decoded with 128-bit vectors
+    Sse41,
+    /// Sixteen reports per iteration, fields are gathered and decoded with 256-bit vectors
+    Avx2,
+};
+
+/// @brief Decodes contiguous input reports into columns using the fastest kernel supported by the cpu
+/// @param reports input report data, e.g. taken from a recording
+/// @param reportCount number of reports
+/// @param out output columns
+void DecodeInputReports(const report::InputReportData* reports, size_t reportCount, const InputColumns& out);
+
+/// @brief Decodes contiguous input reports into columns using a specific kernel
+///
+/// The kernel must be supported by the cpu, @see IsInputDecodeKernelSupported
+void DecodeInputReports(InputDecodeKernel kernel, const report::InputReportData* reports, size_t reportCount, const InputColumns& out);
+
+/// @brief Checks whether a kernel can run on this cpu
+bool IsInputDecodeKernelSupported(InputDecodeKernel kernel);
+
+/// @brief Gets the kernel picked by the runtime cpu dispatch
+InputDecodeKernel ActiveInputDecodeKernel();
+
+} // namespace ds
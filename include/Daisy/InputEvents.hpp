@@ -0,0 +1,86 @@
+#pragma once
+#include <Daisy/ControllerInput.hpp>
+#include <Daisy/SpscRing.hpp>
+
+#include <cstdint>
+
+namespace ds {
+
+/// Analog axes that can report threshold crossings
+enum class InputAxis : uint8_t { LeftStickX, LeftStickY, RightStickX, RightStickY, L2, R2 };
+
+/// Bitflags of @see InputAxis values
+enum class InputAxes : uint8_t {
+    None = 0,
+    LeftStickX = 1 << 0,
+    LeftStickY = 1 << 1,
+    RightStickX = 1 << 2,
+    RightStickY = 1 << 3,
+    L2 = 1 << 4,
+    R2 = 1 << 5,
+};
+DS_BITFLAGS(InputAxes, uint8_t);
+
+enum class InputEventType : uint8_t {
+    ButtonPressed,
+    ButtonReleased,
+    HatPressed,
+    HatReleased,
+    /// Axis rose to or above the press threshold, for stick axes their deflection from the center
+    AxisPressed,
+    /// Axis fell below the release threshold
+    AxisReleased,
+};
+
+/// A single input change
+struct InputEvent {
+    /// Device timestamp of the report the change was seen in, @see ControllerInput::sensorTimestamp
+    uint32_t sensorTimestamp;
+    InputEventType type;
+    /// Changed button, for button events
+    PressedButtons button;
+    /// Changed hat direction, for hat events
+    HatSwitch hatSwitch;
+    /// Changed axis and its new raw value, for axis events. The value tells which way a stick got pushed
+    InputAxis axis;
+    uint8_t axisValue;
+};
+
+/// Changes that should be reported as events, everything else is ignored without any cost
+struct InputEventSubscription {
+    PressedButtons buttons = static_cast<PressedButtons>(0);
+    HatSwitch hatSwitch = HatSwitch::None;
+    InputAxes axes = InputAxes::None;
+    /// An axis is pressed once it reaches this value. Triggers compare their value, stick axes their deflection towards
+    /// either side, @see StickDeflection
+    uint8_t axisPressThreshold = 192;
+    /// A pressed axis is released once it falls below this value, should be lower than the press threshold to avoid chatter
+    uint8_t axisReleaseThreshold = 160;
+};
+
+/// @brief Distance of a stick axis value from its resting center, scaled to 0-255
+uint8_t StickDeflection(uint8_t value);
+
+/// @brief Turns consecutive inputs into edge events
+///
+/// The first input only establishes the starting state, anything already held at that point isn't reported.
+class InputEventDetector {
+public:
+    explicit InputEventDetector(InputEventSubscription subscription) : subscription(subscription) {}
+
+    /// @brief Compares an input with the previous one and pushes the subscribed changes in a fixed order:
+    /// buttons, hat switch, axes
+    /// @param input next input
+    /// @param events queue to push into
+    void Process(const ControllerInput& input, SpscRing<InputEvent>& events);
+
+private:
+    InputEventSubscription subscription;
+    PressedButtons previousButtons = static_cast<PressedButtons>(0);
+    HatSwitch previousHatSwitch = HatSwitch::None;
+    /// Axes currently pressed
+    InputAxes pressedAxes = InputAxes::None;
+    bool hasPrevious = false;
+};
+
+} // namespace ds
@@ -0,0 +1,123 @@
+#pragma once
+#include <Daisy/ControllerInput.hpp>
+#include <Daisy/Report.hpp>
+#include <Daisy/Result.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ds {
+
+constexpr uint16_t USBInputReportSize = 64;
+constexpr uint16_t BluetoothInputReportSize = 78;
+
+/// @brief Non-owning view of the input data inside a raw input report
+///
+/// Nothing is decoded up front, every accessor reads its field straight from the report bytes when called.
+/// Loads are done bytewise, so the data doesn't have to be aligned and the result doesn't depend on the host byte order.
+/// The view is only valid as long as the report buffer it points into.
+class InputReportView {
+public:
+    /// @brief Creates a view over input data laid out like @see report::InputReportData
+    /// @param inputData start of the input data, after the report framing
+    explicit InputReportView(const uint8_t* inputData) : data(inputData) {}
+    /// @brief Creates a view over decoded report data
+    explicit InputReportView(const report::InputReportData& inputData) : data(reinterpret_cast<const uint8_t*>(&inputData)) {}
+
+    /// @brief Creates a view over a raw report as read from the device
+    /// @param reportData raw report, starting with the report id
+    /// @param reportLength input report length of the controller, decides whether the report is framed for usb or bluetooth
+    /// @param out view output
+    /// @returns UNKNOWN_INPUT_REPORT for reports that don't carry input data
+    static Result FromRawReport(const uint8_t* reportData, uint16_t reportLength, InputReportView* out) {
+        // for some reason you can get either id on bluetooth, report size still applies :/
+        if (reportData[0] != 1 && reportData[0] != 49)
+            return Result::UNKNOWN_INPUT_REPORT;
+
+        if (reportLength == USBInputReportSize)
+            *out = InputReportView(reportData + offsetof(report::HIDReport<uint8_t>, data));
+        else if (reportLength == BluetoothInputReportSize)
+            *out = InputReportView(reportData + offsetof(report::BluetoothInputReport, data));
+        else
+            return Result::UNKNOWN_INPUT_REPORT;
+
+        return Result::OK;
+    }
+
+    /// Start of the viewed input data
+    [[nodiscard]] const uint8_t* Data() const { return data; }
+
+    [[nodiscard]] Vec2<uint8_t> LeftStick() const { return {Load8(offsetof(report::InputReportData, x)), Load8(offsetof(report::InputReportData, y))}; }
+    [[nodiscard]] Vec2<uint8_t> RightStick() const { return {Load8(offsetof(report::InputReportData, z)), Load8(offsetof(report::InputReportData, rz))}; }
+    [[nodiscard]] uint8_t L2() const { return Load8(offsetof(report::InputReportData, rx)); }
+    [[nodiscard]] uint8_t R2() const { return Load8(offsetof(report::InputReportData, ry)); }
+
+    [[nodiscard]] PressedButtons Buttons() const {
+        const uint8_t buttons0 = Load8(offsetof(report::InputReportData, buttons) + offsetof(report::Buttons, buttons0));
+        const uint8_t buttons1 = Load8(offsetof(report::InputReportData, buttons) + offsetof(report::Buttons, buttons1));
+        const uint8_t buttons2 = Load8(offsetof(report::InputReportData, buttons) + offsetof(report::Buttons, buttons2));
+
+        const auto actions = static_cast<PressedButtons>(buttons0 >> 4 & 0xf);
+        const auto triggers = static_cast<PressedButtons>((buttons1 & 0xf) << 4);
+        const auto front = static_cast<PressedButtons>(static_cast<uint16_t>(buttons1 & 0xf0) << 4);
+        const auto system = static_cast<PressedButtons>(static_cast<uint16_t>(buttons2 & 0x7) << 12);
+        return actions | triggers | front | system;
+    }
+
+    [[nodiscard]] HatSwitch GetHatSwitch() const {
+        // up, up-right, right, right-down, down, down-left, left, left-up, anything above means released
+        constexpr uint8_t hatSwitchFlags[] = {0x1, 0x3, 0x2, 0x6, 0x4, 0xc, 0x8, 0x9};
+        const uint8_t hatSwitch = Load8(offsetof(report::InputReportData, buttons) + offsetof(report::Buttons, buttons0)) & 0xf;
+        return hatSwitch <= 7 ? static_cast<HatSwitch>(hatSwitchFlags[hatSwitch]) : HatSwitch::None;
+    }
+
+    [[nodiscard]] Rot<uint16_t> Gyro() const {
+        return {Load16(offsetof(report::InputReportData, gyroPitch)), Load16(offsetof(report::InputReportData, gyroYaw)),
+                Load16(offsetof(report::InputReportData, gyroRoll))};
+    }
+    [[nodiscard]] Vec3<uint16_t> Accel() const {
+        return {Load16(offsetof(report::InputReportData, accelX)), Load16(offsetof(report::InputReportData, accelY)),
+                Load16(offsetof(report::InputReportData, accelZ))};
+    }
+    /// Device timestamp of the report, from the motion sensor clock, wraps around
+    [[nodiscard]] uint32_t SensorTimestamp() const { return Load32(offsetof(report::InputReportData, sensorTimestamp)); }
+
+    [[nodiscard]] TouchPoint TouchPoint1() const { return LoadTouchPoint(offsetof(report::InputReportData, touchData) + offsetof(report::TouchData, point1)); }
+    [[nodiscard]] TouchPoint TouchPoint2() const { return LoadTouchPoint(offsetof(report::InputReportData, touchData) + offsetof(report::TouchData, point2)); }
+
+    [[nodiscard]] TriggerFeedback Feedback() const {
+        return {Load8(offsetof(report::InputReportData, leftTriggerFeedback)), Load8(offsetof(report::InputReportData, rightTriggerFeedback))};
+    }
+
+    [[nodiscard]] BatteryData Battery() const {
+        const report::BatteryData battery{Load8(offsetof(report::InputReportData, batteryData))};
+        return {battery.IsBatteryFull() != 0, static_cast<uint8_t>(battery.GetPercentage() * 10)};
+    }
+
+    [[nodiscard]] DeviceFlags Flags() const {
+        const auto reportFlags = static_cast<report::DeviceFlags>(Load8(offsetof(report::InputReportData, deviceFlags)));
+        DeviceFlags flags{};
+        SetFlags(flags, DeviceFlags::HeadphonesConnected, HasAnyFlag(reportFlags, report::DeviceFlags::HeadphonesConnected));
+        SetFlags(flags, DeviceFlags::MicConnected, HasAnyFlag(reportFlags, report::DeviceFlags::MicConnected));
+        SetFlags(flags, DeviceFlags::BatteryCharging, HasAnyFlag(reportFlags, report::DeviceFlags::BatteryCharging));
+        return flags;
+    }
+
+private:
+    [[nodiscard]] uint8_t Load8(size_t offset) const { return data[offset]; }
+    [[nodiscard]] uint16_t Load16(size_t offset) const { return static_cast<uint16_t>(data[offset] | data[offset + 1] << 8); }
+    [[nodiscard]] uint32_t Load32(size_t offset) const {
+        return static_cast<uint32_t>(data[offset]) | static_cast<uint32_t>(data[offset + 1]) << 8 | static_cast<uint32_t>(data[offset + 2]) << 16 |
+               static_cast<uint32_t>(data[offset + 3]) << 24;
+    }
+
+    [[nodiscard]] TouchPoint LoadTouchPoint(size_t offset) const {
+        const report::PointData point{data[offset], data[offset + 1], data[offset + 2], data[offset + 3]};
+        return {point.IsActive(), point.GetId(), {point.GetX(), point.GetY()}};
+    }
+
+private:
+    const uint8_t* data;
+};
+
+} // namespace ds
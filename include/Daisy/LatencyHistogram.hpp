@@ -0,0 +1,91 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ds {
+
+/// @brief Bucket layout shared by @see LatencyHistogram and @see LatencyHistogramSnapshot
+///
+/// Values are microseconds. Values below 32 get a bucket each, above that every power of two is split into 16 buckets,
+/// so a bucket is never wider than 1/16 of its values, up to the full 32 bit range.
+namespace latency_buckets {
+
+constexpr uint32_t SubBucketBits = 4;
+constexpr uint32_t SubBucketCount = 1u << SubBucketBits;
+constexpr size_t BucketCount = SubBucketCount * (32 - SubBucketBits + 1);
+
+constexpr size_t IndexOf(uint32_t value) {
+    if (value < 2 * SubBucketCount)
+        return value;
+    uint32_t msb = 0;
+    for (uint32_t rest = value; rest > 1; rest >>= 1) {
+        msb++;
+    }
+    const uint32_t shift = msb - SubBucketBits;
+    return SubBucketCount * shift + (value >> shift);
+}
+
+/// Smallest value of a bucket
+constexpr uint32_t LowerBound(size_t index) {
+    if (index < 2 * SubBucketCount)
+        return static_cast<uint32_t>(index);
+    const auto shift = static_cast<uint32_t>(index / SubBucketCount - 1);
+    return static_cast<uint32_t>(index % SubBucketCount + SubBucketCount) << shift;
+}
+
+/// Largest value of a bucket
+constexpr uint32_t UpperBound(size_t index) { return index + 1 < BucketCount ? LowerBound(index + 1) - 1 : UINT32_MAX; }
+
+static_assert(IndexOf(UINT32_MAX) == BucketCount - 1);
+static_assert(LowerBound(IndexOf(1000)) <= 1000 && UpperBound(IndexOf(1000)) >= 1000);
+
+} // namespace latency_buckets
+
+/// Copy of a histogram at one point in time
+struct LatencyHistogramSnapshot {
+    std::array<uint64_t, latency_buckets::BucketCount> buckets{};
+    /// Number of recorded values
+    uint64_t count = 0;
+    /// Sum of the recorded values, us
+    uint64_t sum = 0;
+    /// Extremes of the recorded values, both 0 while empty, us
+    uint32_t min = 0;
+    uint32_t max = 0;
+
+    /// Mean of the recorded values, us
+    [[nodiscard]] double Mean() const { return count != 0 ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+
+    /// @brief Value below or at which the given fraction of the recorded values lie
+    /// @param fraction fraction in 0..=1, e.g. 0.99 for the 99th percentile
+    /// @returns upper bound of the bucket holding the percentile, capped at the largest value, 0 while empty
+    [[nodiscard]] uint32_t Percentile(double fraction) const;
+};
+
+/// @brief Histogram of latencies with a fixed relative precision
+///
+/// Values are recorded with relaxed atomics, so any number of threads can record and take snapshots without locking.
+/// A snapshot taken while values are recorded may miss some of them in the totals while having them in a bucket or
+/// the other way around.
+class LatencyHistogram {
+public:
+    /// @brief Records a value
+    /// @param microseconds value, larger values are clamped
+    void Record(uint64_t microseconds);
+
+    /// @brief Copies the current counts
+    /// @param out snapshot output
+    void Snapshot(LatencyHistogramSnapshot* out) const;
+
+    /// @brief Removes all recorded values, values recorded concurrently may survive partially
+    void Reset();
+
+private:
+    std::array<std::atomic<uint64_t>, latency_buckets::BucketCount> buckets{};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint32_t> min{UINT32_MAX};
+    std::atomic<uint32_t> max{0};
+};
+
+} // namespace ds
@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ds {
+
+/// Number of the latest bluetooth frames the loss and corruption rates are measured over, about a second of input
+constexpr uint32_t LinkQualityWindowFrames = 256;
+
+/// Loss and corruption of the bluetooth input reports of a controller, all zero for usb controllers
+struct LinkQuality {
+    /// Fraction of the frames in the window that never arrived
+    float lossRate = 0.0f;
+    /// Fraction of the frames in the window that arrived with a wrong crc
+    float corruptionRate = 0.0f;
+    /// Frames in the window, below @see LinkQualityWindowFrames until that many were seen
+    uint32_t windowFrames = 0;
+
+    /// Frames since the controller connected
+    uint64_t framesReceived = 0;
+    uint64_t framesLost = 0;
+    uint64_t framesCorrupt = 0;
+};
+
+/// @brief Checks bluetooth input reports and measures how many get lost or corrupted on the way
+///
+/// Every report carries a crc and a 4 bit sequence number in the upper half of its second byte. Frames with a wrong crc
+/// are rejected, gaps in the sequence count the frames missing in between. 16 or more frames lost in a row alias to
+/// fewer, a link that bad shows up as a high loss rate regardless.
+///
+/// Reports are processed by one thread at a time, the rates can be read from any thread.
+class LinkQualityMonitor {
+public:
+    /// @brief Checks a report and accounts for it
+    /// @param reportData bluetooth input report 0x31, starting with the report id and ending with the crc
+    /// @param reportSize report size
+    /// @returns false for corrupt reports, which must not be used
+    bool Process(const uint8_t* reportData, size_t reportSize);
+
+    /// @brief Copies the current rates and totals
+    /// @param out link quality output
+    void Snapshot(LinkQuality* out) const;
+
+private:
+    enum class Frame : uint8_t { Received, Lost, Corrupt };
+
+    void Push(Frame frame);
+
+private:
+    /// Window of the latest frames, oldest at the cursor once full
+    std::array<Frame, LinkQualityWindowFrames> window{};
+    uint32_t cursor = 0;
+    uint32_t filled = 0;
+    uint8_t lastSequence = 0;
+    bool hasSequence = false;
+    /// Corrupt frames since the last valid one, their sequence numbers are part of the next gap
+    uint32_t corruptSinceValid = 0;
+
+    std::atomic<uint32_t> windowFrames{0};
+    std::atomic<uint32_t> windowLost{0};
+    std::atomic<uint32_t> windowCorrupt{0};
+    std::atomic<uint64_t> framesReceived{0};
+    std::atomic<uint64_t> framesLost{0};
+    std::atomic<uint64_t> framesCorrupt{0};
+};
+
+} // namespace ds
@@ -0,0 +1,86 @@
+#pragma once
+#include <Daisy/Calibration.hpp>
+#include <Daisy/ControllerInput.hpp>
+#include <Daisy/Vec.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ds {
+
+enum class MotionFilter : uint8_t {
+    /// Gradient descent step towards the measured gravity, @see MotionFusionSettings::beta
+    Madgwick,
+    /// Proportional-integral feedback of the gravity error, @see MotionFusionSettings::kp
+    Mahony,
+};
+
+struct MotionFusionSettings {
+    MotionFilter filter = MotionFilter::Madgwick;
+    /// Madgwick gain, higher values trust the accelerometer more and the gyroscope less
+    float beta = 0.1f;
+    /// Mahony proportional gain
+    float kp = 1.0f;
+    /// Mahony integral gain, slowly cancels gyroscope bias, 0 disables it
+    float ki = 0.0f;
+};
+
+/// @brief One motion sensor sample
+///
+/// Axes are the ones of a controller lying flat: x to the right, y away from the player and z up.
+/// The world frame of the filters has z up, an identity orientation is the controller lying flat.
+struct MotionSample {
+    /// Angular rate, rad/s
+    Vec3<float> gyro;
+    /// Acceleration, only the direction is used
+    Vec3<float> accel;
+    /// Time since the previous sample, seconds
+    float dt;
+};
+
+/// @brief Converts the calibrated motion fields of an input to a sample
+/// @param input decoded input
+/// @param dt time since the previous sample, @see SensorTimestampDelta
+MotionSample ToMotionSample(const ControllerInput& input, float dt);
+
+/// Filter state of a single controller
+struct MotionFusionState {
+    Quat<float> orientation{1.0f, 0.0f, 0.0f, 0.0f};
+    /// Mahony integral feedback
+    Vec3<float> integralError{0.0f, 0.0f, 0.0f};
+};
+
+/// @brief Steps the filter of a single controller by one sample
+/// @param settings filter settings
+/// @param sample motion sample
+/// @param state filter state to update
+void UpdateMotionFusion(const MotionFusionSettings& settings, const MotionSample& sample, MotionFusionState* state);
+
+/// @brief Filters of many controllers, stepped together
+///
+/// The state is kept in columns, one lane per controller, so an update steps four lanes per vector instruction on x86.
+/// Results are identical to stepping every lane with @see UpdateMotionFusion.
+class MotionFusionBank {
+public:
+    explicit MotionFusionBank(size_t laneCount, MotionFusionSettings settings = {});
+
+    /// @brief Steps every lane by one sample
+    /// @param samples one sample per lane, samples with a dt of 0 don't rotate their lane
+    void Update(const MotionSample* samples);
+
+    [[nodiscard]] size_t LaneCount() const { return laneCount; }
+    [[nodiscard]] Quat<float> Orientation(size_t lane) const { return {qw[lane], qx[lane], qy[lane], qz[lane]}; }
+
+    /// @brief Resets a lane to the identity orientation
+    void Reset(size_t lane);
+
+private:
+    MotionFusionSettings settings;
+    size_t laneCount;
+    std::vector<float> qw, qx, qy, qz;
+    /// Mahony integral feedback
+    std::vector<float> ix, iy, iz;
+};
+
+} // namespace ds
@@ -0,0 +1,44 @@
+#pragma once
+#include <Daisy/Report.hpp>
+
+namespace ds {
+
+/// @brief Output state a controller is known to be in
+///
+/// Every change flag of an output report applies a group of fields, e.g. @see report::ChangeFlags1::LeftTriggerEffects applies
+/// the left trigger effect. The state remembers the fields of every group that was transmitted, so that groups which wouldn't
+/// change anything can be dropped from the next report. Flags that don't apply any field (one-off actions, unknown bits)
+/// are never dropped, neither is @see report::ChangeFlags3::UnInterruptableLed, whose pulse options are a command
+/// rather than state.
+class OutputState {
+public:
+    /// @brief Reduces an output report to the change flags whose fields differ from the known state
+    /// @param data requested output
+    /// @returns data with the redundant change flags cleared
+    [[nodiscard]] report::OutputReportData Diff(const report::OutputReportData& data) const;
+
+    /// @brief Records that an output report was transmitted
+    /// @param data transmitted output
+    void Apply(const report::OutputReportData& data);
+
+    /// @brief Forgets the known state, the next report is transmitted as-is
+    void Reset();
+
+    /// @brief Coalesces two output reports into one with the effect of sending both in order
+    /// @param pending earlier output
+    /// @param data later output, its fields win over the earlier ones
+    /// @returns merged output, with the change flags of both
+    static report::OutputReportData Merge(const report::OutputReportData& pending, const report::OutputReportData& data);
+
+    /// @brief Checks whether an output report has no change flags set, in which case sending it has no effect
+    static bool IsEmpty(const report::OutputReportData& data);
+
+private:
+    report::OutputReportData applied{};
+    /// Change flags whose fields in applied are known to be on the controller
+    report::ChangeFlags1 known1 = report::ChangeFlags1::None;
+    report::ChangeFlags2 known2 = report::ChangeFlags2::None;
+    report::ChangeFlags3 known3 = report::ChangeFlags3::Off;
+};
+
+} // namespace ds
@@ -0,0 +1,116 @@
+#pragma once
+#include <Daisy/Report.hpp>
+#include <Daisy/Result.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+
+namespace ds {
+
+// Recording file layout, all values are little-endian:
+// RecordingHeader, then RecordHeader + payload repeated until the end of the file.
+
+constexpr uint32_t RecordingMagic = 0x43525344; // "DSRC"
+constexpr uint32_t RecordingVersion = 1;
+
+struct RecordingHeader {
+    uint32_t magic;
+    uint32_t version;
+};
+static_assert(sizeof(RecordingHeader) == 8);
+
+enum class RecordType : uint8_t {
+    /// Payload is the @see report::HidReportProperties of the controller
+    Connected,
+    /// No payload
+    Disconnected,
+    /// Payload is the raw input report, starting with the report id
+    Input,
+    /// Payload is the raw output report, starting with the report id
+    Output,
+    /// Payload is a raw feature report read on connect, starting with the report id
+    FeatureReport,
+};
+
+struct RecordHeader {
+    /// Host time since the recording started
+    uint64_t timestampNs;
+    /// Recording-local controller id, only unique while the controller is connected
+    uint32_t controllerId;
+    RecordType type;
+    uint8_t reserved;
+    uint16_t payloadSize;
+};
+static_assert(sizeof(RecordHeader) == 16);
+
+/// @brief Appends raw hid traffic to a recording file
+///
+/// Recording functions may be called from multiple threads, records are written in call order.
+class ReportRecorder {
+public:
+    ReportRecorder() = default;
+    ~ReportRecorder() { Close(); }
+
+    ReportRecorder(const ReportRecorder& other) = delete;
+    ReportRecorder& operator=(const ReportRecorder& other) = delete;
+
+    /// @brief Creates the recording file, replacing an existing one
+    /// @param path file path
+    /// @returns result code
+    Result Open(const char* path);
+    /// @brief Flushes and closes the recording file
+    /// @returns result code, the error of a failed write if recording stopped early
+    Result Close();
+    /// @brief Whether a recording file is open, cheap enough to check before every record
+    [[nodiscard]] bool IsOpen() const { return open.load(std::memory_order_acquire); }
+
+    void RecordConnected(uint32_t controllerId, const report::HidReportProperties& properties);
+    void RecordDisconnected(uint32_t controllerId);
+    void RecordInput(uint32_t controllerId, const void* reportData, size_t reportSize);
+    void RecordOutput(uint32_t controllerId, const void* reportData, size_t reportSize);
+    void RecordFeatureReport(uint32_t controllerId, const void* reportData, size_t reportSize);
+
+private:
+    void Write(RecordType type, uint32_t controllerId, const void* payload, size_t payloadSize);
+
+private:
+    std::mutex mutex;
+    std::FILE* file = nullptr;
+    std::atomic<bool> open{false};
+    /// First write error, the file gets closed on it since a partial record would throw off the replay
+    Result error = Result::OK;
+    std::chrono::steady_clock::time_point start{};
+};
+
+/// @brief Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+
+    /// @brief Maps a file, unmapping the previous one
+    /// @param path file path
+    /// @returns result code
+    Result Open(const char* path);
+    void Close();
+
+    [[nodiscard]] const uint8_t* Data() const { return data; }
+    [[nodiscard]] size_t Size() const { return size; }
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+#if defined(_WIN32)
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+} // namespace ds
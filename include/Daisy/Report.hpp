@@ -88,6 +88,38 @@ struct InputReportData {
 #pragma pack(pop)
 static_assert(sizeof(InputReportData) == 63);
 
+/// Feature report holding the factory calibration of the motion sensors
+constexpr uint8_t CALIBRATION_REPORT_ID = 0x05;
+
+#pragma pack(push, 1)
+/// Motion sensor calibration, plus and minus being the readings at known reference rates and at ±1 g
+struct CalibrationReport {
+    uint8_t reportId;
+    int16_t gyroPitchBias;
+    int16_t gyroYawBias;
+    int16_t gyroRollBias;
+    int16_t gyroPitchPlus;
+    int16_t gyroPitchMinus;
+    int16_t gyroYawPlus;
+    int16_t gyroYawMinus;
+    int16_t gyroRollPlus;
+    int16_t gyroRollMinus;
+    /// Reference rates the gyro readings were taken at, deg/s
+    int16_t gyroSpeedPlus;
+    int16_t gyroSpeedMinus;
+    int16_t accelXPlus;
+    int16_t accelXMinus;
+    int16_t accelYPlus;
+    int16_t accelYMinus;
+    int16_t accelZPlus;
+    int16_t accelZMinus;
+    uint8_t unk[2];
+    /// Only sent over bluetooth
+    uint32_t crc;
+};
+#pragma pack(pop)
+static_assert(sizeof(CalibrationReport) == 41);
+
 /// Output change flags part 1
 enum class ChangeFlags1 : uint8_t {
     None = 0x00,
@@ -147,7 +179,15 @@ enum class AudioMute : uint8_t {
 DS_BITFLAGS(AudioMute, uint8_t);
 
 /// Adaptive triggers mode
-enum class TriggerMode : uint8_t { Off = 0x05, Feedback = 0x21, Weapon = 0x25, Vibration = 0x26 };
+enum class TriggerMode : uint8_t {
+    Off = 0x05,
+    Feedback = 0x21,
+    Bow = 0x22,
+    Galloping = 0x23,
+    Weapon = 0x25,
+    Vibration = 0x26,
+    Machine = 0x27,
+};
 
 /// Adaptive trigger data
 #pragma pack(push, 1)
@@ -221,9 +261,12 @@ struct HIDReport {
     T data;
 };
 
+/// Bluetooth input report carrying full input data and a crc, bluetooth controllers can also send the shorter report 0x01
+constexpr uint8_t BLUETOOTH_INPUT_REPORT_ID = 0x31;
+
 struct BluetoothInputReport {
     uint8_t reportId;
-    uint8_t sequenceNumber;
+    uint8_t sequenceNumber; // [ sequence(4) | flags(4) ]
     InputReportData data;
 };
 
@@ -243,6 +286,37 @@ struct BluetoothOutputReport {
 };
 #pragma pack(pop)
 
+/// Bluetooth output report streaming samples to the voice coil actuators, layout as reverse engineered by the community
+constexpr uint8_t BLUETOOTH_HAPTICS_REPORT_ID = 0x32;
+/// Haptics report packet enabling sample playback
+constexpr uint8_t HAPTICS_CONFIG_PACKET_ID = 0x11;
+/// Haptics report packet carrying the samples
+constexpr uint8_t HAPTICS_SAMPLES_PACKET_ID = 0x12;
+/// Set in the flags of haptics report packets that carry a length
+constexpr uint8_t HAPTICS_PACKET_SIZED = 0x80;
+
+#pragma pack(push, 1)
+struct BluetoothHapticsReport {
+    uint8_t reportId;
+    uint8_t tag; // [ sequence(4) | unk(4) ]
+    uint8_t configPacketId;
+    uint8_t configPacketFlags; // [ sized | unk(7) ]
+    uint8_t configPacketLength;
+    uint8_t config[7];
+    uint8_t samplesPacketId;
+    uint8_t samplesPacketFlags; // [ sized | unk(7) ]
+    uint8_t samplesPacketLength;
+    /// Signed 8 bit stereo samples at 3 kHz, interleaved left/right
+    int8_t samples[64];
+    uint8_t pad[0x3a];
+    uint32_t crc;
+    /// Padding up to the size of @see BluetoothOutputReport, platforms trim it to the device's output report length
+    uint8_t pad_1[0x1b1];
+};
+#pragma pack(pop)
+static_assert(offsetof(BluetoothHapticsReport, crc) == 137);
+static_assert(sizeof(BluetoothHapticsReport) == sizeof(BluetoothOutputReport));
+
 struct HidReportProperties {
     uint16_t inputReportByteLength;
     uint16_t outputReportByteLength;
@@ -4,7 +4,7 @@
 namespace ds {
 
 struct Result {
-    enum { OK, INVALID_PARAMETER, NOTIFICATION_REGISTER, DEVICE_ENUMERATION, CONTROLLER_NOT_FOUND, USB_COMMUNICATION, UNKNOWN_INPUT_REPORT, TIMEOUT } code;
+    enum { OK, INVALID_PARAMETER, NOTIFICATION_REGISTER, DEVICE_ENUMERATION, CONTROLLER_NOT_FOUND, USB_COMMUNICATION, UNKNOWN_INPUT_REPORT, TIMEOUT, FILE_IO } code;
     uint32_t additionalInfo;
 
     Result(decltype(code) c) : code(c) {}
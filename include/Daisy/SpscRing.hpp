@@ -0,0 +1,116 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace ds {
+
+/// What a full ring does with a new element
+enum class OverflowPolicy : uint8_t {
+    /// The oldest element gets discarded to make space for the new one
+    DropOldest,
+    /// The new element gets discarded
+    DropNewest,
+};
+
+/// @brief Fixed-capacity lock-free single-producer/single-consumer ring
+///
+/// One thread may push while another one pops. The capacity is rounded up to a power of two and allocated once on construction.
+///
+/// With @see OverflowPolicy::DropOldest the producer advances the read position itself when the ring is full,
+/// a consumer racing with it notices the moved position and retries, which is why elements must be trivially copyable.
+template <typename T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable_v<T>, "SpscRing elements are copied while the producer may overwrite them");
+
+public:
+    explicit SpscRing(uint32_t capacity, OverflowPolicy policy = OverflowPolicy::DropOldest) : policy(policy) {
+        uint32_t roundedCapacity = 1;
+        while (roundedCapacity < capacity) {
+            roundedCapacity <<= 1;
+        }
+        slots.resize(roundedCapacity);
+        mask = roundedCapacity - 1;
+    }
+
+    SpscRing(const SpscRing& other) = delete;
+    SpscRing& operator=(const SpscRing& other) = delete;
+
+    /// @brief Pushes an element, must only be called from the producer thread
+    /// @returns false if the element was discarded because the ring was full
+    bool Push(const T& value) {
+        const uint64_t head = this->head.load(std::memory_order_relaxed);
+        uint64_t tail = this->tail.load(std::memory_order_acquire);
+        if (head - tail > mask) {
+            if (policy == OverflowPolicy::DropNewest) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            // if this fails the consumer just popped, which freed a slot as well
+            if (this->tail.compare_exchange_strong(tail, tail + 1, std::memory_order_acq_rel)) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        slots[head & mask] = value;
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Pops the oldest element, must only be called from the consumer thread
+    /// @returns false if the ring is empty
+    bool Pop(T* out) {
+        uint64_t tail = this->tail.load(std::memory_order_acquire);
+        while (true) {
+            const uint64_t head = this->head.load(std::memory_order_acquire);
+            if (tail == head)
+                return false;
+
+            const T value = slots[tail & mask];
+            if (this->tail.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel)) {
+                *out = value;
+                return true;
+            }
+        }
+    }
+
+    /// @brief Pops the newest element and discards everything older, must only be called from the consumer thread
+    /// @returns false if the ring is empty
+    bool PopLatest(T* out) {
+        uint64_t tail = this->tail.load(std::memory_order_acquire);
+        while (true) {
+            const uint64_t head = this->head.load(std::memory_order_acquire);
+            if (tail == head)
+                return false;
+
+            const T value = slots[(head - 1) & mask];
+            if (this->tail.compare_exchange_weak(tail, head, std::memory_order_acq_rel)) {
+                *out = value;
+                return true;
+            }
+        }
+    }
+
+    /// Number of elements currently in the ring
+    [[nodiscard]] size_t Size() const {
+        const uint64_t tail = this->tail.load(std::memory_order_acquire);
+        return static_cast<size_t>(this->head.load(std::memory_order_acquire) - tail);
+    }
+    /// Ring capacity
+    [[nodiscard]] size_t Capacity() const { return slots.size(); }
+    /// Number of elements discarded because the ring was full
+    [[nodiscard]] uint64_t Dropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<T> slots;
+    uint64_t mask = 0;
+    OverflowPolicy policy;
+
+    alignas(64) std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> dropped{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+};
+
+} // namespace ds
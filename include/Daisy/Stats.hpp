@@ -0,0 +1,77 @@
+#pragma once
+#include <Daisy/Assert.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+namespace ds {
+
+/// Whether counters and latency histograms are collected, turned off with the DAISY_STATS cmake option
+#ifdef DAISY_NO_STATS
+constexpr bool StatsEnabled = false;
+#else
+constexpr bool StatsEnabled = true;
+#endif
+
+/// Report counters of a controller, all zero when built without stats
+struct ControllerStats {
+    /// Input reports read from the device, whatever their report id
+    uint64_t reportsRead = 0;
+    /// Input reports dropped because their report id doesn't carry input data
+    uint64_t reportsDiscarded = 0;
+    /// Reads that found no report in time
+    uint64_t timeouts = 0;
+    /// Input queue flushes by the platform, which flushes after timeouts on some platforms
+    uint64_t queueFlushes = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t bytesSent = 0;
+    /// Output reports the device didn't accept
+    uint64_t sendFailures = 0;
+};
+
+/// Counters of the whole manager, all zero when built without stats
+struct GlobalStats {
+    /// Counters of every controller connected so far, including the disconnected ones
+    ControllerStats controllers;
+    /// Controllers that connected, a controller reconnecting after a dropout counts again
+    uint64_t connections = 0;
+    uint64_t disconnections = 0;
+};
+
+/// @brief Adds to a counter written by one thread at a time and read by any
+///
+/// A relaxed load and store rather than a locked read-modify-write, negative amounts of a signed type count down.
+template <typename T, typename Amount>
+void IncrementRelaxed(std::atomic<T>& counter, Amount amount) {
+    counter.store(static_cast<T>(counter.load(std::memory_order_relaxed) + static_cast<T>(amount)), std::memory_order_relaxed);
+}
+
+/// @brief Counter written by one thread at a time and read by any
+///
+/// Increments are a relaxed load and store rather than a locked read-modify-write, the writers are serialized by the
+/// controller locks anyway. Compiles to nothing without stats.
+class StatCounter {
+public:
+    void Add(uint64_t amount = 1) {
+#ifndef DAISY_NO_STATS
+        IncrementRelaxed(value, amount);
+#else
+        DS_UNUSED(amount);
+#endif
+    }
+
+    [[nodiscard]] uint64_t Load() const {
+#ifndef DAISY_NO_STATS
+        return value.load(std::memory_order_relaxed);
+#else
+        return 0;
+#endif
+    }
+
+private:
+#ifndef DAISY_NO_STATS
+    std::atomic<uint64_t> value{0};
+#endif
+};
+
+} // namespace ds
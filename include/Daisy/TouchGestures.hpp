@@ -0,0 +1,134 @@
+#pragma once
+#include <Daisy/ControllerInput.hpp>
+#include <Daisy/SpscRing.hpp>
+
+#include <cstdint>
+
+namespace ds {
+
+/// Touchpad resolution, positions range from 0 to one less than these
+constexpr uint16_t TouchpadWidth = 1920;
+constexpr uint16_t TouchpadHeight = 1080;
+
+enum class TouchGestureType : uint8_t {
+    /// Short touch that barely moved, at the touch position
+    Tap,
+    /// Second tap close to the previous one, reported after the tap event of the second touch
+    DoubleTap,
+    /// Fast single finger stroke, with its direction and velocity
+    Swipe,
+    /// Two fingers moving relative to each other, with the scale and rotation since they touched down
+    Pinch,
+    /// Single finger that started at an edge moving along it, with the distance moved since the previous event
+    EdgeScroll,
+};
+
+/// Phase of the continuous gestures, pinch and edge scroll
+enum class TouchGesturePhase : uint8_t {
+    /// Discrete gestures only have this phase
+    Begin,
+    Change,
+    End,
+};
+
+/// Direction of a swipe, up being towards the top of the touchpad
+enum class SwipeDirection : uint8_t { None, Left, Right, Up, Down };
+
+/// Edge of the touchpad an edge scroll runs along
+enum class TouchEdge : uint8_t { None, Left, Right, Top, Bottom };
+
+/// A recognized gesture
+struct TouchGestureEvent {
+    /// Device timestamp of the report the gesture was seen in, @see ControllerInput::sensorTimestamp
+    uint32_t sensorTimestamp;
+    TouchGestureType type;
+    TouchGesturePhase phase;
+    /// Direction, for swipes
+    SwipeDirection direction;
+    /// Edge, for edge scrolls
+    TouchEdge edge;
+    /// Tap position, swipe end, center between the pinching fingers or the scrolling finger
+    Vec2<uint16_t> position;
+    /// Swipe velocity in touchpad units per second, pinch scale or edge scroll distance in touchpad units
+    float value;
+    /// Pinch rotation in radians, clockwise being positive
+    float rotation;
+};
+
+/// Gesture thresholds, distances are in touchpad units and times in seconds
+struct TouchGestureSettings {
+    /// Longest touch that still counts as a tap
+    float tapMaxDuration = 0.25f;
+    /// Farthest a tap may move, also how far a finger has to move along an edge before it scrolls
+    float tapMaxMovement = 40.0f;
+    /// Longest time between the ends of the two taps of a double tap
+    float doubleTapMaxInterval = 0.3f;
+    /// Farthest the two taps of a double tap may be apart
+    float doubleTapMaxDistance = 120.0f;
+    /// Shortest stroke that counts as a swipe
+    float swipeMinDistance = 300.0f;
+    /// Slowest stroke that counts as a swipe, in touchpad units per second
+    float swipeMinVelocity = 1000.0f;
+    /// Width of the border a finger has to touch down in to start an edge scroll
+    float edgeMargin = 100.0f;
+};
+
+/// @brief Recognizes touchpad gestures from consecutive inputs
+///
+/// Contacts are tracked by their touch id, so a finger keeps its identity when it moves between the two touch points
+/// of the report. Timing comes from the sensor timestamps, which makes recognition independent of how often inputs are
+/// read as long as every report is processed. Doesn't allocate.
+///
+/// Once a second finger touches down, the fingers only pinch until all of them are lifted, so lifting one of them
+/// isn't taken as a tap or swipe.
+class TouchGestureRecognizer {
+public:
+    explicit TouchGestureRecognizer(TouchGestureSettings settings = {}) : settings(settings) {}
+
+    /// @brief Updates the contacts with the next input and pushes the recognized gestures
+    /// @param input next input
+    /// @param events queue to push into
+    void Process(const ControllerInput& input, SpscRing<TouchGestureEvent>& events);
+
+private:
+    struct Contact {
+        bool active;
+        uint8_t id;
+        Vec2<float> start;
+        Vec2<float> last;
+        /// Recognizer time the contact touched down at, in sensor ticks
+        uint64_t startTime;
+        /// Edge the contact touched down at, cleared once it moves away from it
+        TouchEdge edge;
+        bool scrolling;
+    };
+
+    void BeginContact(const TouchPoint& point, SpscRing<TouchGestureEvent>& events);
+    void MoveContact(Contact& contact, Vec2<float> position, SpscRing<TouchGestureEvent>& events);
+    void EndContact(Contact& contact, SpscRing<TouchGestureEvent>& events);
+    void UpdatePinch(SpscRing<TouchGestureEvent>& events, TouchGesturePhase phase);
+    /// Event stamped with the current report, the type specific fields are left for the caller
+    [[nodiscard]] TouchGestureEvent MakeEvent(TouchGestureType type, TouchGesturePhase phase, Vec2<float> position, float value) const;
+    [[nodiscard]] TouchEdge EdgeAt(Vec2<float> position) const;
+
+private:
+    TouchGestureSettings settings;
+    Contact contacts[2]{};
+    /// Sensor ticks since the first input, unlike the timestamps this doesn't wrap around
+    uint64_t now = 0;
+    uint32_t lastTimestamp = 0;
+    bool hasPrevious = false;
+
+    /// Set while two fingers are down, and until every finger is lifted afterwards
+    bool multiTouch = false;
+    bool pinching = false;
+    float pinchStartDistance = 0.0f;
+    float pinchAngle = 0.0f;
+    float pinchRotation = 0.0f;
+
+    bool hasLastTap = false;
+    uint64_t lastTapTime = 0;
+    Vec2<float> lastTapPosition{};
+};
+
+} // namespace ds
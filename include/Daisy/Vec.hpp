@@ -22,6 +22,15 @@ struct Rot {
     T roll;
 };
 
+/// Rotation quaternion, w being the scalar part
+template <typename T>
+struct Quat {
+    T w;
+    T x;
+    T y;
+    T z;
+};
+
 template <typename T>
 struct Color {
     T r;
@@ -0,0 +1,137 @@
+#pragma once
+#include <Daisy/Atomic.hpp>
+#include <Daisy/Handle.hpp>
+#include <Daisy/Report.hpp>
+#include <Daisy/Result.hpp>
+#include <Daisy/linux/RAIIHandle.hpp>
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ds {
+
+struct LinuxControllerData {
+    std::string devicePath;
+    FdHandle hidFd;
+    report::HidReportProperties properties;
+    /// Set when an I/O error reported the device as gone, the controller gets removed on the next tick.
+    /// Atomic because input and output threads can hit the error at the same time
+    AtomicBool disconnected = false;
+    void* userData;
+};
+
+class LinuxManager {
+public:
+    using ControllerHandle = Handle<LinuxControllerData>;
+
+    /// Whether reads that time out flush the input queue of the controller, @see ControllerStats::queueFlushes
+    static constexpr bool FlushesQueueOnTimeout = false;
+
+public:
+    /// @brief Ticks the manager
+    ///
+    /// This must be called every so-often for the device disconnect/connect events to take effect
+    void Tick();
+
+    /// @brief Enumerate connected devices
+    ///
+    /// Only needed once on startup, after that devices are tracked through hotplug events
+    Result EnumerateDevices();
+
+    /// @brief Gets handles for connected controllers
+    [[nodiscard]] const std::vector<ControllerHandle>& GetConnectedControllers() const;
+
+    /// @brief Reads a report for a controller
+    /// @param controller controller handle
+    /// @param reportData report data to be filled
+    /// @param reportSize report data size
+    /// @param readSize actual read size from the device
+    /// @returns result code
+    Result GetReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize);
+
+    /// @brief Reads a report for a controller without waiting
+    /// @param controller controller handle
+    /// @param reportData report data to be filled
+    /// @param reportSize report data size
+    /// @param readSize actual read size from the device
+    /// @returns result code, TIMEOUT if no report is queued
+    Result PollReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize);
+
+    /// @brief Waits until at least one connected controller has a report queued
+    /// @param timeoutMs maximum time to wait
+    /// @returns result code, TIMEOUT if no report arrived in time
+    Result WaitForReports(uint32_t timeoutMs);
+
+    /// @brief Sets whether @see LinuxManager::WaitForReports waits on a controller, e.g. not on one read by a background reader
+    /// @param controller controller handle
+    /// @param waited whether reports of the controller end the wait, the default
+    /// @returns result code
+    Result SetReportsWaited(ControllerHandle controller, bool waited);
+
+    /// @brief Sends a report to the controller
+    /// @param controller controller handle
+    /// @param reportData report data to send
+    /// @param reportSize report data size
+    /// @returns result code
+    Result SendReport(ControllerHandle controller, const void* reportData, size_t reportSize);
+
+    /// @brief Reads a feature report from the controller
+    /// @param controller controller handle
+    /// @param reportData report data to be filled, the first byte selects the report id
+    /// @param reportSize report data size
+    /// @param readSize actual read size from the device
+    /// @returns result code
+    Result GetFeatureReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize);
+
+    /// @brief Gets hid report properties of a controller
+    /// @param controller controller handle
+    /// @param outProperties properties to set
+    /// @returns result code
+    Result GetHidProperties(ControllerHandle controller, report::HidReportProperties* outProperties);
+
+    /// @brief Gets user data for the controller
+    /// @param controller controller handle
+    /// @param outUserData user data output
+    Result GetUserData(ControllerHandle controller, void** outUserData);
+
+    /// @brief Sets user data for the controller
+    /// @param controller controller handle
+    /// @param userData pointer to set as user data
+    Result SetUserData(ControllerHandle controller, void* userData);
+
+private:
+    static Result Create(std::function<void(ControllerHandle)> onConnected, std::function<void(ControllerHandle)> onDisconnect, LinuxManager* outManager);
+
+private:
+    /// Opens a hidraw node and connects it if it's a DualSense that isn't tracked yet
+    void ProbeDevice(const std::string& devicePath);
+    /// Drains readiness events of the epoll set
+    void ProcessEvents();
+    /// Drains hotplug events from the netlink monitor socket
+    void ProcessHotplugEvents(std::vector<std::string>& addedDevices);
+
+    ControllerHandle FindController(const std::string& devicePath) const;
+
+    ControllerHandle OnControllerConnected(LinuxControllerData controllerData);
+    void OnControllerDisconnect(ControllerHandle controller);
+
+private:
+    SlotMap<LinuxControllerData> controllers{};
+    std::vector<ControllerHandle> connectedControllers{}; // storing in a separate vector, to prevent allocation on query
+    /// Tracked controllers by their hidraw node
+    std::unordered_map<std::string, ControllerHandle> controllersByPath{};
+    std::function<void(ControllerHandle)> onConnected;
+    std::function<void(ControllerHandle)> onDisconnect;
+    FdHandle epollFd{};
+    /// Readability of every controller, waited on by @see LinuxManager::WaitForReports
+    FdHandle readEpollFd{};
+    FdHandle monitorFd{};
+    AtomicBool wantsEnumeration = true;
+
+private:
+    friend class DaisyManager;
+};
+
+} // namespace ds
@@ -0,0 +1,12 @@
+#pragma once
+#include <Daisy/RAIIHandle.hpp>
+
+namespace ds {
+
+struct CloseFd {
+    static constexpr int INVALID = -1;
+    void operator()(int& fd) const;
+};
+using FdHandle = RAIIHandle<int, CloseFd>;
+
+} // namespace ds
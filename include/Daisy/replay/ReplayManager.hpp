@@ -0,0 +1,151 @@
+#pragma once
+#include <Daisy/Atomic.hpp>
+#include <Daisy/Handle.hpp>
+#include <Daisy/Recording.hpp>
+#include <Daisy/Report.hpp>
+#include <Daisy/Result.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ds {
+
+/// How fast a recording is served
+enum class ReplayMode : uint8_t {
+    /// Reports become available at the time they were recorded
+    RealTime,
+    /// Reports are available as soon as they're read, hotplug events wait until every connected controller read up to them
+    AsFastAsPossible,
+};
+
+struct ReplayControllerData {
+    /// Controller id in the recording
+    uint32_t recordedId;
+    report::HidReportProperties properties;
+    /// Offset of the first record this controller hasn't looked at yet
+    size_t cursor;
+    void* userData;
+    /// @see ReplayManager::SetReportsWaited, atomic since it's changed while other threads wait
+    AtomicBool reportsWaited = true;
+};
+
+/// @brief Platform serving reports from a recording made with @see DaisyManager::StartRecording
+///
+/// The recording is memory-mapped, so replaying doesn't allocate per report. Output reports are accepted and discarded.
+///
+/// Select it for @see DaisyManager by configuring with `-DDAISY_PLATFORM=Replay`.
+class ReplayManager {
+public:
+    using ControllerHandle = Handle<ReplayControllerData>;
+
+    /// Whether reads that time out flush the input queue of the controller, @see ControllerStats::queueFlushes
+    static constexpr bool FlushesQueueOnTimeout = false;
+
+public:
+    /// @brief Ticks the manager
+    ///
+    /// Connects and disconnects controllers as their hotplug records become due
+    void Tick();
+
+    /// @brief Enumerate connected devices
+    ///
+    /// No-op, controllers come from the recording
+    Result EnumerateDevices();
+
+    /// @brief Gets handles for connected controllers
+    [[nodiscard]] const std::vector<ControllerHandle>& GetConnectedControllers() const;
+
+    /// @brief Reads a report for a controller
+    /// @param controller controller handle
+    /// @param reportData report data to be filled
+    /// @param reportSize report data size
+    /// @param readSize actual read size from the device
+    /// @returns result code, TIMEOUT without waiting if no report is due
+    Result GetReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize);
+
+    /// @brief Reads a report for a controller without waiting, same as @see ReplayManager::GetReport
+    Result PollReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize);
+
+    /// @brief Waits until at least one connected controller has a report due
+    /// @param timeoutMs maximum time to wait
+    /// @returns result code, TIMEOUT if no report became due in time
+    Result WaitForReports(uint32_t timeoutMs);
+
+    /// @brief Sets whether @see ReplayManager::WaitForReports waits on a controller, e.g. not on one read by a background reader
+    /// @param controller controller handle
+    /// @param waited whether reports of the controller end the wait, the default
+    /// @returns result code
+    Result SetReportsWaited(ControllerHandle controller, bool waited);
+
+    /// @brief Accepts and discards a report
+    Result SendReport(ControllerHandle controller, const void* reportData, size_t reportSize);
+
+    /// @brief Reads a feature report recorded when the controller connected
+    /// @param controller controller handle
+    /// @param reportData report data to be filled, the first byte selects the report id
+    /// @param reportSize report data size
+    /// @param readSize actual read size
+    /// @returns result code, USB_COMMUNICATION if the recording doesn't hold the report
+    Result GetFeatureReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize);
+
+    /// @brief Gets hid report properties of a controller
+    /// @param controller controller handle
+    /// @param outProperties properties to set
+    /// @returns result code
+    Result GetHidProperties(ControllerHandle controller, report::HidReportProperties* outProperties);
+
+    /// @brief Gets user data for the controller
+    /// @param controller controller handle
+    /// @param outUserData user data output
+    Result GetUserData(ControllerHandle controller, void** outUserData);
+
+    /// @brief Sets user data for the controller
+    /// @param controller controller handle
+    /// @param userData pointer to set as user data
+    Result SetUserData(ControllerHandle controller, void* userData);
+
+public:
+    /// @brief Starts replaying a recording, the previous one is stopped and its controllers get disconnected on the next tick
+    /// @param path recording file
+    /// @param mode replay speed
+    /// @returns result code
+    Result Open(const char* path, ReplayMode mode);
+
+    /// @brief Whether every record of the recording was served
+    [[nodiscard]] bool IsFinished();
+
+private:
+    static Result Create(std::function<void(ControllerHandle)> onConnected, std::function<void(ControllerHandle)> onDisconnect, ReplayManager* outManager);
+
+private:
+    /// Reads the record header at an offset, false if no complete record starts there
+    bool ReadRecord(size_t offset, RecordHeader* outHeader) const;
+    /// Finds the next input record of a controller, skipping the records of others
+    /// @returns record offset or the recording size if there is none
+    size_t FindInput(ReplayControllerData& controllerData) const;
+    /// Offset of the record following the one at offset
+    static size_t NextRecord(size_t offset, const RecordHeader& header) { return offset + sizeof(RecordHeader) + header.payloadSize; }
+    [[nodiscard]] bool IsDue(uint64_t timestampNs) const;
+    void Disconnect(ControllerHandle controller);
+
+private:
+    std::unique_ptr<MappedFile> file = std::make_unique<MappedFile>();
+    ReplayMode mode = ReplayMode::RealTime;
+    std::chrono::steady_clock::time_point start{};
+    /// Offset of the next hotplug record to process
+    size_t hotplugCursor = 0;
+
+    SlotMap<ReplayControllerData> controllers{};
+    std::vector<ControllerHandle> connectedControllers{}; // storing in a separate vector, to prevent allocation on query
+    std::function<void(ControllerHandle)> onConnected;
+    std::function<void(ControllerHandle)> onDisconnect;
+
+private:
+    friend class DaisyManager;
+};
+
+} // namespace ds
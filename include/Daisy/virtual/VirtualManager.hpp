@@ -0,0 +1,202 @@
+#pragma once
+#include <Daisy/Handle.hpp>
+#include <Daisy/Report.hpp>
+#include <Daisy/Result.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ds {
+
+/// Transport a virtual controller pretends to be connected over, decides report sizes and framing
+enum class VirtualTransport : uint8_t { Usb, Bluetooth };
+
+/// Produces the input report for the frame with the given index
+using VirtualReportGenerator = std::function<report::InputReportData(uint64_t frameIndex)>;
+
+struct VirtualControllerData {
+    VirtualTransport transport;
+    report::HidReportProperties properties;
+    std::deque<std::vector<uint8_t>> inputQueue;
+    size_t inputQueueLimit;
+    uint8_t sequenceNumber;
+
+    VirtualReportGenerator generator;
+    double generatorRateHz;
+    std::chrono::steady_clock::time_point generatorStart;
+    uint64_t generatedFrames;
+
+    std::vector<std::vector<uint8_t>> sentReports;
+    /// Served by @see VirtualManager::GetFeatureReport, looked up by their first byte
+    std::vector<std::vector<uint8_t>> featureReports;
+
+    bool connected;
+    bool pendingRemoval;
+    void* userData;
+    /// @see VirtualManager::SetReportsWaited
+    bool reportsWaited = true;
+};
+
+/// @brief In-memory platform with synthetic controllers
+///
+/// Controllers are created and destroyed by the test code, their connection/disconnection gets reported on the next tick
+/// like with a real device. Input reports are either injected one by one or generated at a fixed rate, every sent output
+/// report is captured for inspection. All methods are safe to call from multiple threads, except that the list returned by
+/// @see VirtualManager::GetConnectedControllers is changed by @see VirtualManager::Tick, like on the other platforms.
+///
+/// Select it for @see DaisyManager by configuring with `-DDAISY_PLATFORM=Virtual`.
+class VirtualManager {
+public:
+    using ControllerHandle = Handle<VirtualControllerData>;
+
+    /// Whether reads that time out flush the input queue of the controller, @see ControllerStats::queueFlushes
+    static constexpr bool FlushesQueueOnTimeout = false;
+
+public:
+    /// @brief Ticks the manager
+    ///
+    /// This must be called every so-often for the device disconnect/connect events to take effect
+    void Tick();
+
+    /// @brief Enumerate connected devices
+    ///
+    /// No-op, virtual controllers are only ever created explicitly
+    Result EnumerateDevices();
+
+    /// @brief Gets handles for connected controllers
+    ///
+    /// Only changes on @see VirtualManager::Tick, which must not run while the list is being read.
+    /// Creating and destroying controllers doesn't touch it.
+    [[nodiscard]] const std::vector<ControllerHandle>& GetConnectedControllers() const;
+
+    /// @brief Reads a report for a controller
+    /// @param controller controller handle
+    /// @param reportData report data to be filled
+    /// @param reportSize report data size
+    /// @param readSize actual read size from the device
+    /// @returns result code, TIMEOUT without waiting if no report is queued
+    Result GetReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize);
+
+    /// @brief Reads a report for a controller without waiting
+    /// @param controller controller handle
+    /// @param reportData report data to be filled
+    /// @param reportSize report data size
+    /// @param readSize actual read size from the device
+    /// @returns result code, TIMEOUT if no report is queued
+    Result PollReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize);
+
+    /// @brief Waits until at least one connected controller has a report queued
+    /// @param timeoutMs maximum time to wait
+    /// @returns result code, TIMEOUT if no report arrived in time
+    Result WaitForReports(uint32_t timeoutMs);
+
+    /// @brief Sets whether @see VirtualManager::WaitForReports waits on a controller, e.g. not on one read by a background reader
+    /// @param controller controller handle
+    /// @param waited whether reports of the controller end the wait, the default
+    /// @returns result code
+    Result SetReportsWaited(ControllerHandle controller, bool waited);
+
+    /// @brief Sends a report to the controller
+    /// @param controller controller handle
+    /// @param reportData report data to send
+    /// @param reportSize report data size
+    /// @returns result code
+    Result SendReport(ControllerHandle controller, const void* reportData, size_t reportSize);
+
+    /// @brief Reads a feature report from the controller
+    /// @param controller controller handle
+    /// @param reportData report data to be filled, the first byte selects the report id
+    /// @param reportSize report data size
+    /// @param readSize actual read size from the device
+    /// @returns result code, USB_COMMUNICATION for reports that weren't set, @see VirtualManager::SetFeatureReport
+    Result GetFeatureReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize);
+
+    /// @brief Gets hid report properties of a controller
+    /// @param controller controller handle
+    /// @param outProperties properties to set
+    /// @returns result code
+    Result GetHidProperties(ControllerHandle controller, report::HidReportProperties* outProperties);
+
+    /// @brief Gets user data for the controller
+    /// @param controller controller handle
+    /// @param outUserData user data output
+    Result GetUserData(ControllerHandle controller, void** outUserData);
+
+    /// @brief Sets user data for the controller
+    /// @param controller controller handle
+    /// @param userData pointer to set as user data
+    Result SetUserData(ControllerHandle controller, void* userData);
+
+public:
+    /// @brief Creates a virtual controller
+    /// @param transport transport to emulate
+    /// @param inputQueueLimit how many input reports can be queued before the oldest ones get dropped, like the OS hid buffer
+    /// @returns controller handle, the controller is reported as connected on the next tick
+    ControllerHandle CreateController(VirtualTransport transport, size_t inputQueueLimit = 32);
+
+    /// @brief Destroys a virtual controller, it gets reported as disconnected on the next tick
+    /// @param controller controller handle
+    Result DestroyController(ControllerHandle controller);
+
+    /// @brief Queues an input report, framed according to the controller transport
+    /// @param controller controller handle
+    /// @param data input report data
+    Result InjectReport(ControllerHandle controller, const report::InputReportData& data);
+
+    /// @brief Queues a raw report as-is, e.g. to exercise unknown report ids
+    /// @param controller controller handle
+    /// @param reportData raw report, starting with the report id
+    /// @param reportSize raw report size
+    Result InjectRawReport(ControllerHandle controller, const void* reportData, size_t reportSize);
+
+    /// @brief Sets a feature report the controller answers with, replacing the one with the same report id
+    /// @param controller controller handle
+    /// @param reportData raw report, starting with the report id
+    /// @param reportSize raw report size
+    ///
+    /// Controllers answer no feature report by default. The calibration report is read when the controller connects,
+    /// so it has to be set before that tick.
+    Result SetFeatureReport(ControllerHandle controller, const void* reportData, size_t reportSize);
+
+    /// @brief Generates input reports at a fixed rate, replacing any previous generator
+    /// @param controller controller handle
+    /// @param generator report generator, an empty function stops generation
+    /// @param rateHz reports per second
+    ///
+    /// Reports that became due are queued whenever the controller is read, so no thread is involved.
+    Result SetReportGenerator(ControllerHandle controller, VirtualReportGenerator generator, double rateHz);
+
+    /// @brief Takes every output report sent to the controller since the last call
+    /// @param controller controller handle
+    /// @param outReports raw output reports, in send order
+    Result TakeSentReports(ControllerHandle controller, std::vector<std::vector<uint8_t>>* outReports);
+
+private:
+    static Result Create(std::function<void(ControllerHandle)> onConnected, std::function<void(ControllerHandle)> onDisconnect, VirtualManager* outManager);
+
+private:
+    void PushReport(VirtualControllerData& controllerData, const report::InputReportData& data);
+    void PushRawReport(VirtualControllerData& controllerData, const uint8_t* reportData, size_t reportSize);
+    void GenerateDueReports(VirtualControllerData& controllerData);
+    static std::chrono::steady_clock::time_point NextGeneratedReport(const VirtualControllerData& controllerData);
+
+private:
+    SlotMap<VirtualControllerData> controllers{};
+    std::vector<ControllerHandle> connectedControllers{}; // storing in a separate vector, to prevent allocation on query
+    std::vector<ControllerHandle> createdControllers{};
+    std::function<void(ControllerHandle)> onConnected;
+    std::function<void(ControllerHandle)> onDisconnect;
+    std::unique_ptr<std::mutex> mutex = std::make_unique<std::mutex>();
+    std::unique_ptr<std::condition_variable> reportQueued = std::make_unique<std::condition_variable>();
+
+private:
+    friend class DaisyManager;
+};
+
+} // namespace ds
@@ -7,24 +7,58 @@
 #include <Daisy/windows/WindowsFwd.hpp>
 
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace ds {
 
+class WindowsManager;
+
+/// Context of the per-device notification, heap allocated so it stays put while the controller data moves
+struct DeviceNotificationContext {
+    WindowsManager* manager;
+    uint64_t controller;
+    std::wstring devicePath;
+};
+
+/// Read kept pending on the overlapped device handle, heap allocated since the os writes into it while the controller data moves
+struct PendingRead;
+/// Cancels the read and waits for the cancellation before freeing it
+struct CancelRead {
+    void operator()(PendingRead* read) const;
+};
+
 struct WindowsControllerData {
     std::wstring devicePath;
     WinHandle hidHandle;
+    /// Must outlive the notification, which is why it's declared before it
+    std::unique_ptr<DeviceNotificationContext> notificationContext;
     NotificationHandle deviceNotification;
-    WinHandle readEventHandle;
+    /// Declared after the device handle, the read is cancelled before the handle closes
+    std::unique_ptr<PendingRead, CancelRead> pendingRead;
+    /// Writes wait on this event, the lock keeps output and haptics threads from sharing it at once
+    WinHandle writeEventHandle;
+    std::unique_ptr<std::mutex> writeMutex;
     report::HidReportProperties properties;
+    /// Feature reads need a buffer of exactly this size
+    uint16_t featureReportByteLength;
     void* userData;
+    /// @see WindowsManager::SetReportsWaited, atomic since it's changed while other threads wait
+    AtomicBool reportsWaited = true;
 };
 
+/// Device handles are overlapped, reads and writes of a controller don't wait on each other, so input and output of the
+/// same controller proceed concurrently.
 class WindowsManager {
 public:
     using ControllerHandle = Handle<WindowsControllerData>;
 
+    /// Whether waiting reads that time out flush the input queue of the controller, @see ControllerStats::queueFlushes
+    static constexpr bool FlushesQueueOnTimeout = true;
+
 public:
     /// @brief Ticks the manager
     ///
@@ -32,6 +66,8 @@ public:
     void Tick();
 
     /// @brief Enumerate connected devices
+    ///
+    /// Only needed once on startup, after that devices are tracked through arrival/removal notifications
     Result EnumerateDevices();
 
     /// @brief Gets handles for connected controllers
@@ -45,6 +81,30 @@ public:
     /// @returns result code
     Result GetReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize);
 
+    /// @brief Reads a report for a controller without waiting
+    /// @param controller controller handle
+    /// @param reportData report data to be filled
+    /// @param reportSize report data size
+    /// @param readSize actual read size from the device
+    /// @returns result code
+    ///
+    /// Every controller keeps one overlapped read pending, this takes its report if it completed and starts the next read.
+    /// TIMEOUT if no report arrived yet.
+    Result PollReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize);
+
+    /// @brief Waits until at least one connected controller has a report queued
+    /// @param timeoutMs maximum time to wait
+    /// @returns result code
+    ///
+    /// Waits on the events of the pending reads, at most of the first 64 controllers (MAXIMUM_WAIT_OBJECTS)
+    Result WaitForReports(uint32_t timeoutMs);
+
+    /// @brief Sets whether @see WindowsManager::WaitForReports waits on a controller, e.g. not on one read by a background reader
+    /// @param controller controller handle
+    /// @param waited whether reports of the controller end the wait, the default
+    /// @returns result code
+    Result SetReportsWaited(ControllerHandle controller, bool waited);
+
     /// @brief Sends a report to the controller
     /// @param controller controller handle
     /// @param reportData report data to send
@@ -52,6 +112,14 @@ public:
     /// @returns result code
     Result SendReport(ControllerHandle controller, const void* reportData, size_t reportSize);
 
+    /// @brief Reads a feature report from the controller
+    /// @param controller controller handle
+    /// @param reportData report data to be filled, the first byte selects the report id
+    /// @param reportSize report data size
+    /// @param readSize actual read size from the device
+    /// @returns result code
+    Result GetFeatureReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize);
+
     /// @brief Gets hid report properties of a controller
     /// @param controller controller handle
     /// @param outProperties properties to set
@@ -72,21 +140,40 @@ private:
     static Result Create(std::function<void(ControllerHandle)> onConnected, std::function<void(ControllerHandle)> onDisconnect, WindowsManager* outManager);
 
 private:
+    /// Opens a hid interface and connects it if it's a DualSense that isn't tracked yet
+    void ProbeDevice(const std::wstring& devicePath);
+    /// Applies the queued arrivals and removals
+    void ProcessHotplugEvents();
+
+    ControllerHandle FindController(const std::wstring& devicePath) const;
+
     ControllerHandle OnControllerConnected(WindowsControllerData controllerData);
     void OnControllerDisconnect(ControllerHandle controller);
 
+    /// Hotplug notifications arrive on a system thread, they are queued and applied on the next tick
+    struct HotplugEvents {
+        std::vector<std::wstring> arrivedPaths;
+        std::vector<std::wstring> removedPaths;
+        std::vector<ControllerHandle> removedControllers;
+    };
+
 private:
-    HandleVec<WindowsControllerData> controllers{};
+    SlotMap<WindowsControllerData> controllers{};
     std::vector<ControllerHandle> connectedControllers{}; // storing in a separate vector, to prevent allocation on query
+    /// Tracked controllers by their device path, case folded since the os doesn't agree on the casing
+    std::unordered_map<std::wstring, ControllerHandle> controllersByPath{};
     std::function<void(ControllerHandle)> onConnected;
     std::function<void(ControllerHandle)> onDisconnect;
     NotificationHandle notificationHandle{};
     AtomicBool wantsEnumeration = true;
+    std::unique_ptr<std::mutex> hotplugMutex = std::make_unique<std::mutex>();
+    HotplugEvents pendingHotplug{};
 
 private:
     friend class DaisyManager;
-    friend void OnDeviceAdded(WindowsManager* self);
-    friend void OnDeviceRemoved(WindowsManager* self);
+    friend void OnDeviceArrived(WindowsManager* self, const wchar_t* devicePath);
+    friend void OnDeviceRemoved(WindowsManager* self, const wchar_t* devicePath);
+    friend void OnDeviceRemoved(WindowsManager* self, Handle<WindowsControllerData> controller);
 };
 
 } // namespace ds
\ No newline at end of file
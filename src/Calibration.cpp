@@ -0,0 +1,74 @@
+#include <Daisy/Calibration.hpp>
+#include <Daisy/Crc32.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace ds {
+
+/// Calibrated sensitivities further off the nominal ones than this factor mean the report is garbage
+constexpr float MaxSensitivityDeviation = 2.0f;
+
+static bool IsPlausible(float scale, float nominalScale) {
+    return std::isfinite(scale) && scale > nominalScale / MaxSensitivityDeviation && scale < nominalScale * MaxSensitivityDeviation;
+}
+
+/// Gyro axis from its bias and the readings at the reference rates, the minus reading is negative
+static bool CalibrateGyroAxis(int16_t bias, int16_t plus, int16_t minus, int32_t speed2x, float* outScale, float* outOffset) {
+    const int32_t range = std::abs(plus - bias) + std::abs(minus - bias);
+    if (range == 0)
+        return false;
+
+    const float scale = static_cast<float>(speed2x) / static_cast<float>(range);
+    if (!IsPlausible(scale, NominalMotionCalibration.gyroScale.pitch))
+        return false;
+    *outScale = scale;
+    *outOffset = -static_cast<float>(bias) * scale;
+    return true;
+}
+
+/// Accel axis from the readings at +1 g and -1 g, the bias being halfway between them
+static bool CalibrateAccelAxis(int16_t plus, int16_t minus, float* outScale, float* outOffset) {
+    const int32_t range = plus - minus;
+    if (range <= 0)
+        return false;
+
+    const float scale = 2.0f / static_cast<float>(range);
+    if (!IsPlausible(scale, NominalMotionCalibration.accelScale.x))
+        return false;
+    const float bias = static_cast<float>(plus) - static_cast<float>(range) / 2.0f;
+    *outScale = scale;
+    *outOffset = -bias * scale;
+    return true;
+}
+
+bool ParseCalibrationReport(const uint8_t* reportData, size_t reportSize, bool bluetooth, MotionCalibration* out) {
+    if (!reportData || !out || reportSize < sizeof(report::CalibrationReport) || reportData[0] != report::CALIBRATION_REPORT_ID)
+        return false;
+
+    // todo: big endian support
+    report::CalibrationReport calibration{};
+    std::memcpy(&calibration, reportData, sizeof(calibration));
+    if (bluetooth && Crc32(BluetoothFeatureCrcSeed, reportData, offsetof(report::CalibrationReport, crc), false) != calibration.crc)
+        return false;
+
+    MotionCalibration result{};
+    const int32_t speed2x = calibration.gyroSpeedPlus + calibration.gyroSpeedMinus;
+    const bool valid =
+        CalibrateGyroAxis(calibration.gyroPitchBias, calibration.gyroPitchPlus, calibration.gyroPitchMinus, speed2x, &result.gyroScale.pitch,
+                          &result.gyroOffset.pitch) &&
+        CalibrateGyroAxis(calibration.gyroYawBias, calibration.gyroYawPlus, calibration.gyroYawMinus, speed2x, &result.gyroScale.yaw, &result.gyroOffset.yaw) &&
+        CalibrateGyroAxis(calibration.gyroRollBias, calibration.gyroRollPlus, calibration.gyroRollMinus, speed2x, &result.gyroScale.roll,
+                          &result.gyroOffset.roll) &&
+        CalibrateAccelAxis(calibration.accelXPlus, calibration.accelXMinus, &result.accelScale.x, &result.accelOffset.x) &&
+        CalibrateAccelAxis(calibration.accelYPlus, calibration.accelYMinus, &result.accelScale.y, &result.accelOffset.y) &&
+        CalibrateAccelAxis(calibration.accelZPlus, calibration.accelZMinus, &result.accelScale.z, &result.accelOffset.z);
+    if (!valid)
+        return false;
+
+    *out = result;
+    return true;
+}
+
+} // namespace ds
@@ -1,8 +1,27 @@
 #include <Daisy/Crc32.hpp>
 
+#include <array>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define DS_CRC32_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define DS_CLMUL_TARGET
+#else
+#include <cpuid.h>
+#define DS_CLMUL_TARGET __attribute__((target("pclmul,sse4.1")))
+#endif
+#else
+#define DS_CRC32_X86 0
+#endif
+
 namespace ds {
 
-uint32_t Crc32Table[256] = {
+// Table kernel state is kept inverted, which is why every entry is xor-ed with 0xd202ef8d compared to the usual table,
+// the other kernels work on the regular state and invert on entry/exit
+static const uint32_t Crc32Table[256] = {
     0xd202ef8d, 0xa505df1b, 0x3c0c8ea1, 0x4b0bbe37, 0xd56f2b94, 0xa2681b02, 0x3b614ab8, 0x4c667a2e, 0xdcd967bf, 0xabde5729, 0x32d70693, 0x45d03605, 0xdbb4a3a6,
     0xacb39330, 0x35bac28a, 0x42bdf21c, 0xcfb5ffe9, 0xb8b2cf7f, 0x21bb9ec5, 0x56bcae53, 0xc8d83bf0, 0xbfdf0b66, 0x26d65adc, 0x51d16a4a, 0xc16e77db, 0xb669474d,
     0x2f6016f7, 0x58672661, 0xc603b3c2, 0xb1048354, 0x280dd2ee, 0x5f0ae278, 0xe96ccf45, 0x9e6bffd3, 0x762ae69,  0x70659eff, 0xee010b5c, 0x99063bca, 0xf6a70,
@@ -24,17 +43,228 @@ uint32_t Crc32Table[256] = {
     0x92dde4eb, 0xe5dad47d, 0x7bbe41de, 0xcb97148,  0x95b020f2, 0xe2b71064, 0x6fbf1d91, 0x18b82d07, 0x81b17cbd, 0xf6b64c2b, 0x68d2d988, 0x1fd5e91e, 0x86dcb8a4,
     0xf1db8832, 0x616495a3, 0x1663a535, 0x8f6af48f, 0xf86dc419, 0x660951ba, 0x110e612c, 0x88073096, 0xff000000};
 
-uint32_t Crc32(uint32_t startingValue, uint8_t* data, size_t dataSize, bool finalize) {
+using SliceTables = std::array<std::array<uint32_t, 256>, 16>;
+
+static constexpr SliceTables MakeSliceTables() {
+    SliceTables tables{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xedb88320 : 0);
+        }
+        tables[0][i] = crc;
+    }
+    for (size_t slice = 1; slice < tables.size(); slice++) {
+        for (uint32_t i = 0; i < 256; i++) {
+            const uint32_t previous = tables[slice - 1][i];
+            tables[slice][i] = (previous >> 8) ^ tables[0][previous & 0xff];
+        }
+    }
+    return tables;
+}
+
+static constexpr SliceTables Crc32SliceTables = MakeSliceTables();
+
+static uint32_t Load32(const uint8_t* data) {
     // todo: big endian support
-    uint32_t crc = startingValue;
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint32_t Crc32TableKernel(uint32_t crc, const uint8_t* data, size_t dataSize) {
     for (size_t i = 0; i < dataSize; i++) {
         uint8_t element = data[i];
         crc = (Crc32Table[(crc ^ element) & 0xff]) ^ (crc >> 8);
     }
+    return crc;
+}
+
+static uint32_t Crc32Tail(uint32_t crc, const uint8_t* data, size_t dataSize) {
+    const auto& table = Crc32SliceTables[0];
+    for (size_t i = 0; i < dataSize; i++) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static uint32_t Crc32Slice8Kernel(uint32_t crc, const uint8_t* data, size_t dataSize) {
+    const auto& t = Crc32SliceTables;
+    while (dataSize >= 8) {
+        const uint32_t one = Load32(data) ^ crc;
+        const uint32_t two = Load32(data + 4);
+        crc = t[7][one & 0xff] ^ t[6][(one >> 8) & 0xff] ^ t[5][(one >> 16) & 0xff] ^ t[4][one >> 24] ^ t[3][two & 0xff] ^ t[2][(two >> 8) & 0xff] ^
+              t[1][(two >> 16) & 0xff] ^ t[0][two >> 24];
+        data += 8;
+        dataSize -= 8;
+    }
+    return Crc32Tail(crc, data, dataSize);
+}
+
+static uint32_t Crc32Slice16Kernel(uint32_t crc, const uint8_t* data, size_t dataSize) {
+    const auto& t = Crc32SliceTables;
+    while (dataSize >= 16) {
+        const uint32_t one = Load32(data) ^ crc;
+        const uint32_t two = Load32(data + 4);
+        const uint32_t three = Load32(data + 8);
+        const uint32_t four = Load32(data + 12);
+        crc = t[15][one & 0xff] ^ t[14][(one >> 8) & 0xff] ^ t[13][(one >> 16) & 0xff] ^ t[12][one >> 24] ^ t[11][two & 0xff] ^ t[10][(two >> 8) & 0xff] ^
+              t[9][(two >> 16) & 0xff] ^ t[8][two >> 24] ^ t[7][three & 0xff] ^ t[6][(three >> 8) & 0xff] ^ t[5][(three >> 16) & 0xff] ^ t[4][three >> 24] ^
+              t[3][four & 0xff] ^ t[2][(four >> 8) & 0xff] ^ t[1][(four >> 16) & 0xff] ^ t[0][four >> 24];
+        data += 16;
+        dataSize -= 16;
+    }
+    return Crc32Slice8Kernel(crc, data, dataSize);
+}
+
+#if DS_CRC32_X86
+constexpr size_t ClmulMinimumSize = 64;
+
+// Folding constants from "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" (Intel),
+// for the reflected 0x04c11db7 polynomial
+alignas(16) static const uint64_t ClmulK1K2[2] = {0x0154442bd4, 0x01c6e41596};
+alignas(16) static const uint64_t ClmulK3K4[2] = {0x01751997d0, 0x00ccaa009e};
+alignas(16) static const uint64_t ClmulK5K0[2] = {0x0163cd6124, 0x0000000000};
+alignas(16) static const uint64_t ClmulPoly[2] = {0x01db710641, 0x01f7011641};
+
+DS_CLMUL_TARGET static inline __m128i ClmulLoad(const uint8_t* data) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)); }
+
+DS_CLMUL_TARGET static inline __m128i ClmulFold(__m128i value, __m128i next, __m128i constants) {
+    const __m128i low = _mm_clmulepi64_si128(value, constants, 0x00);
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(value, constants, 0x11), next), low);
+}
+
+/// Folds 16-byte blocks, dataSize must be at least 64 and a multiple of 16
+DS_CLMUL_TARGET static uint32_t Crc32ClmulBlocks(uint32_t crc, const uint8_t* data, size_t dataSize) {
+
+    __m128i x1 = _mm_xor_si128(ClmulLoad(data), _mm_cvtsi32_si128(static_cast<int>(crc)));
+    __m128i x2 = ClmulLoad(data + 0x10);
+    __m128i x3 = ClmulLoad(data + 0x20);
+    __m128i x4 = ClmulLoad(data + 0x30);
+    __m128i x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(ClmulK1K2));
+    data += 64;
+    dataSize -= 64;
+
+    // fold 4x128 bits in parallel
+    while (dataSize >= 64) {
+        x1 = ClmulFold(x1, ClmulLoad(data), x0);
+        x2 = ClmulFold(x2, ClmulLoad(data + 0x10), x0);
+        x3 = ClmulFold(x3, ClmulLoad(data + 0x20), x0);
+        x4 = ClmulFold(x4, ClmulLoad(data + 0x30), x0);
+        data += 64;
+        dataSize -= 64;
+    }
+
+    // fold into a single 128 bit value
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(ClmulK3K4));
+    x1 = ClmulFold(x1, x2, x0);
+    x1 = ClmulFold(x1, x3, x0);
+    x1 = ClmulFold(x1, x4, x0);
+    while (dataSize >= 16) {
+        x1 = ClmulFold(x1, ClmulLoad(data), x0);
+        data += 16;
+        dataSize -= 16;
+    }
+
+    // fold 128 bits to 64 bits
+    const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ClmulK5K0));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask), x0, 0x00), x2);
+
+    // barrett reduction to 32 bits
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(ClmulPoly));
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), x0, 0x10);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask), x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+static uint32_t Crc32ClmulKernel(uint32_t crc, const uint8_t* data, size_t dataSize) {
+    if (dataSize >= ClmulMinimumSize) {
+        const size_t blockSize = dataSize & ~static_cast<size_t>(15);
+        crc = Crc32ClmulBlocks(crc, data, blockSize);
+        data += blockSize;
+        dataSize -= blockSize;
+    }
+    return Crc32Slice16Kernel(crc, data, dataSize);
+}
+
+static bool CpuSupportsClmul() {
+    uint32_t ecx = 0;
+#if defined(_MSC_VER) && !defined(__clang__)
+    int registers[4]{};
+    __cpuid(registers, 1);
+    ecx = static_cast<uint32_t>(registers[2]);
+#else
+    uint32_t eax = 0, ebx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+#endif
+    constexpr uint32_t pclmulqdqBit = 1u << 1;
+    constexpr uint32_t sse41Bit = 1u << 19;
+    return (ecx & pclmulqdqBit) && (ecx & sse41Bit);
+}
+#endif
+
+bool IsCrc32KernelSupported(Crc32Kernel kernel) {
+    switch (kernel) {
+    case Crc32Kernel::Table:
+    case Crc32Kernel::Slice8:
+    case Crc32Kernel::Slice16:
+        return true;
+    case Crc32Kernel::Clmul:
+#if DS_CRC32_X86
+        return CpuSupportsClmul();
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+Crc32Kernel ActiveCrc32Kernel() {
+    static const Crc32Kernel kernel = IsCrc32KernelSupported(Crc32Kernel::Clmul) ? Crc32Kernel::Clmul : Crc32Kernel::Slice16;
+    return kernel;
+}
+
+uint32_t Crc32(Crc32Kernel kernel, uint32_t startingValue, const uint8_t* data, size_t dataSize, bool finalize) {
+    uint32_t crc = 0;
+    switch (kernel) {
+    case Crc32Kernel::Table:
+        crc = Crc32TableKernel(startingValue, data, dataSize);
+        break;
+    case Crc32Kernel::Slice8:
+        crc = ~Crc32Slice8Kernel(~startingValue, data, dataSize);
+        break;
+    case Crc32Kernel::Slice16:
+        crc = ~Crc32Slice16Kernel(~startingValue, data, dataSize);
+        break;
+    case Crc32Kernel::Clmul:
+#if DS_CRC32_X86
+        crc = ~Crc32ClmulKernel(~startingValue, data, dataSize);
+#else
+        crc = ~Crc32Slice16Kernel(~startingValue, data, dataSize);
+#endif
+        break;
+    }
     if (finalize) {
         crc = (crc ^ UINT32_MAX);
     }
     return crc;
 }
 
-} // namespace ds
\ No newline at end of file
+uint32_t Crc32(uint32_t startingValue, const uint8_t* data, size_t dataSize, bool finalize) {
+    return Crc32(ActiveCrc32Kernel(), startingValue, data, dataSize, finalize);
+}
+
+bool CheckBluetoothInputCrc(const uint8_t* reportData, size_t reportSize) {
+    if (reportSize < sizeof(uint32_t))
+        return false;
+    const size_t crcOffset = reportSize - sizeof(uint32_t);
+    return Crc32(BluetoothInputCrcSeed, reportData, crcOffset, false) == Load32(reportData + crcOffset);
+}
+
+} // namespace ds
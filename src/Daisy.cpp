@@ -1,7 +1,13 @@
 #include <Daisy/Crc32.hpp>
 #include <Daisy/Daisy.hpp>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace ds {
 
@@ -9,11 +15,254 @@ namespace ds {
 
 DaisyManager* DaisyManager::SInstance = nullptr;
 
+/// Input timing histograms of a controller, recorded by the reading threads without locking
+struct InputLatency {
+    LatencyHistogram interArrival;
+    LatencyHistogram readWait;
+    LatencyHistogram queueDelay;
+    LatencyHistogram delivery;
+};
+
+/// Input counters of a controller, written by whichever thread reads it
+struct InputCounters {
+    StatCounter reportsRead;
+    StatCounter reportsDiscarded;
+    StatCounter timeouts;
+    StatCounter queueFlushes;
+    StatCounter bytesReceived;
+};
+
+/// Window the fastest arrival is taken over, short enough to follow the drift between the host and controller clocks
+constexpr std::chrono::seconds ArrivalBaselineWindow(2);
+/// Gaps between reports longer than this restart the arrival tracking, e.g. after the controller stopped reporting
+constexpr std::chrono::seconds MaxArrivalGap(1);
+
+/// @brief Counters and arrival timing of the reads of a controller, owned by whichever thread reads it
+///
+/// The host time of every arrival minus the controller time of its sensor timestamp is the transport delay plus an
+/// unknown clock offset. The smallest difference seen over the last window stands in for the offset, the excess over
+/// it is the time the report got held up on the way.
+struct ReadTracker {
+    ReadTracker(InputLatency* latency, InputCounters* counters, LinkQualityMonitor* linkQuality)
+        : latency(latency), counters(counters), linkQuality(linkQuality) {}
+
+    InputLatency* latency;
+    InputCounters* counters;
+    LinkQualityMonitor* linkQuality;
+    /// Host time the latest report arrived at
+    std::chrono::steady_clock::time_point lastArrival{};
+    uint32_t lastSensorTimestamp = 0;
+    bool hasArrival = false;
+
+    std::chrono::steady_clock::time_point origin{};
+    /// Controller time since the origin, unwrapped
+    uint64_t sensorTicks = 0;
+    std::chrono::steady_clock::time_point windowStart{};
+    /// Smallest host minus controller time of the current and the previous window, us
+    int64_t windowMinOffset = 0;
+    int64_t previousWindowMinOffset = 0;
+};
+
+static int64_t Microseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+static void TrackArrival(ReadTracker* tracker, std::chrono::steady_clock::time_point arrival, uint32_t sensorTimestamp) {
+    const uint32_t ticks = sensorTimestamp - tracker->lastSensorTimestamp;
+    const auto maxGapTicks = static_cast<uint32_t>(SensorTimestampTicksPerSecond * MaxArrivalGap.count());
+    const bool restart = !tracker->hasArrival || arrival - tracker->lastArrival > MaxArrivalGap || ticks > maxGapTicks;
+    if (!restart) {
+        tracker->latency->interArrival.Record(Microseconds(arrival - tracker->lastArrival));
+    }
+    tracker->lastArrival = arrival;
+    tracker->lastSensorTimestamp = sensorTimestamp;
+    if (restart) {
+        tracker->hasArrival = true;
+        tracker->origin = arrival;
+        tracker->sensorTicks = 0;
+        tracker->windowStart = arrival;
+        tracker->windowMinOffset = 0;
+        tracker->previousWindowMinOffset = 0;
+        return;
+    }
+    // controllers that don't fill in the timestamp can't be correlated
+    if (ticks == 0)
+        return;
+
+    tracker->sensorTicks += ticks;
+    const auto sensorMicros = static_cast<int64_t>(static_cast<double>(tracker->sensorTicks) * 1e6 / SensorTimestampTicksPerSecond);
+    const int64_t offset = Microseconds(arrival - tracker->origin) - sensorMicros;
+    if (arrival - tracker->windowStart >= ArrivalBaselineWindow) {
+        tracker->previousWindowMinOffset = tracker->windowMinOffset;
+        tracker->windowMinOffset = offset;
+        tracker->windowStart = arrival;
+    }
+    tracker->windowMinOffset = std::min(tracker->windowMinOffset, offset);
+    tracker->latency->queueDelay.Record(offset - std::min(tracker->windowMinOffset, tracker->previousWindowMinOffset));
+}
+
+/// Input decoded by a background reader, with the time its report arrived at
+struct ReceivedInput {
+    ControllerInput input;
+    std::chrono::steady_clock::time_point arrival;
+};
+
+static void RecordDelivery(InputLatency* latency, std::chrono::steady_clock::time_point arrival) {
+    if constexpr (StatsEnabled) {
+        latency->delivery.Record(Microseconds(std::chrono::steady_clock::now() - arrival));
+    }
+}
+
+struct BackgroundReader {
+    explicit BackgroundReader(const BackgroundReaderSettings& settings) : ring(settings.ringDepth, settings.overflowPolicy) {}
+    ~BackgroundReader() {
+        running.Store(false, std::memory_order_release);
+        if (thread.joinable())
+            thread.join();
+    }
+
+    SpscRing<ReceivedInput> ring;
+    AtomicBool running = true;
+    std::thread thread;
+};
+
+struct HapticStreamer {
+    explicit HapticStreamer(const HapticStreamSettings& settings) : stream(settings) {}
+    ~HapticStreamer() {
+        running.Store(false, std::memory_order_release);
+        if (thread.joinable())
+            thread.join();
+    }
+
+    HapticStream stream;
+    AtomicBool running = true;
+    std::thread thread;
+};
+
+struct InputEventQueue {
+    InputEventQueue(InputEventSubscription subscription, uint32_t queueDepth) : detector(subscription), events(queueDepth) {}
+
+    InputEventDetector detector;
+    SpscRing<InputEvent> events;
+};
+
+struct TouchGestureQueue {
+    TouchGestureQueue(TouchGestureSettings settings, uint32_t queueDepth) : recognizer(settings), events(queueDepth) {}
+
+    TouchGestureRecognizer recognizer;
+    SpscRing<TouchGestureEvent> events;
+};
+
+/// Gaps between motion samples longer than this restart the integration, e.g. after the controller stopped reporting
+constexpr float MaxMotionSampleGap = 0.1f;
+
+struct MotionTracker {
+    MotionFusionSettings settings{};
+    MotionFusionState state{};
+    uint32_t lastSensorTimestamp = 0;
+    bool hasSensorTimestamp = false;
+};
+
+/// Destructive interference size, std::hardware_destructive_interference_size isn't available on every standard library
+constexpr size_t CacheLineSize = 64;
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4324) // structure was padded due to alignment specifier, which is the point
+#endif
+
+/// @brief Manager side record of a controller
+///
+/// Input and output state are guarded by their own locks on separate cache lines, so the input thread and the output
+/// thread of the same controller never wait on each other. Records of different controllers are separate allocations.
+/// A record is only deleted inside @see DaisyManager::Tick, which can't run while any call holds a record.
 struct ControllerCache {
+    report::HidReportProperties properties{};
+    /// Read once on connect and never changed afterwards, so it's read without locking
+    MotionCalibration calibration = NominalMotionCalibration;
+    /// Raw calibration feature report, kept for recordings started later, empty if it couldn't be read
+    std::vector<uint8_t> calibrationReport;
+    std::atomic<void*> userData{nullptr};
+    InputLatency latency;
+    InputCounters inputCounters;
+    /// Bluetooth frame checks, done by whichever thread reads the controller
+    LinkQualityMonitor linkQuality;
+
+    /// Guards the input state below
+    alignas(CacheLineSize) std::mutex inputMutex;
     ControllerInput cachedInputState{};
-    void* userData = nullptr;
+    std::unique_ptr<BackgroundReader> reader;
+    /// Tracks the reads not done by the background reader
+    ReadTracker readTracker{&latency, &inputCounters, &linkQuality};
+    std::unique_ptr<InputEventQueue> inputEvents;
+    std::unique_ptr<TouchGestureQueue> touchGestures;
+    std::optional<MotionTracker> motion;
+
+    /// Guards the output state below
+    alignas(CacheLineSize) std::mutex outputMutex;
+    OutputState outputState{};
+    OutputStats outputStats{};
+    StatCounter bytesSent;
+    StatCounter sendFailures;
+
+    /// Output waiting for the output budget, @see OutputSchedulerSettings
+    report::OutputReportData pendingOutput{};
+    bool hasPendingOutput = false;
+    std::chrono::steady_clock::time_point lastOutputTime{};
+    /// Send rate measurement window
+    std::chrono::steady_clock::time_point sendRateWindowStart{};
+    uint32_t sendRateWindowReports = 0;
+
+    /// Guards the haptic stream, writers only contend with starting and stopping it
+    std::mutex hapticsMutex;
+    std::unique_ptr<HapticStreamer> haptics;
 };
 
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+/// Set on the thread running @see DaisyManager::Tick, the connection callbacks run there while it owns the platform exclusively
+static thread_local bool TickingThread = false;
+
+/// @brief Keeps the controllers of the platform from being removed for the duration of a call
+///
+/// Not taken again on the ticking thread, so the connection callbacks can call back into the manager.
+class PlatformReadLock {
+public:
+    PlatformReadLock(std::shared_mutex& mutex, const AtomicBool& tickPending) : lock(mutex, std::defer_lock) {
+        if (TickingThread)
+            return;
+        // a pending tick goes first, callers arriving back to back could otherwise keep it waiting indefinitely
+        while (tickPending.Load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        lock.lock();
+    }
+
+private:
+    std::shared_lock<std::shared_mutex> lock;
+};
+
+/// Longest a wait for reports holds the platform lock at a time, ms
+constexpr uint32_t ReportWaitSliceMs = 2;
+
+constexpr std::chrono::seconds SendRateWindow(1);
+/// How long the bluetooth output budget can accumulate while idle
+constexpr std::chrono::milliseconds OutputBudgetBurst(100);
+
+static void UpdateSendRate(ControllerCache* cache, std::chrono::steady_clock::time_point now) {
+    const auto elapsed = now - cache->sendRateWindowStart;
+    if (elapsed < SendRateWindow)
+        return;
+
+    // a window start far in the past means nothing was sent for a while
+    const double seconds = std::chrono::duration<double>(elapsed < 2 * SendRateWindow ? elapsed : SendRateWindow).count();
+    cache->outputStats.sendRateHz = elapsed < 2 * SendRateWindow ? static_cast<float>(cache->sendRateWindowReports / seconds) : 0.0f;
+    cache->sendRateWindowStart = now;
+    cache->sendRateWindowReports = 0;
+}
+
 Result DaisyManager::Initialize() {
     if (SInstance) {
         return Result::OK;
@@ -31,127 +280,609 @@ Result DaisyManager::Initialize() {
 
 void DaisyManager::Shutdown() {
     if (SInstance) {
+        for (auto controller : SInstance->AvailableControllers()) {
+            SInstance->StopBackgroundReader(controller);
+            SInstance->StopHapticStream(controller);
+        }
         delete SInstance;
         SInstance = nullptr;
     }
 }
 
-void DaisyManager::Tick() { platform.Tick(); }
-
-const std::vector<ControllerHandle>& DaisyManager::AvailableControllers() const { return platform.GetConnectedControllers(); }
+void DaisyManager::Tick() {
+    {
+        // readers back off as soon as a tick is pending, otherwise they could keep the shared lock busy indefinitely
+        tickPending.Store(true, std::memory_order_release);
+        std::unique_lock lock(platformMutex);
+        tickPending.Store(false, std::memory_order_release);
 
-ControllerInput FromInputReport(const report::InputReportData report) {
-    // todo: big endian support
-    ControllerInput input{};
-    input.analog.leftStick = {report.x, report.y};
-    input.analog.rightStick = {report.z, report.rz};
-    input.analog.l2 = report.rx;
-    input.analog.r2 = report.ry;
+        TickingThread = true;
+        platform.Tick();
+        TickingThread = false;
+    }
+    PumpOutput();
+}
 
-    const auto actions = static_cast<PressedButtons>(report.buttons.buttons0 >> 4 & 0xf);
-    const auto triggers = static_cast<PressedButtons>((report.buttons.buttons1 & 0xf) << 4);
-    const auto front = static_cast<PressedButtons>(static_cast<uint16_t>(report.buttons.buttons1 & 0xf0) << 4);
-    const auto front2 = static_cast<PressedButtons>(static_cast<uint16_t>(report.buttons.buttons1 & 0x7) << 8);
-    input.buttons |= actions | triggers | front | front2;
+const std::vector<ControllerHandle>& DaisyManager::AvailableControllers() const { return platform.GetConnectedControllers(); }
 
-    HatSwitch hatSwitchFlags[] = {HatSwitch::Up,   HatSwitch::Up | HatSwitch::Right,  HatSwitch::Right, HatSwitch::Right | HatSwitch::Down,
-                                  HatSwitch::Down, HatSwitch::Down | HatSwitch::Left, HatSwitch::Left,  HatSwitch::Left | HatSwitch::Up};
-    if (report.buttons.GetHatSwitch() <= 7) {
-        input.hatSwitch = hatSwitchFlags[report.buttons.GetHatSwitch()];
-    }
+void DaisyManager::AvailableControllers(std::vector<ControllerHandle>* out) {
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    const auto& controllers = platform.GetConnectedControllers();
+    out->assign(controllers.begin(), controllers.end());
+}
 
-    input.gyro = {report.gyroPitch, report.gyroYaw, report.gyroRoll};
-    input.accel = {report.accelX, report.accelY, report.accelZ};
+static inline float CalibrateAxis(uint16_t raw, float scale, float offset) { return static_cast<int16_t>(raw) * scale + offset; }
 
-    const auto& rpoint1 = report.touchData.point1;
-    const auto& rpoint2 = report.touchData.point2;
-    input.touchData.point1 = {rpoint1.IsActive(), rpoint1.GetId(), {rpoint1.GetX(), rpoint1.GetY()}};
-    input.touchData.point2 = {rpoint2.IsActive(), rpoint2.GetId(), {rpoint2.GetX(), rpoint2.GetY()}};
+ControllerInput FromInputReport(InputReportView report, const MotionCalibration& calibration) {
+    ControllerInput input{};
+    input.analog.leftStick = report.LeftStick();
+    input.analog.rightStick = report.RightStick();
+    input.analog.l2 = report.L2();
+    input.analog.r2 = report.R2();
+    input.buttons = report.Buttons();
+    input.hatSwitch = report.GetHatSwitch();
+    input.gyro = report.Gyro();
+    input.accel = report.Accel();
+    input.angularVelocity = {CalibrateAxis(input.gyro.pitch, calibration.gyroScale.pitch, calibration.gyroOffset.pitch),
+                             CalibrateAxis(input.gyro.yaw, calibration.gyroScale.yaw, calibration.gyroOffset.yaw),
+                             CalibrateAxis(input.gyro.roll, calibration.gyroScale.roll, calibration.gyroOffset.roll)};
+    input.acceleration = {CalibrateAxis(input.accel.x, calibration.accelScale.x, calibration.accelOffset.x),
+                          CalibrateAxis(input.accel.y, calibration.accelScale.y, calibration.accelOffset.y),
+                          CalibrateAxis(input.accel.z, calibration.accelScale.z, calibration.accelOffset.z)};
+    input.sensorTimestamp = report.SensorTimestamp();
+    input.touchData.point1 = report.TouchPoint1();
+    input.touchData.point2 = report.TouchPoint2();
+    input.feedback = report.Feedback();
+    input.batteryData = report.Battery();
+    input.flags = report.Flags();
+    return input;
+}
 
-    input.feedback.l2 = report.leftTriggerFeedback;
-    input.feedback.r2 = report.rightTriggerFeedback;
+ControllerInput FromInputReport(const report::InputReportData& report, const MotionCalibration& calibration) {
+    return FromInputReport(InputReportView(report), calibration);
+}
 
-    input.batteryData.batteryLevel = report.batteryData.GetPercentage() * 10;
-    input.batteryData.isFullyCharged = report.batteryData.IsBatteryFull();
+using RawInputReport = std::array<uint8_t, BluetoothInputReportSize>;
 
-    SetFlags(input.flags, DeviceFlags::HeadphonesConnected, HasAnyFlag(report.deviceFlags, report::DeviceFlags::HeadphonesConnected));
-    SetFlags(input.flags, DeviceFlags::MicConnected, HasAnyFlag(report.deviceFlags, report::DeviceFlags::MicConnected));
-    SetFlags(input.flags, DeviceFlags::BatteryCharging, HasAnyFlag(report.deviceFlags, report::DeviceFlags::BatteryCharging));
+Result DaisyManager::ReadInputReport(ControllerHandle controller, const report::HidReportProperties& reportProperties, uint8_t* reportData,
+                                     InputReportView* out, ReadTracker* tracker, bool wait) {
+    const bool timed = StatsEnabled && tracker;
+    size_t readSize = 0;
+    const auto readStart = timed && wait ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+    Result res = wait ? platform.GetReport(controller, reportData, reportProperties.inputReportByteLength, &readSize)
+                      : platform.PollReport(controller, reportData, reportProperties.inputReportByteLength, &readSize);
+    if (res != Result::OK) {
+        if (tracker && res == Result::TIMEOUT) {
+            // polls end with a timeout whenever the queue is drained, only waiting reads count as timing out
+            if (wait) {
+                tracker->counters->timeouts.Add();
+                if constexpr (PlatformManager::FlushesQueueOnTimeout) {
+                    tracker->counters->queueFlushes.Add();
+                }
+            }
+        }
+        return res;
+    }
+    const auto readEnd = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+    if (timed && wait) {
+        tracker->latency->readWait.Record(Microseconds(readEnd - readStart));
+    }
+    if (tracker) {
+        tracker->counters->reportsRead.Add();
+        tracker->counters->bytesReceived.Add(readSize);
+    }
+    if (recorder.IsOpen()) {
+        recorder.RecordInput(static_cast<uint32_t>(controller.Index()), reportData, readSize);
+    }
+    if (reportProperties.inputReportByteLength == BluetoothInputReportSize && reportData[0] == report::BLUETOOTH_INPUT_REPORT_ID) {
+        const bool valid = tracker ? tracker->linkQuality->Process(reportData, readSize) : CheckBluetoothInputCrc(reportData, readSize);
+        if (!valid)
+            return Result::UNKNOWN_INPUT_REPORT;
+    }
 
-    return input;
+    res = InputReportView::FromRawReport(reportData, reportProperties.inputReportByteLength, out);
+    if (tracker && res == Result::UNKNOWN_INPUT_REPORT) {
+        tracker->counters->reportsDiscarded.Add();
+    }
+    if (timed && res == Result::OK) {
+        TrackArrival(tracker, readEnd, out->SensorTimestamp());
+    }
+    return res;
 }
 
-constexpr uint16_t USBInputReportSize = 64;
-constexpr uint16_t BluetoothInputReportSize = 78;
-
 Result DaisyManager::GetControllerData(ControllerHandle controller, ControllerInput* out) {
     if (!out)
         return Result::INVALID_PARAMETER;
 
+    PlatformReadLock platformLock(platformMutex, tickPending);
     report::HidReportProperties reportProperties{};
     Result res = platform.GetHidProperties(controller, &reportProperties);
     if (res != Result::OK)
         return res;
 
-    std::array<uint8_t, USBInputReportSize> usbReport{};
-    std::array<uint8_t, BluetoothInputReportSize> bluetoothReport{};
-    void* reportData = nullptr;
-    // todo: maybe make handling of this a virtual instead? evaluate performance impact
-    if (reportProperties.inputReportByteLength == USBInputReportSize) {
-        reportData = usbReport.data();
-    } else if (reportProperties.inputReportByteLength == BluetoothInputReportSize) {
-        reportData = bluetoothReport.data();
-    } else {
-        return Result::UNKNOWN_INPUT_REPORT;
+    void* userData = nullptr;
+    Result cacheResult = platform.GetUserData(controller, &userData);
+    auto* cache = cacheResult == Result::OK ? static_cast<ControllerCache*>(userData) : nullptr;
+    // reads of the same controller are serialized, so event detection sees its reports in order
+    std::unique_lock<std::mutex> inputLock;
+    if (cache) {
+        inputLock = std::unique_lock(cache->inputMutex);
+    }
+    if (cache && cache->reader) {
+        ConsumeBackgroundReader(cache);
+        *out = cache->cachedInputState;
+        return Result::OK;
     }
 
-    auto* hidReport = static_cast<report::HIDReport<uint8_t>*>(reportData);
-    size_t readSize = 0;
+    if (reportProperties.inputReportByteLength != USBInputReportSize && reportProperties.inputReportByteLength != BluetoothInputReportSize)
+        return Result::UNKNOWN_INPUT_REPORT;
+
+    RawInputReport reportData{};
+    InputReportView inputReport(reportData.data());
     for (int i = 0; i < MAX_REPORTS_PER_FRAME; i++) {
-        res = platform.GetReport(controller, reportData, reportProperties.inputReportByteLength, &readSize);
-        if (res != Result::OK)
-            return res;
-        if (hidReport->reportId == 1 || hidReport->reportId == 49) // for some reason you can get either id on bluetooth, report size still applies :/
+        res = ReadInputReport(controller, reportProperties, reportData.data(), &inputReport, cache ? &cache->readTracker : nullptr);
+        if (res != Result::UNKNOWN_INPUT_REPORT)
             break;
     }
 
-    void* userData;
-    Result cacheResult = platform.GetUserData(controller, &userData);
-    if (hidReport->reportId != 1 && hidReport->reportId != 49) {
-        if (cacheResult != Result::OK)
+    if (res == Result::UNKNOWN_INPUT_REPORT) {
+        if (!cache)
             return cacheResult;
-        *out = static_cast<ControllerCache*>(userData)->cachedInputState;
+        *out = cache->cachedInputState;
         return Result::OK;
     }
+    if (res != Result::OK)
+        return res;
 
-    report::InputReportData inputReport{};
-    if (reportProperties.inputReportByteLength == USBInputReportSize)
-        inputReport = static_cast<report::HIDReport<report::InputReportData>*>(reportData)->data;
-    else if (reportProperties.inputReportByteLength == BluetoothInputReportSize)
-        inputReport = static_cast<report::BluetoothInputReport*>(reportData)->data;
-    // no else clause here because higher clauses guard from other cases
+    if (!cache) {
+        *out = FromInputReport(inputReport);
+        return Result::OK;
+    }
+    ReceiveInput(cache, FromInputReport(inputReport, cache->calibration));
+    *out = cache->cachedInputState;
+
+    return Result::OK;
+}
+
+Result DaisyManager::PollControllerData(ControllerHandle controller, ControllerInput* out) {
+    if (!out)
+        return Result::INVALID_PARAMETER;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
 
-    ControllerInput input = FromInputReport(inputReport);
-    if (cacheResult == Result::OK) {
-        static_cast<ControllerCache*>(userData)->cachedInputState = input;
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard inputLock(cache->inputMutex);
+    const bool updated = DrainInput(controller, cache);
+    *out = cache->cachedInputState;
+    return updated ? Result::OK : Result::TIMEOUT;
+}
+
+Result DaisyManager::WaitForInput(uint32_t timeoutMs) { return WaitForReports(timeoutMs); }
+
+static void FillBatchSlot(InputBatch* batch, size_t slot, ControllerHandle controller, const ControllerInput& input, bool updated) {
+    const auto set = [slot](auto* array, auto value) {
+        if (array) {
+            array[slot] = value;
+        }
+    };
+
+    set(batch->controllers, controller);
+    set(batch->updated, static_cast<uint8_t>(updated));
+    set(batch->leftStickX, input.analog.leftStick.x);
+    set(batch->leftStickY, input.analog.leftStick.y);
+    set(batch->rightStickX, input.analog.rightStick.x);
+    set(batch->rightStickY, input.analog.rightStick.y);
+    set(batch->l2, input.analog.l2);
+    set(batch->r2, input.analog.r2);
+    set(batch->buttons, input.buttons);
+    set(batch->hatSwitch, input.hatSwitch);
+    set(batch->gyroPitch, input.gyro.pitch);
+    set(batch->gyroYaw, input.gyro.yaw);
+    set(batch->gyroRoll, input.gyro.roll);
+    set(batch->accelX, input.accel.x);
+    set(batch->accelY, input.accel.y);
+    set(batch->accelZ, input.accel.z);
+    set(batch->touch1Active, static_cast<uint8_t>(input.touchData.point1.isTouching));
+    set(batch->touch1X, input.touchData.point1.pos.x);
+    set(batch->touch1Y, input.touchData.point1.pos.y);
+    set(batch->touch2Active, static_cast<uint8_t>(input.touchData.point2.isTouching));
+    set(batch->touch2X, input.touchData.point2.pos.x);
+    set(batch->touch2Y, input.touchData.point2.pos.y);
+}
+
+Result DaisyManager::WaitForReports(uint32_t timeoutMs) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true) {
+        const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        const auto sliceMs = static_cast<uint32_t>(std::clamp<int64_t>(remaining, 0, ReportWaitSliceMs));
+
+        Result res = Result::TIMEOUT;
+        {
+            // released between slices, a tick that became pending meanwhile takes its turn there
+            PlatformReadLock platformLock(platformMutex, tickPending);
+            res = platform.WaitForReports(sliceMs);
+        }
+        if (res != Result::TIMEOUT || sliceMs == 0 || std::chrono::steady_clock::now() >= deadline)
+            return res;
+    }
+}
+
+Result DaisyManager::PollAll(InputBatch* batch, uint32_t timeoutMs) {
+    if (!batch)
+        return Result::INVALID_PARAMETER;
+
+    if (timeoutMs != 0) {
+        Result res = WaitForReports(timeoutMs);
+        if (res != Result::OK && res != Result::TIMEOUT)
+            return res;
+    }
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    const auto& controllers = platform.GetConnectedControllers();
+    batch->count = std::min(controllers.size(), batch->capacity);
+    if (batch->count == 0)
+        return Result::OK;
+
+    for (size_t slot = 0; slot < batch->count; slot++) {
+        const ControllerHandle controller = controllers[slot];
+        void* userData = nullptr;
+        if (platform.GetUserData(controller, &userData) != Result::OK) {
+            FillBatchSlot(batch, slot, controller, ControllerInput{}, false);
+            continue;
+        }
+
+        auto* cache = static_cast<ControllerCache*>(userData);
+        std::lock_guard inputLock(cache->inputMutex);
+        const bool updated = DrainInput(controller, cache);
+        FillBatchSlot(batch, slot, controller, cache->cachedInputState, updated);
+    }
+
+    return Result::OK;
+}
+
+/// Whether every report of the controller has to be decoded, rather than just the newest one
+static bool ReceivesEveryInput(const ControllerCache* cache) { return cache->inputEvents || cache->touchGestures || cache->motion; }
+
+static void TrackMotion(MotionTracker* tracker, ControllerInput* input) {
+    // the first sample only provides the timestamp to measure the next one from
+    const float dt = tracker->hasSensorTimestamp ? SensorTimestampDelta(tracker->lastSensorTimestamp, input->sensorTimestamp) : 0.0f;
+    tracker->lastSensorTimestamp = input->sensorTimestamp;
+    tracker->hasSensorTimestamp = true;
+    if (dt > 0.0f && dt <= MaxMotionSampleGap) {
+        UpdateMotionFusion(tracker->settings, ToMotionSample(*input, dt), &tracker->state);
+    }
+    input->orientation = tracker->state.orientation;
+}
+
+bool DaisyManager::DrainInput(ControllerHandle controller, ControllerCache* cache) {
+    if (cache->reader)
+        return ConsumeBackgroundReader(cache);
+
+    const auto& reportProperties = cache->properties;
+    if (reportProperties.inputReportByteLength != USBInputReportSize && reportProperties.inputReportByteLength != BluetoothInputReportSize)
+        return false;
+
+    // without event detection, gestures and motion fusion only the newest report matters, so the older ones are not decoded
+    // reports are read into alternating buffers, so the newest one survives a failed read after it
+    bool received = false;
+    std::array<RawInputReport, 2> reportData{};
+    size_t nextBuffer = 0;
+    InputReportView inputReport(reportData[0].data());
+    for (int i = 0; i < MAX_REPORTS_PER_FRAME; i++) {
+        InputReportView readReport(reportData[nextBuffer].data());
+        Result res = ReadInputReport(controller, reportProperties, reportData[nextBuffer].data(), &readReport, &cache->readTracker, false);
+        if (res == Result::OK) {
+            received = true;
+            inputReport = readReport;
+            nextBuffer ^= 1;
+            if (ReceivesEveryInput(cache)) {
+                ReceiveInput(cache, FromInputReport(inputReport, cache->calibration));
+            }
+        } else if (res != Result::UNKNOWN_INPUT_REPORT) {
+            break;
+        }
+    }
+
+    if (received && !ReceivesEveryInput(cache)) {
+        cache->cachedInputState = FromInputReport(inputReport, cache->calibration);
+    }
+    return received;
+}
+
+bool DaisyManager::ConsumeBackgroundReader(ControllerCache* cache) {
+    ReceivedInput received{};
+    if (!ReceivesEveryInput(cache)) {
+        if (!cache->reader->ring.PopLatest(&received))
+            return false;
+        cache->cachedInputState = received.input;
+        RecordDelivery(&cache->latency, received.arrival);
+        return true;
+    }
+
+    bool any = false;
+    while (cache->reader->ring.Pop(&received)) {
+        ReceiveInput(cache, received.input);
+        RecordDelivery(&cache->latency, received.arrival);
+        any = true;
+    }
+    return any;
+}
+
+void DaisyManager::ReceiveInput(ControllerCache* cache, ControllerInput input) {
+    if (cache->motion) {
+        TrackMotion(&*cache->motion, &input);
+    }
+    if (cache->inputEvents) {
+        cache->inputEvents->detector.Process(input, cache->inputEvents->events);
+    }
+    if (cache->touchGestures) {
+        cache->touchGestures->recognizer.Process(input, cache->touchGestures->events);
+    }
+    cache->cachedInputState = input;
+}
+
+Result DaisyManager::SubscribeInputEvents(ControllerHandle controller, InputEventSubscription subscription, uint32_t queueDepth) {
+    if (queueDepth == 0)
+        return Result::INVALID_PARAMETER;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard inputLock(cache->inputMutex);
+    cache->inputEvents = std::make_unique<InputEventQueue>(subscription, queueDepth);
+    return Result::OK;
+}
+
+Result DaisyManager::UnsubscribeInputEvents(ControllerHandle controller) {
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard inputLock(cache->inputMutex);
+    cache->inputEvents.reset();
+    return Result::OK;
+}
+
+Result DaisyManager::GetInputEvents(ControllerHandle controller, InputEvent* outEvents, size_t capacity, size_t* outCount) {
+    if (!outEvents || !outCount)
+        return Result::INVALID_PARAMETER;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard inputLock(cache->inputMutex);
+    *outCount = 0;
+    if (!cache->inputEvents)
+        return Result::OK;
+
+    while (*outCount < capacity && cache->inputEvents->events.Pop(&outEvents[*outCount])) {
+        (*outCount)++;
+    }
+    return Result::OK;
+}
+
+Result DaisyManager::SubscribeTouchGestures(ControllerHandle controller, TouchGestureSettings settings, uint32_t queueDepth) {
+    if (queueDepth == 0)
+        return Result::INVALID_PARAMETER;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard inputLock(cache->inputMutex);
+    cache->touchGestures = std::make_unique<TouchGestureQueue>(settings, queueDepth);
+    return Result::OK;
+}
+
+Result DaisyManager::UnsubscribeTouchGestures(ControllerHandle controller) {
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard inputLock(cache->inputMutex);
+    cache->touchGestures.reset();
+    return Result::OK;
+}
+
+Result DaisyManager::GetTouchGestures(ControllerHandle controller, TouchGestureEvent* outEvents, size_t capacity, size_t* outCount) {
+    if (!outEvents || !outCount)
+        return Result::INVALID_PARAMETER;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard inputLock(cache->inputMutex);
+    *outCount = 0;
+    if (!cache->touchGestures)
+        return Result::OK;
+
+    while (*outCount < capacity && cache->touchGestures->events.Pop(&outEvents[*outCount])) {
+        (*outCount)++;
     }
-    *out = input;
+    return Result::OK;
+}
 
+Result DaisyManager::EnableMotionFusion(ControllerHandle controller, MotionFusionSettings settings) {
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard inputLock(cache->inputMutex);
+    cache->motion.emplace();
+    cache->motion->settings = settings;
+    return Result::OK;
+}
+
+Result DaisyManager::DisableMotionFusion(ControllerHandle controller) {
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard inputLock(cache->inputMutex);
+    cache->motion.reset();
+    cache->cachedInputState.orientation = {1.0f, 0.0f, 0.0f, 0.0f};
     return Result::OK;
 }
 
+Result DaisyManager::StartBackgroundReader(ControllerHandle controller, BackgroundReaderSettings settings) {
+    if (settings.ringDepth == 0)
+        return Result::INVALID_PARAMETER;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    report::HidReportProperties reportProperties{};
+    res = platform.GetHidProperties(controller, &reportProperties);
+    if (res != Result::OK)
+        return res;
+
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard inputLock(cache->inputMutex);
+    cache->reader.reset();
+    cache->reader = std::make_unique<BackgroundReader>(settings);
+    // the reader takes over the bluetooth frame checks, reads through the cache can't happen while it runs
+    cache->reader->thread = std::thread(&DaisyManager::BackgroundReaderLoop, this, controller, reportProperties, cache->calibration,
+                                        ReadTracker(&cache->latency, &cache->inputCounters, &cache->linkQuality), cache->reader.get());
+    // the reader takes the reports, a wait for input must not wake up for them
+    return platform.SetReportsWaited(controller, false);
+}
+
+Result DaisyManager::StopBackgroundReader(ControllerHandle controller) {
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    // the reader thread never takes the input lock, so it can be joined while holding it
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard inputLock(cache->inputMutex);
+    cache->reader.reset();
+    return platform.SetReportsWaited(controller, true);
+}
+
+std::shared_lock<std::shared_mutex> DaisyManager::TryLockPlatform(const AtomicBool& running) {
+    // never block on the lock, the tick holding it might be waiting for this thread to exit
+    std::shared_lock lock(platformMutex, std::defer_lock);
+    while (tickPending.Load(std::memory_order_acquire) || !lock.try_lock()) {
+        if (!running.Load(std::memory_order_acquire))
+            break;
+        std::this_thread::yield();
+    }
+    return lock;
+}
+
+void DaisyManager::BackgroundReaderLoop(ControllerHandle controller, report::HidReportProperties reportProperties, MotionCalibration calibration,
+                                       ReadTracker tracker, BackgroundReader* reader) {
+    while (reader->running.Load(std::memory_order_acquire)) {
+        auto lock = TryLockPlatform(reader->running);
+        if (!lock.owns_lock())
+            return;
+
+        RawInputReport reportData{};
+        InputReportView inputReport(reportData.data());
+        Result res = ReadInputReport(controller, reportProperties, reportData.data(), &inputReport, &tracker);
+        lock.unlock();
+
+        if (res == Result::OK) {
+            reader->ring.Push({FromInputReport(inputReport, calibration), tracker.lastArrival});
+        } else if (res != Result::TIMEOUT && res != Result::UNKNOWN_INPUT_REPORT) {
+            // device errors mostly mean the controller is about to get removed, don't spin until the tick does so
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
 void CalculateCrc(report::BluetoothOutputReport& outputReport) {
     // todo: big endian support
-    uint32_t crc = Crc32(0xeada2d49, reinterpret_cast<uint8_t*>(&outputReport), offsetof(report::BluetoothOutputReport, crc), false);
+    uint32_t crc = Crc32(BluetoothOutputCrcSeed, reinterpret_cast<const uint8_t*>(&outputReport), offsetof(report::BluetoothOutputReport, crc), false);
     outputReport.crc = crc;
 }
 
 Result DaisyManager::SetControllerData(ControllerHandle controller, const ds::report::OutputReportData& data) {
+    PlatformReadLock platformLock(platformMutex, tickPending);
     report::HidReportProperties reportProperties{};
     Result res = platform.GetHidProperties(controller, &reportProperties);
     if (res != Result::OK)
         return res;
 
+    void* userData = nullptr;
+    auto* cache = platform.GetUserData(controller, &userData) == Result::OK ? static_cast<ControllerCache*>(userData) : nullptr;
+    if (!cache)
+        return TransmitOutput(controller, reportProperties, cache, data);
+
+    {
+        std::lock_guard outputLock(cache->outputMutex);
+        if (!IsOutputScheduled(reportProperties)) {
+            // output queued before the budget got lifted must not overwrite this one later
+            if (!cache->hasPendingOutput)
+                return TransmitOutput(controller, reportProperties, cache, data);
+            cache->hasPendingOutput = false;
+            cache->outputStats.queueDepth = 0;
+            return TransmitOutput(controller, reportProperties, cache, OutputState::Merge(cache->pendingOutput, data));
+        }
+
+        // latest wins, fields of older output that the newer one doesn't touch are kept
+        if (cache->hasPendingOutput) {
+            cache->pendingOutput = OutputState::Merge(cache->pendingOutput, data);
+            cache->outputStats.coalescedReports++;
+        } else {
+            cache->pendingOutput = data;
+            cache->hasPendingOutput = true;
+        }
+        cache->outputStats.queueDepth = 1;
+    }
+
+    // the scheduler locks controllers itself, after the scheduler lock
+    PumpPendingOutput();
+    return Result::OK;
+}
+
+Result DaisyManager::TransmitOutput(ControllerHandle controller, const report::HidReportProperties& reportProperties, ControllerCache* cache,
+                                    const report::OutputReportData& controllerData) {
+    report::OutputReportData data = controllerData;
+    if (cache && outputSuppression.Load(std::memory_order_relaxed)) {
+        data = cache->outputState.Diff(controllerData);
+        if (OutputState::IsEmpty(data)) {
+            cache->outputStats.suppressedReports++;
+            return Result::OK;
+        }
+    }
+
     report::HIDReport<report::OutputReportData> usbReport{};
     report::BluetoothOutputReport bluetoothReport{};
 
@@ -173,29 +904,391 @@ Result DaisyManager::SetControllerData(ControllerHandle controller, const ds::re
         reportSize = sizeof(bluetoothReport);
     }
 
-    return platform.SendReport(controller, reportPtr, reportSize);
+    Result res = platform.SendReport(controller, reportPtr, reportSize);
+    if (cache) {
+        if (res == Result::OK) {
+            cache->bytesSent.Add(reportSize);
+        } else {
+            cache->sendFailures.Add();
+        }
+    }
+    if (res == Result::OK && recorder.IsOpen()) {
+        recorder.RecordOutput(static_cast<uint32_t>(controller.Index()), reportPtr, reportSize);
+    }
+    if (res == Result::OK && cache) {
+        const auto now = std::chrono::steady_clock::now();
+        cache->outputState.Apply(data);
+        cache->outputStats.sentReports++;
+        cache->lastOutputTime = now;
+        UpdateSendRate(cache, now);
+        cache->sendRateWindowReports++;
+    }
+    return res;
+}
+
+bool DaisyManager::IsOutputScheduled(const report::HidReportProperties& reportProperties) const {
+    if (reportProperties.inputReportByteLength != BluetoothInputReportSize)
+        return false;
+    return outputScheduled.Load(std::memory_order_acquire);
+}
+
+void DaisyManager::SetOutputSchedulerSettings(OutputSchedulerSettings settings) {
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    {
+        std::lock_guard schedulerLock(outputSchedulerMutex);
+        outputSchedulerSettings = settings;
+        outputBudgetBytes = 0.0;
+        outputBudgetRefill = std::chrono::steady_clock::now();
+        outputScheduled.Store(settings.bluetoothBytesPerSecond != 0 || settings.bluetoothReportRateHz != 0, std::memory_order_release);
+    }
+
+    // output queued under the old settings goes out as soon as the new budget allows
+    PumpPendingOutput();
+}
+
+void DaisyManager::PumpOutput() {
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    PumpPendingOutput();
+}
+
+void DaisyManager::PumpPendingOutput() {
+    const auto& controllers = platform.GetConnectedControllers();
+    if (controllers.empty())
+        return;
+
+    std::lock_guard schedulerLock(outputSchedulerMutex);
+    const auto now = std::chrono::steady_clock::now();
+    constexpr double BluetoothReportBytes = sizeof(report::BluetoothOutputReport);
+    const uint32_t bytesPerSecond = outputSchedulerSettings.bluetoothBytesPerSecond;
+    if (bytesPerSecond != 0) {
+        const double burstBytes = std::max(BluetoothReportBytes, bytesPerSecond * std::chrono::duration<double>(OutputBudgetBurst).count());
+        outputBudgetBytes += bytesPerSecond * std::chrono::duration<double>(now - outputBudgetRefill).count();
+        outputBudgetBytes = std::min(outputBudgetBytes, burstBytes);
+    }
+    outputBudgetRefill = now;
+
+    const auto minimumInterval = outputSchedulerSettings.bluetoothReportRateHz != 0
+                                     ? std::chrono::duration<double>(1.0 / outputSchedulerSettings.bluetoothReportRateHz)
+                                     : std::chrono::duration<double>::zero();
+
+    const size_t controllerCount = controllers.size();
+    const size_t start = outputCursor % controllerCount;
+    for (size_t i = 0; i < controllerCount; i++) {
+        const size_t index = (start + i) % controllerCount;
+        const ControllerHandle controller = controllers[index];
+
+        void* userData = nullptr;
+        if (platform.GetUserData(controller, &userData) != Result::OK)
+            continue;
+        auto* cache = static_cast<ControllerCache*>(userData);
+        std::lock_guard outputLock(cache->outputMutex);
+        if (!cache->hasPendingOutput)
+            continue;
+        if (now - cache->lastOutputTime < minimumInterval)
+            continue;
+        if (bytesPerSecond != 0 && outputBudgetBytes < BluetoothReportBytes) {
+            // this controller is first in line once the budget refills
+            outputCursor = index;
+            return;
+        }
+
+        report::HidReportProperties reportProperties{};
+        if (platform.GetHidProperties(controller, &reportProperties) != Result::OK)
+            continue;
+
+        const uint64_t sentReports = cache->outputStats.sentReports;
+        // a failed send stays queued for the next pump, suppressed output counts as delivered
+        if (TransmitOutput(controller, reportProperties, cache, cache->pendingOutput) == Result::OK) {
+            cache->hasPendingOutput = false;
+            cache->outputStats.queueDepth = 0;
+        }
+        if (cache->outputStats.sentReports != sentReports) {
+            outputBudgetBytes -= BluetoothReportBytes;
+        }
+        outputCursor = index + 1;
+    }
+}
+
+Result DaisyManager::ResetOutputState(ControllerHandle controller) {
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard outputLock(cache->outputMutex);
+    cache->outputState.Reset();
+    return Result::OK;
+}
+
+Result DaisyManager::GetOutputStats(ControllerHandle controller, OutputStats* out) {
+    if (!out)
+        return Result::INVALID_PARAMETER;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard outputLock(cache->outputMutex);
+    UpdateSendRate(cache, std::chrono::steady_clock::now());
+    *out = cache->outputStats;
+    return Result::OK;
+}
+
+Result DaisyManager::StartHapticStream(ControllerHandle controller, HapticStreamSettings settings) {
+    if (settings.sampleRate == 0 || settings.channels == 0 || settings.channels > 2 || settings.bufferFrames < HapticPacketFrames)
+        return Result::INVALID_PARAMETER;
+    // a single written frame resamples into this many frames, a buffer too small for them would never take any
+    if ((HapticSampleRate + settings.sampleRate - 1) / settings.sampleRate > settings.bufferFrames)
+        return Result::INVALID_PARAMETER;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    if (cache->properties.inputReportByteLength != BluetoothInputReportSize)
+        return Result::INVALID_PARAMETER;
+
+    std::lock_guard hapticsLock(cache->hapticsMutex);
+    cache->haptics.reset();
+    cache->haptics = std::make_unique<HapticStreamer>(settings);
+    cache->haptics->thread = std::thread(&DaisyManager::HapticStreamLoop, this, controller, cache, cache->haptics.get());
+    return Result::OK;
+}
+
+Result DaisyManager::StopHapticStream(ControllerHandle controller) {
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    // the stream thread never takes the haptics lock, so it can be joined while holding it
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard hapticsLock(cache->hapticsMutex);
+    cache->haptics.reset();
+    return Result::OK;
+}
+
+Result DaisyManager::WriteHapticSamples(ControllerHandle controller, const int16_t* samples, size_t frames, size_t* outWritten) {
+    if ((!samples && frames != 0) || !outWritten)
+        return Result::INVALID_PARAMETER;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard hapticsLock(cache->hapticsMutex);
+    if (!cache->haptics)
+        return Result::INVALID_PARAMETER;
+    *outWritten = cache->haptics->stream.Write(samples, frames);
+    return Result::OK;
+}
+
+Result DaisyManager::GetHapticStreamStats(ControllerHandle controller, HapticStreamStats* out) {
+    if (!out)
+        return Result::INVALID_PARAMETER;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    auto* cache = static_cast<ControllerCache*>(controllerCache);
+    std::lock_guard hapticsLock(cache->hapticsMutex);
+    if (!cache->haptics)
+        return Result::INVALID_PARAMETER;
+    cache->haptics->stream.Stats(out);
+    return Result::OK;
+}
+
+/// Packets a stream thread that fell behind catches up on, anything older is skipped instead of sent in a burst
+constexpr uint32_t MaxHapticPacketsBehind = 4;
+
+void DaisyManager::HapticStreamLoop(ControllerHandle controller, ControllerCache* cache, HapticStreamer* streamer) {
+    report::BluetoothHapticsReport report{};
+    auto deadline = std::chrono::steady_clock::now();
+    while (streamer->running.Load(std::memory_order_acquire)) {
+        std::this_thread::sleep_until(deadline);
+        deadline += HapticPacketInterval;
+        const auto now = std::chrono::steady_clock::now();
+        if (now - deadline > MaxHapticPacketsBehind * HapticPacketInterval) {
+            deadline = now;
+        }
+        if (!streamer->stream.NextPacket(&report))
+            continue;
+
+        auto lock = TryLockPlatform(streamer->running);
+        if (!lock.owns_lock())
+            return;
+
+        Result res = platform.SendReport(controller, &report, sizeof(report));
+        if (res == Result::OK && recorder.IsOpen()) {
+            recorder.RecordOutput(static_cast<uint32_t>(controller.Index()), &report, sizeof(report));
+        }
+        {
+            std::lock_guard outputLock(cache->outputMutex);
+            if (res == Result::OK) {
+                cache->bytesSent.Add(sizeof(report));
+            } else {
+                cache->sendFailures.Add();
+            }
+        }
+    }
+}
+
+static void AddStats(const ControllerCache* cache, ControllerStats* out) {
+    out->reportsRead += cache->inputCounters.reportsRead.Load();
+    out->reportsDiscarded += cache->inputCounters.reportsDiscarded.Load();
+    out->timeouts += cache->inputCounters.timeouts.Load();
+    out->queueFlushes += cache->inputCounters.queueFlushes.Load();
+    out->bytesReceived += cache->inputCounters.bytesReceived.Load();
+    out->bytesSent += cache->bytesSent.Load();
+    out->sendFailures += cache->sendFailures.Load();
+}
+
+Result DaisyManager::GetStats(ControllerHandle controller, ControllerStats* out) {
+    if (!out)
+        return Result::INVALID_PARAMETER;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    *out = ControllerStats{};
+    AddStats(static_cast<ControllerCache*>(controllerCache), out);
+    return Result::OK;
+}
+
+void DaisyManager::GetGlobalStats(GlobalStats* out) {
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    // counters of disconnected controllers were added up when they disconnected, which only happens while ticking
+    *out = globalStats;
+    for (auto controller : platform.GetConnectedControllers()) {
+        void* userData = nullptr;
+        if (platform.GetUserData(controller, &userData) == Result::OK) {
+            AddStats(static_cast<ControllerCache*>(userData), &out->controllers);
+        }
+    }
+}
+
+Result DaisyManager::GetLinkQuality(ControllerHandle controller, LinkQuality* out) {
+    if (!out)
+        return Result::INVALID_PARAMETER;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    static_cast<ControllerCache*>(controllerCache)->linkQuality.Snapshot(out);
+    return Result::OK;
+}
+
+Result DaisyManager::GetLatencyStats(ControllerHandle controller, LatencyStats* out) {
+    if (!out)
+        return Result::INVALID_PARAMETER;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    const auto& latency = static_cast<ControllerCache*>(controllerCache)->latency;
+    latency.interArrival.Snapshot(&out->interArrival);
+    latency.readWait.Snapshot(&out->readWait);
+    latency.queueDelay.Snapshot(&out->queueDelay);
+    latency.delivery.Snapshot(&out->delivery);
+    return Result::OK;
+}
+
+Result DaisyManager::ResetLatencyStats(ControllerHandle controller) {
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    auto& latency = static_cast<ControllerCache*>(controllerCache)->latency;
+    latency.interArrival.Reset();
+    latency.readWait.Reset();
+    latency.queueDelay.Reset();
+    latency.delivery.Reset();
+    return Result::OK;
+}
+
+Result DaisyManager::GetMotionCalibration(ControllerHandle controller, MotionCalibration* out) {
+    if (!out)
+        return Result::INVALID_PARAMETER;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    void* controllerCache = nullptr;
+    Result res = platform.GetUserData(controller, &controllerCache);
+    if (res != Result::OK)
+        return res;
+
+    *out = static_cast<ControllerCache*>(controllerCache)->calibration;
+    return Result::OK;
 }
 
 Result DaisyManager::GetUserData(ControllerHandle controller, void** outUserData) {
     if (!outUserData)
         return Result::INVALID_PARAMETER;
 
+    PlatformReadLock platformLock(platformMutex, tickPending);
     void* controllerCache = nullptr;
     Result res = platform.GetUserData(controller, &controllerCache);
     if (res != Result::OK)
         return res;
 
-    *outUserData = static_cast<ControllerCache*>(controllerCache)->userData;
+    *outUserData = static_cast<ControllerCache*>(controllerCache)->userData.load(std::memory_order_acquire);
     return Result::OK;
 }
 
 Result DaisyManager::SetUserData(ControllerHandle controller, void* userData) {
+    PlatformReadLock platformLock(platformMutex, tickPending);
     void* controllerCache = nullptr;
     Result res = platform.GetUserData(controller, &controllerCache);
     if (res != Result::OK)
         return res;
 
-    static_cast<ControllerCache*>(controllerCache)->userData = userData;
+    static_cast<ControllerCache*>(controllerCache)->userData.store(userData, std::memory_order_release);
+    return Result::OK;
+}
+
+Result DaisyManager::StartRecording(const char* path) {
+    Result res = recorder.Open(path);
+    if (res != Result::OK)
+        return res;
+
+    PlatformReadLock platformLock(platformMutex, tickPending);
+    for (auto controller : platform.GetConnectedControllers()) {
+        void* userData = nullptr;
+        if (platform.GetUserData(controller, &userData) != Result::OK)
+            continue;
+
+        const auto* cache = static_cast<ControllerCache*>(userData);
+        const auto controllerId = static_cast<uint32_t>(controller.Index());
+        recorder.RecordConnected(controllerId, cache->properties);
+        if (!cache->calibrationReport.empty()) {
+            recorder.RecordFeatureReport(controllerId, cache->calibrationReport.data(), cache->calibrationReport.size());
+        }
+    }
     return Result::OK;
 }
 
@@ -207,8 +1300,34 @@ void DaisyManager::SendInitialReport(ControllerHandle controller) {
     SetControllerData(controller, initialReport);
 }
 
+void DaisyManager::ReadCalibration(ControllerHandle controller, ControllerCache* cache) {
+    // feature reads are padded to the largest feature report of the device on some platforms
+    std::array<uint8_t, 128> reportData{};
+    reportData[0] = report::CALIBRATION_REPORT_ID;
+    size_t readSize = 0;
+    if (platform.GetFeatureReport(controller, reportData.data(), reportData.size(), &readSize) != Result::OK)
+        return;
+
+    cache->calibrationReport.assign(reportData.begin(), reportData.begin() + std::min(readSize, sizeof(report::CalibrationReport)));
+    const bool bluetooth = cache->properties.inputReportByteLength == BluetoothInputReportSize;
+    ParseCalibrationReport(cache->calibrationReport.data(), cache->calibrationReport.size(), bluetooth, &cache->calibration);
+}
+
 void DaisyManager::OnControllerConnected(ControllerHandle controller) {
-    platform.SetUserData(controller, new ControllerCache{});
+    if constexpr (StatsEnabled) {
+        globalStats.connections++;
+    }
+    auto* cache = new ControllerCache{};
+    platform.GetHidProperties(controller, &cache->properties);
+    ReadCalibration(controller, cache);
+    platform.SetUserData(controller, cache);
+    if (recorder.IsOpen()) {
+        const auto controllerId = static_cast<uint32_t>(controller.Index());
+        recorder.RecordConnected(controllerId, cache->properties);
+        if (!cache->calibrationReport.empty()) {
+            recorder.RecordFeatureReport(controllerId, cache->calibrationReport.data(), cache->calibrationReport.size());
+        }
+    }
     SendInitialReport(controller);
 
     if (connectedCallback) {
@@ -217,11 +1336,21 @@ void DaisyManager::OnControllerConnected(ControllerHandle controller) {
 }
 
 void DaisyManager::OnControllerDisconnected(ControllerHandle controller) {
+    if constexpr (StatsEnabled) {
+        globalStats.disconnections++;
+    }
+    if (recorder.IsOpen()) {
+        recorder.RecordDisconnected(static_cast<uint32_t>(controller.Index()));
+    }
+
     void* userData = nullptr;
     void* setUserData = nullptr;
     if (platform.GetUserData(controller, &userData) == Result::OK) {
         auto* cache = static_cast<ControllerCache*>(userData);
-        setUserData = cache->userData;
+        cache->reader.reset();
+        cache->haptics.reset();
+        AddStats(cache, &globalStats.controllers);
+        setUserData = cache->userData.load(std::memory_order_acquire);
         delete cache;
     }
 
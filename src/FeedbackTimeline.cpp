@@ -0,0 +1,236 @@
+#include <Daisy/FeedbackTimeline.hpp>
+
+#include <algorithm>
+
+using namespace ds::report;
+
+namespace ds {
+
+/// Longest time @see FeedbackTimeline::Advance catches up on, us
+constexpr uint64_t MaxPendingUs = 100000;
+/// Highest tick rate, ticks are at least 1 us apart
+constexpr uint32_t MaxRateHz = 1000000;
+
+template <typename Keyframe>
+static void InsertKeyframe(std::vector<Keyframe>& keyframes, const Keyframe& keyframe) {
+    const auto position =
+        std::upper_bound(keyframes.begin(), keyframes.end(), keyframe.timeMs, [](uint32_t timeMs, const Keyframe& other) { return timeMs < other.timeMs; });
+    keyframes.insert(position, keyframe);
+}
+
+/// Moves a cursor to the latest keyframe at or before a time, starting over if the time went back (a loop)
+template <typename Keyframe>
+static const Keyframe* Seek(const std::vector<Keyframe>& keyframes, uint32_t& cursor, uint64_t timeUs) {
+    if (keyframes[cursor].timeMs * 1000ull > timeUs) {
+        cursor = 0;
+    }
+    while (cursor + 1 < keyframes.size() && keyframes[cursor + 1].timeMs * 1000ull <= timeUs) {
+        cursor++;
+    }
+    // nothing to drive before the first keyframe
+    return keyframes[cursor].timeMs * 1000ull <= timeUs ? &keyframes[cursor] : nullptr;
+}
+
+FeedbackEffect& FeedbackEffect::AddKeyframe(FeedbackTrack track, uint32_t timeMs, uint8_t value, Interpolation interpolation) {
+    if (track == FeedbackTrack::PlayerLeds) {
+        interpolation = Interpolation::Step;
+    }
+    InsertKeyframe(tracks[static_cast<size_t>(track)], FeedbackKeyframe{timeMs, value, interpolation});
+    durationMs = std::max(durationMs, timeMs);
+    return *this;
+}
+
+FeedbackEffect& FeedbackEffect::AddLightbarKeyframe(uint32_t timeMs, Color<uint8_t> color, Interpolation interpolation) {
+    AddKeyframe(FeedbackTrack::LightbarRed, timeMs, color.r, interpolation);
+    AddKeyframe(FeedbackTrack::LightbarGreen, timeMs, color.g, interpolation);
+    return AddKeyframe(FeedbackTrack::LightbarBlue, timeMs, color.b, interpolation);
+}
+
+FeedbackEffect& FeedbackEffect::AddTriggerKeyframe(TriggerSide side, uint32_t timeMs, TriggerData data) {
+    InsertKeyframe(triggers[static_cast<size_t>(side)], TriggerKeyframe{timeMs, data});
+    durationMs = std::max(durationMs, timeMs);
+    return *this;
+}
+
+FeedbackEffect& FeedbackEffect::SetLooping(bool looping) {
+    this->looping = looping;
+    return *this;
+}
+
+FeedbackTimeline::FeedbackTimeline(FeedbackTimelineSettings settings)
+    : settings(settings), tickUs(1000000 / std::clamp<uint32_t>(settings.rateHz, 1, MaxRateHz)), mixes(settings.controllerSlots),
+      outputs(settings.controllerSlots) {
+    instances.Reserve(settings.instanceCapacity);
+    ended.reserve(settings.instanceCapacity);
+}
+
+FeedbackEffectId FeedbackTimeline::AddEffect(const FeedbackEffect& effect) {
+    effects.push_back(effect);
+    return static_cast<FeedbackEffectId>(effects.size() - 1);
+}
+
+Result FeedbackTimeline::Play(FeedbackEffectId effect, uint32_t controllerSlot, uint8_t priority, FeedbackInstanceHandle* out) {
+    if (effect >= effects.size() || controllerSlot >= settings.controllerSlots || instances.Size() >= settings.instanceCapacity)
+        return Result::INVALID_PARAMETER;
+
+    FeedbackInstance instance{};
+    instance.effect = effect;
+    instance.controllerSlot = controllerSlot;
+    instance.priority = priority;
+    instance.serial = nextSerial++;
+    const auto handle = instances.Add(std::move(instance));
+    if (out) {
+        *out = handle;
+    }
+    return Result::OK;
+}
+
+void FeedbackTimeline::Stop(FeedbackInstanceHandle instance) {
+    if (instances.Contains(instance)) {
+        instances.Remove(instance);
+    }
+}
+
+void FeedbackTimeline::StopAll(uint32_t controllerSlot) {
+    ended.clear();
+    for (const auto [handle, instance] : instances) {
+        if (instance.controllerSlot == controllerSlot) {
+            ended.push_back(handle);
+        }
+    }
+    for (const auto handle : ended) {
+        instances.Remove(handle);
+    }
+    ended.clear();
+}
+
+uint32_t FeedbackTimeline::Advance(std::chrono::microseconds elapsed) {
+    pendingUs = std::min(pendingUs + static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 0)), std::max(MaxPendingUs, tickUs));
+    uint32_t ticks = 0;
+    while (pendingUs >= tickUs) {
+        Tick();
+        pendingUs -= tickUs;
+        ticks++;
+    }
+    return ticks;
+}
+
+void FeedbackTimeline::Tick() {
+    for (auto& mix : mixes) {
+        mix.values = {};
+        mix.owners = {};
+        mix.triggerOwners = {};
+    }
+
+    ended.clear();
+    for (auto [handle, instance] : instances) {
+        Evaluate(instance, mixes[instance.controllerSlot]);
+
+        const FeedbackEffect& effect = effects[instance.effect];
+        const uint64_t durationUs = effect.durationMs * 1000ull;
+        instance.timeUs += tickUs;
+        if (effect.looping) {
+            instance.timeUs = durationUs != 0 ? instance.timeUs % durationUs : 0;
+        } else if (instance.timeUs >= durationUs + tickUs) {
+            // the tick at or past the end held the last keyframes, the tracks get released in the next one
+            ended.push_back(handle);
+        }
+    }
+    for (const auto handle : ended) {
+        instances.Remove(handle);
+    }
+
+    for (size_t slot = 0; slot < mixes.size(); slot++) {
+        BuildOutput(mixes[slot], outputs[slot]);
+    }
+}
+
+void FeedbackTimeline::Evaluate(FeedbackInstance& instance, SlotMix& mix) const {
+    const FeedbackEffect& effect = effects[instance.effect];
+    const uint64_t timeUs = instance.timeUs;
+    const uint64_t owner = (static_cast<uint64_t>(instance.priority) + 1) << 56 | instance.serial;
+
+    for (size_t track = 0; track < FeedbackTrackCount; track++) {
+        const auto& keyframes = effect.tracks[track];
+        if (keyframes.empty())
+            continue;
+        const FeedbackKeyframe* keyframe = Seek(keyframes, instance.trackCursors[track], timeUs);
+        if (!keyframe)
+            continue;
+
+        float value = keyframe->value;
+        const size_t next = instance.trackCursors[track] + 1;
+        if (next < keyframes.size() && keyframe->interpolation != Interpolation::Step) {
+            const uint64_t startUs = keyframe->timeMs * 1000ull;
+            float t = static_cast<float>(timeUs - startUs) / static_cast<float>(keyframes[next].timeMs * 1000ull - startUs);
+            if (keyframe->interpolation == Interpolation::Smooth) {
+                t = t * t * (3.0f - 2.0f * t);
+            }
+            value += (static_cast<float>(keyframes[next].value) - value) * t;
+        }
+        const auto byte = static_cast<uint8_t>(value + 0.5f);
+
+        if (track == static_cast<size_t>(FeedbackTrack::LeftMotor) || track == static_cast<size_t>(FeedbackTrack::RightMotor)) {
+            mix.values[track] = std::max(mix.values[track], byte);
+            mix.owners[track] = 1;
+        } else if (owner > mix.owners[track]) {
+            mix.values[track] = byte;
+            mix.owners[track] = owner;
+        }
+    }
+
+    for (size_t side = 0; side < 2; side++) {
+        const auto& keyframes = effect.triggers[side];
+        if (keyframes.empty())
+            continue;
+        const TriggerKeyframe* keyframe = Seek(keyframes, instance.triggerCursors[side], timeUs);
+        if (keyframe && owner > mix.triggerOwners[side]) {
+            mix.triggers[side] = keyframe->data;
+            mix.triggerOwners[side] = owner;
+        }
+    }
+}
+
+void FeedbackTimeline::BuildOutput(SlotMix& mix, OutputReportData& output) const {
+    output = {};
+    const auto driven = [&mix](FeedbackTrack track) { return mix.owners[static_cast<size_t>(track)] != 0; };
+    const auto value = [&mix](FeedbackTrack track) { return mix.values[static_cast<size_t>(track)]; };
+
+    // same flags as @see OutputBuilder, a motor that isn't driven while the other one is stays off
+    const bool motorsDriven = driven(FeedbackTrack::LeftMotor) || driven(FeedbackTrack::RightMotor);
+    if (motorsDriven || mix.motorsDriven) {
+        output.flags1 |= ChangeFlags1::EnableHaptics;
+        output.flags2 |= ChangeFlags2::MotorPowerChange;
+        output.leftMotor = value(FeedbackTrack::LeftMotor);
+        output.rightMotor = value(FeedbackTrack::RightMotor);
+    }
+    mix.motorsDriven = motorsDriven;
+
+    // unlike @see OutputBuilder::SetLedColor this leaves the player leds alone
+    if (driven(FeedbackTrack::LightbarRed) || driven(FeedbackTrack::LightbarGreen) || driven(FeedbackTrack::LightbarBlue)) {
+        output.flags2 |= ChangeFlags2::ToggleLedStrips;
+        output.lightbarColor = {value(FeedbackTrack::LightbarRed), value(FeedbackTrack::LightbarGreen), value(FeedbackTrack::LightbarBlue)};
+    }
+    if (driven(FeedbackTrack::PlayerLeds)) {
+        output.flags2 |= ChangeFlags2::TogglePlayerIndicator;
+        output.playerLedFlags = static_cast<PlayerLedFlags>(value(FeedbackTrack::PlayerLeds));
+    }
+
+    constexpr std::array<ChangeFlags1, 2> TriggerFlags = {ChangeFlags1::LeftTriggerEffects, ChangeFlags1::RightTriggerEffects};
+    for (size_t side = 0; side < 2; side++) {
+        const bool triggerDriven = mix.triggerOwners[side] != 0;
+        if (!triggerDriven && !mix.triggersDriven[side])
+            continue;
+
+        TriggerData data{};
+        data.mode = TriggerMode::Off;
+        if (triggerDriven) {
+            data = mix.triggers[side];
+        }
+        output.flags1 |= TriggerFlags[side];
+        (side == 0 ? output.leftTrigger : output.rightTrigger) = data;
+        mix.triggersDriven[side] = triggerDriven;
+    }
+}
+
+} // namespace ds
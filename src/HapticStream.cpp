@@ -0,0 +1,114 @@
+#include <Daisy/Crc32.hpp>
+#include <Daisy/HapticStream.hpp>
+#include <Daisy/Stats.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace ds {
+
+/// Playback enable bits of the config packet, the meaning of the individual bits is unknown
+constexpr uint8_t HapticsConfig[7] = {0xfe, 0x00, 0x00, 0x00, 0x00, 0xff, 0x00};
+
+static int8_t ToSample(int32_t value) { return static_cast<int8_t>(value >> 8); }
+
+HapticStream::HapticStream(const HapticStreamSettings& settings) : settings(settings), ring(settings.bufferFrames, OverflowPolicy::DropNewest) {
+    if (settings.sampleRate < HapticSampleRate) {
+        maxFramesPerWrite = (HapticSampleRate + settings.sampleRate - 1) / settings.sampleRate;
+    }
+    this->settings.prebufferFrames = std::min<uint32_t>(settings.prebufferFrames, static_cast<uint32_t>(ring.Capacity()));
+}
+
+size_t HapticStream::Write(const int16_t* samples, size_t frames) {
+    const size_t channels = settings.channels;
+    for (size_t frame = 0; frame < frames; frame++) {
+        // the ring only gets emptier meanwhile, so whatever fits now can't be dropped
+        if (ring.Capacity() - ring.Size() < maxFramesPerWrite)
+            return frame;
+
+        const int16_t* sample = samples + frame * channels;
+        Resample(sample[0], sample[channels - 1]);
+    }
+    return frames;
+}
+
+void HapticStream::Resample(int32_t left, int32_t right) {
+    const uint32_t rate = settings.sampleRate;
+    if (rate >= HapticSampleRate) {
+        // every resampled frame is the average of the frames written during it
+        sumLeft += left;
+        sumRight += right;
+        summed++;
+        phase += HapticSampleRate;
+        if (phase >= rate) {
+            const auto count = static_cast<int32_t>(summed);
+            ring.Push({ToSample(sumLeft / count), ToSample(sumRight / count)});
+            sumLeft = 0;
+            sumRight = 0;
+            summed = 0;
+            phase -= rate;
+        }
+        return;
+    }
+
+    // resampled frames between the previous and this frame are interpolated from the two
+    while (phase < HapticSampleRate) {
+        const auto weight = static_cast<int32_t>(phase);
+        const int32_t resampledLeft = previousLeft + (left - previousLeft) * weight / static_cast<int32_t>(HapticSampleRate);
+        const int32_t resampledRight = previousRight + (right - previousRight) * weight / static_cast<int32_t>(HapticSampleRate);
+        ring.Push({ToSample(resampledLeft), ToSample(resampledRight)});
+        phase += rate;
+    }
+    phase -= HapticSampleRate;
+    previousLeft = left;
+    previousRight = right;
+}
+
+bool HapticStream::NextPacket(report::BluetoothHapticsReport* out) {
+    if (!playing) {
+        if (ring.Size() < settings.prebufferFrames || ring.Size() == 0)
+            return false;
+        playing = true;
+    }
+
+    std::memset(out, 0, sizeof(*out));
+    out->reportId = report::BLUETOOTH_HAPTICS_REPORT_ID;
+    out->tag = static_cast<uint8_t>(sequence++ << 4);
+    out->configPacketId = report::HAPTICS_CONFIG_PACKET_ID;
+    out->configPacketFlags = report::HAPTICS_PACKET_SIZED;
+    out->configPacketLength = sizeof(out->config);
+    std::memcpy(out->config, HapticsConfig, sizeof(HapticsConfig));
+    out->samplesPacketId = report::HAPTICS_SAMPLES_PACKET_ID;
+    out->samplesPacketFlags = report::HAPTICS_PACKET_SIZED;
+    out->samplesPacketLength = sizeof(out->samples);
+
+    uint32_t frames = 0;
+    HapticFrame frame{};
+    while (frames < HapticPacketFrames && ring.Pop(&frame)) {
+        out->samples[2 * frames] = frame.left;
+        out->samples[2 * frames + 1] = frame.right;
+        frames++;
+    }
+    // the rest of the report stays silent
+    if (frames < HapticPacketFrames) {
+        playing = false;
+        IncrementRelaxed(underruns, 1);
+        IncrementRelaxed(silentFrames, HapticPacketFrames - frames);
+    }
+
+    // todo: big endian support
+    out->crc = Crc32(BluetoothOutputCrcSeed, reinterpret_cast<const uint8_t*>(out), offsetof(report::BluetoothHapticsReport, crc), false);
+    IncrementRelaxed(packets, 1);
+    return true;
+}
+
+void HapticStream::Stats(HapticStreamStats* out) const {
+    out->bufferedFrames = static_cast<uint32_t>(ring.Size());
+    out->capacityFrames = static_cast<uint32_t>(ring.Capacity());
+    out->fillLevel = static_cast<float>(out->bufferedFrames) / static_cast<float>(out->capacityFrames);
+    out->underruns = underruns.load(std::memory_order_relaxed);
+    out->silentFrames = silentFrames.load(std::memory_order_relaxed);
+    out->packets = packets.load(std::memory_order_relaxed);
+}
+
+} // namespace ds
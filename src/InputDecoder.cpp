@@ -0,0 +1,429 @@
+#include <Daisy/InputDecoder.hpp>
+#include <Daisy/InputReportView.hpp>
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define DS_INPUT_DECODE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define DS_SSE41_TARGET
+#define DS_AVX2_TARGET
+#else
+#include <cpuid.h>
+#define DS_SSE41_TARGET __attribute__((target("sse4.1")))
+#define DS_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#else
+#define DS_INPUT_DECODE_X86 0
+#endif
+
+namespace ds {
+
+using report::InputReportData;
+
+constexpr size_t ReportStride = sizeof(InputReportData);
+
+// the vector kernels load 4 bytes per field group, little endian like the report:
+//   sticks:  [ x | y | z | rz ]               buttons: [ buttons0 | buttons1 | buttons2 | unk ]
+//   motion0: [ gyroPitch | gyroYaw ]          motion1: [ gyroRoll | accelX ]        motion2: [ accelY | accelZ ]
+//   touch:   [ id | x0 | x1 | y1 ]
+constexpr size_t SticksOffset = offsetof(InputReportData, x);
+constexpr size_t TriggersOffset = offsetof(InputReportData, rx);
+constexpr size_t ButtonsOffset = offsetof(InputReportData, buttons);
+constexpr size_t Motion0Offset = offsetof(InputReportData, gyroPitch);
+constexpr size_t Motion1Offset = offsetof(InputReportData, gyroRoll);
+constexpr size_t Motion2Offset = offsetof(InputReportData, accelY);
+constexpr size_t SensorTimestampOffset = offsetof(InputReportData, sensorTimestamp);
+constexpr size_t Touch1Offset = offsetof(InputReportData, touchData) + offsetof(report::TouchData, point1);
+constexpr size_t Touch2Offset = offsetof(InputReportData, touchData) + offsetof(report::TouchData, point2);
+static_assert(Touch2Offset + sizeof(uint32_t) <= ReportStride, "field loads must stay inside the report");
+
+static void DecodeScalar(const uint8_t* reports, size_t first, size_t reportCount, const InputColumns& out) {
+    for (size_t i = first; i < reportCount; i++) {
+        const InputReportView report(reports + i * ReportStride);
+        if (out.leftStickX)
+            out.leftStickX[i] = report.LeftStick().x;
+        if (out.leftStickY)
+            out.leftStickY[i] = report.LeftStick().y;
+        if (out.rightStickX)
+            out.rightStickX[i] = report.RightStick().x;
+        if (out.rightStickY)
+            out.rightStickY[i] = report.RightStick().y;
+        if (out.l2)
+            out.l2[i] = report.L2();
+        if (out.r2)
+            out.r2[i] = report.R2();
+        if (out.buttons)
+            out.buttons[i] = report.Buttons();
+        if (out.hatSwitch)
+            out.hatSwitch[i] = report.GetHatSwitch();
+        if (out.gyroPitch)
+            out.gyroPitch[i] = report.Gyro().pitch;
+        if (out.gyroYaw)
+            out.gyroYaw[i] = report.Gyro().yaw;
+        if (out.gyroRoll)
+            out.gyroRoll[i] = report.Gyro().roll;
+        if (out.accelX)
+            out.accelX[i] = report.Accel().x;
+        if (out.accelY)
+            out.accelY[i] = report.Accel().y;
+        if (out.accelZ)
+            out.accelZ[i] = report.Accel().z;
+        if (out.sensorTimestamp)
+            out.sensorTimestamp[i] = report.SensorTimestamp();
+        if (out.touch1Active)
+            out.touch1Active[i] = static_cast<uint8_t>(report.TouchPoint1().isTouching);
+        if (out.touch1Id)
+            out.touch1Id[i] = report.TouchPoint1().id;
+        if (out.touch1X)
+            out.touch1X[i] = report.TouchPoint1().pos.x;
+        if (out.touch1Y)
+            out.touch1Y[i] = report.TouchPoint1().pos.y;
+        if (out.touch2Active)
+            out.touch2Active[i] = static_cast<uint8_t>(report.TouchPoint2().isTouching);
+        if (out.touch2Id)
+            out.touch2Id[i] = report.TouchPoint2().id;
+        if (out.touch2X)
+            out.touch2X[i] = report.TouchPoint2().pos.x;
+        if (out.touch2Y)
+            out.touch2Y[i] = report.TouchPoint2().pos.y;
+    }
+}
+
+#if DS_INPUT_DECODE_X86
+// hat switch values 0..=7 to @see HatSwitch flags, released (8) and invalid values map to none
+#define DS_HAT_SWITCH_TABLE 0x1, 0x3, 0x2, 0x6, 0x4, 0xc, 0x8, 0x9, 0, 0, 0, 0, 0, 0, 0, 0
+
+static bool AnyColumn(const void* a, const void* b = nullptr, const void* c = nullptr, const void* d = nullptr) { return a || b || c || d; }
+
+// Sse41: a field group of 8 reports is held in two vectors of 4 dwords
+
+struct Sse41Lanes {
+    __m128i lo;
+    __m128i hi;
+};
+
+DS_SSE41_TARGET static inline __m128i Sse41Load4(const uint8_t* field) {
+    int32_t values[4];
+    for (size_t i = 0; i < 4; i++) {
+        std::memcpy(&values[i], field + i * ReportStride, sizeof(int32_t));
+    }
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+}
+
+DS_SSE41_TARGET static inline Sse41Lanes Sse41Load(const uint8_t* field) { return {Sse41Load4(field), Sse41Load4(field + 4 * ReportStride)}; }
+
+DS_SSE41_TARGET static inline Sse41Lanes Sse41Extract(Sse41Lanes lanes, int shift, int32_t mask) {
+    const __m128i maskVector = _mm_set1_epi32(mask);
+    return {_mm_and_si128(_mm_srli_epi32(lanes.lo, shift), maskVector), _mm_and_si128(_mm_srli_epi32(lanes.hi, shift), maskVector)};
+}
+
+DS_SSE41_TARGET static inline __m128i Sse41Bytes(Sse41Lanes lanes) {
+    const __m128i words = _mm_packus_epi32(lanes.lo, lanes.hi);
+    return _mm_packus_epi16(words, words);
+}
+
+DS_SSE41_TARGET static inline void Sse41Store8(void* out, Sse41Lanes lanes) { _mm_storel_epi64(static_cast<__m128i*>(out), Sse41Bytes(lanes)); }
+
+DS_SSE41_TARGET static inline void Sse41Store16(void* out, Sse41Lanes lanes) {
+    _mm_storeu_si128(static_cast<__m128i*>(out), _mm_packus_epi32(lanes.lo, lanes.hi));
+}
+
+DS_SSE41_TARGET static inline void Sse41Store32(void* out, Sse41Lanes lanes) {
+    _mm_storeu_si128(static_cast<__m128i*>(out), lanes.lo);
+    _mm_storeu_si128(static_cast<__m128i*>(out) + 1, lanes.hi);
+}
+
+DS_SSE41_TARGET static inline void Sse41StoreTouch(size_t i, const uint8_t* field, uint8_t* active, uint8_t* id, uint16_t* x, uint16_t* y) {
+    if (!AnyColumn(active, id, x, y))
+        return;
+    const Sse41Lanes touch = Sse41Load(field);
+    if (active) {
+        const Sse41Lanes inverted = {_mm_xor_si128(touch.lo, _mm_set1_epi32(-1)), _mm_xor_si128(touch.hi, _mm_set1_epi32(-1))};
+        Sse41Store8(active + i, Sse41Extract(inverted, 7, 0x1));
+    }
+    if (id)
+        Sse41Store8(id + i, Sse41Extract(touch, 0, 0x7f));
+    if (x)
+        Sse41Store16(x + i, Sse41Extract(touch, 8, 0xfff));
+    if (y)
+        Sse41Store16(y + i, Sse41Extract(touch, 20, 0xfff));
+}
+
+DS_SSE41_TARGET static size_t DecodeSse41(const uint8_t* reports, size_t reportCount, const InputColumns& out) {
+    constexpr size_t BlockSize = 8;
+    const __m128i hatSwitchTable = _mm_setr_epi8(DS_HAT_SWITCH_TABLE);
+
+    size_t i = 0;
+    for (; i + BlockSize <= reportCount; i += BlockSize) {
+        const uint8_t* block = reports + i * ReportStride;
+        if (AnyColumn(out.leftStickX, out.leftStickY, out.rightStickX, out.rightStickY)) {
+            const Sse41Lanes sticks = Sse41Load(block + SticksOffset);
+            if (out.leftStickX)
+                Sse41Store8(out.leftStickX + i, Sse41Extract(sticks, 0, 0xff));
+            if (out.leftStickY)
+                Sse41Store8(out.leftStickY + i, Sse41Extract(sticks, 8, 0xff));
+            if (out.rightStickX)
+                Sse41Store8(out.rightStickX + i, Sse41Extract(sticks, 16, 0xff));
+            if (out.rightStickY)
+                Sse41Store8(out.rightStickY + i, Sse41Extract(sticks, 24, 0xff));
+        }
+        if (AnyColumn(out.l2, out.r2)) {
+            const Sse41Lanes triggers = Sse41Load(block + TriggersOffset);
+            if (out.l2)
+                Sse41Store8(out.l2 + i, Sse41Extract(triggers, 0, 0xff));
+            if (out.r2)
+                Sse41Store8(out.r2 + i, Sse41Extract(triggers, 8, 0xff));
+        }
+        if (AnyColumn(out.buttons, out.hatSwitch)) {
+            const Sse41Lanes buttons = Sse41Load(block + ButtonsOffset);
+            // the button bits are already in @see PressedButtons order, just offset by the hat switch nibble
+            if (out.buttons)
+                Sse41Store16(out.buttons + i, Sse41Extract(buttons, 4, 0x7fff));
+            if (out.hatSwitch)
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out.hatSwitch + i), _mm_shuffle_epi8(hatSwitchTable, Sse41Bytes(Sse41Extract(buttons, 0, 0xf))));
+        }
+        if (AnyColumn(out.gyroPitch, out.gyroYaw)) {
+            const Sse41Lanes motion = Sse41Load(block + Motion0Offset);
+            if (out.gyroPitch)
+                Sse41Store16(out.gyroPitch + i, Sse41Extract(motion, 0, 0xffff));
+            if (out.gyroYaw)
+                Sse41Store16(out.gyroYaw + i, Sse41Extract(motion, 16, 0xffff));
+        }
+        if (AnyColumn(out.gyroRoll, out.accelX)) {
+            const Sse41Lanes motion = Sse41Load(block + Motion1Offset);
+            if (out.gyroRoll)
+                Sse41Store16(out.gyroRoll + i, Sse41Extract(motion, 0, 0xffff));
+            if (out.accelX)
+                Sse41Store16(out.accelX + i, Sse41Extract(motion, 16, 0xffff));
+        }
+        if (AnyColumn(out.accelY, out.accelZ)) {
+            const Sse41Lanes motion = Sse41Load(block + Motion2Offset);
+            if (out.accelY)
+                Sse41Store16(out.accelY + i, Sse41Extract(motion, 0, 0xffff));
+            if (out.accelZ)
+                Sse41Store16(out.accelZ + i, Sse41Extract(motion, 16, 0xffff));
+        }
+        if (out.sensorTimestamp)
+            Sse41Store32(out.sensorTimestamp + i, Sse41Load(block + SensorTimestampOffset));
+        Sse41StoreTouch(i, block + Touch1Offset, out.touch1Active, out.touch1Id, out.touch1X, out.touch1Y);
+        Sse41StoreTouch(i, block + Touch2Offset, out.touch2Active, out.touch2Id, out.touch2X, out.touch2Y);
+    }
+    return i;
+}
+
+// Avx2: a field group of 16 reports is gathered into two vectors of 8 dwords
+
+struct Avx2Lanes {
+    __m256i lo;
+    __m256i hi;
+};
+
+DS_AVX2_TARGET static inline Avx2Lanes Avx2Gather(const uint8_t* field) {
+    const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int32_t>(ReportStride)));
+    const __m256i offsetsHi = _mm256_add_epi32(offsets, _mm256_set1_epi32(static_cast<int32_t>(8 * ReportStride)));
+    const auto* base = reinterpret_cast<const int*>(field);
+    return {_mm256_i32gather_epi32(base, offsets, 1), _mm256_i32gather_epi32(base, offsetsHi, 1)};
+}
+
+DS_AVX2_TARGET static inline Avx2Lanes Avx2Extract(Avx2Lanes lanes, int shift, int32_t mask) {
+    const __m256i maskVector = _mm256_set1_epi32(mask);
+    return {_mm256_and_si256(_mm256_srli_epi32(lanes.lo, shift), maskVector), _mm256_and_si256(_mm256_srli_epi32(lanes.hi, shift), maskVector)};
+}
+
+/// Packs to 16 words in report order, packus interleaves the 128-bit halves of both inputs
+DS_AVX2_TARGET static inline __m256i Avx2Words(Avx2Lanes lanes) { return _mm256_permute4x64_epi64(_mm256_packus_epi32(lanes.lo, lanes.hi), 0xd8); }
+
+DS_AVX2_TARGET static inline __m128i Avx2Bytes(Avx2Lanes lanes) {
+    const __m256i words = Avx2Words(lanes);
+    return _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+}
+
+DS_AVX2_TARGET static inline void Avx2Store8(void* out, Avx2Lanes lanes) { _mm_storeu_si128(static_cast<__m128i*>(out), Avx2Bytes(lanes)); }
+
+DS_AVX2_TARGET static inline void Avx2Store16(void* out, Avx2Lanes lanes) { _mm256_storeu_si256(static_cast<__m256i*>(out), Avx2Words(lanes)); }
+
+DS_AVX2_TARGET static inline void Avx2Store32(void* out, Avx2Lanes lanes) {
+    _mm256_storeu_si256(static_cast<__m256i*>(out), lanes.lo);
+    _mm256_storeu_si256(static_cast<__m256i*>(out) + 1, lanes.hi);
+}
+
+DS_AVX2_TARGET static inline void Avx2StoreTouch(size_t i, const uint8_t* field, uint8_t* active, uint8_t* id, uint16_t* x, uint16_t* y) {
+    if (!AnyColumn(active, id, x, y))
+        return;
+    const Avx2Lanes touch = Avx2Gather(field);
+    if (active) {
+        const __m256i ones = _mm256_set1_epi32(-1);
+        Avx2Store8(active + i, Avx2Extract({_mm256_xor_si256(touch.lo, ones), _mm256_xor_si256(touch.hi, ones)}, 7, 0x1));
+    }
+    if (id)
+        Avx2Store8(id + i, Avx2Extract(touch, 0, 0x7f));
+    if (x)
+        Avx2Store16(x + i, Avx2Extract(touch, 8, 0xfff));
+    if (y)
+        Avx2Store16(y + i, Avx2Extract(touch, 20, 0xfff));
+}
+
+DS_AVX2_TARGET static size_t DecodeAvx2(const uint8_t* reports, size_t reportCount, const InputColumns& out) {
+    constexpr size_t BlockSize = 16;
+    const __m128i hatSwitchTable = _mm_setr_epi8(DS_HAT_SWITCH_TABLE);
+
+    size_t i = 0;
+    for (; i + BlockSize <= reportCount; i += BlockSize) {
+        const uint8_t* block = reports + i * ReportStride;
+        if (AnyColumn(out.leftStickX, out.leftStickY, out.rightStickX, out.rightStickY)) {
+            const Avx2Lanes sticks = Avx2Gather(block + SticksOffset);
+            if (out.leftStickX)
+                Avx2Store8(out.leftStickX + i, Avx2Extract(sticks, 0, 0xff));
+            if (out.leftStickY)
+                Avx2Store8(out.leftStickY + i, Avx2Extract(sticks, 8, 0xff));
+            if (out.rightStickX)
+                Avx2Store8(out.rightStickX + i, Avx2Extract(sticks, 16, 0xff));
+            if (out.rightStickY)
+                Avx2Store8(out.rightStickY + i, Avx2Extract(sticks, 24, 0xff));
+        }
+        if (AnyColumn(out.l2, out.r2)) {
+            const Avx2Lanes triggers = Avx2Gather(block + TriggersOffset);
+            if (out.l2)
+                Avx2Store8(out.l2 + i, Avx2Extract(triggers, 0, 0xff));
+            if (out.r2)
+                Avx2Store8(out.r2 + i, Avx2Extract(triggers, 8, 0xff));
+        }
+        if (AnyColumn(out.buttons, out.hatSwitch)) {
+            const Avx2Lanes buttons = Avx2Gather(block + ButtonsOffset);
+            if (out.buttons)
+                Avx2Store16(out.buttons + i, Avx2Extract(buttons, 4, 0x7fff));
+            if (out.hatSwitch)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out.hatSwitch + i), _mm_shuffle_epi8(hatSwitchTable, Avx2Bytes(Avx2Extract(buttons, 0, 0xf))));
+        }
+        if (AnyColumn(out.gyroPitch, out.gyroYaw)) {
+            const Avx2Lanes motion = Avx2Gather(block + Motion0Offset);
+            if (out.gyroPitch)
+                Avx2Store16(out.gyroPitch + i, Avx2Extract(motion, 0, 0xffff));
+            if (out.gyroYaw)
+                Avx2Store16(out.gyroYaw + i, Avx2Extract(motion, 16, 0xffff));
+        }
+        if (AnyColumn(out.gyroRoll, out.accelX)) {
+            const Avx2Lanes motion = Avx2Gather(block + Motion1Offset);
+            if (out.gyroRoll)
+                Avx2Store16(out.gyroRoll + i, Avx2Extract(motion, 0, 0xffff));
+            if (out.accelX)
+                Avx2Store16(out.accelX + i, Avx2Extract(motion, 16, 0xffff));
+        }
+        if (AnyColumn(out.accelY, out.accelZ)) {
+            const Avx2Lanes motion = Avx2Gather(block + Motion2Offset);
+            if (out.accelY)
+                Avx2Store16(out.accelY + i, Avx2Extract(motion, 0, 0xffff));
+            if (out.accelZ)
+                Avx2Store16(out.accelZ + i, Avx2Extract(motion, 16, 0xffff));
+        }
+        if (out.sensorTimestamp)
+            Avx2Store32(out.sensorTimestamp + i, Avx2Gather(block + SensorTimestampOffset));
+        Avx2StoreTouch(i, block + Touch1Offset, out.touch1Active, out.touch1Id, out.touch1X, out.touch1Y);
+        Avx2StoreTouch(i, block + Touch2Offset, out.touch2Active, out.touch2Id, out.touch2X, out.touch2Y);
+    }
+    return i;
+}
+
+static void Cpuid(uint32_t leaf, uint32_t registers[4]) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int values[4]{};
+    __cpuidex(values, static_cast<int>(leaf), 0);
+    for (size_t i = 0; i < 4; i++) {
+        registers[i] = static_cast<uint32_t>(values[i]);
+    }
+#else
+    if (!__get_cpuid_count(leaf, 0, &registers[0], &registers[1], &registers[2], &registers[3])) {
+        registers[0] = registers[1] = registers[2] = registers[3] = 0;
+    }
+#endif
+}
+
+static bool CpuSupportsSse41() {
+    uint32_t registers[4]{};
+    Cpuid(1, registers);
+    constexpr uint32_t sse41Bit = 1u << 19;
+    return registers[2] & sse41Bit;
+}
+
+static bool CpuSupportsAvx2() {
+    uint32_t registers[4]{};
+    Cpuid(1, registers);
+    constexpr uint32_t osxsaveBit = 1u << 27;
+    constexpr uint32_t avxBit = 1u << 28;
+    if (!(registers[2] & osxsaveBit) || !(registers[2] & avxBit))
+        return false;
+
+    // the os has to save the ymm registers on context switches as well
+#if defined(_MSC_VER) && !defined(__clang__)
+    const uint64_t enabledState = _xgetbv(0);
+#else
+    uint32_t eax = 0, edx = 0;
+    __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    const uint64_t enabledState = static_cast<uint64_t>(edx) << 32 | eax;
+#endif
+    constexpr uint64_t xmmYmmState = 0x6;
+    if ((enabledState & xmmYmmState) != xmmYmmState)
+        return false;
+
+    Cpuid(7, registers);
+    constexpr uint32_t avx2Bit = 1u << 5;
+    return registers[1] & avx2Bit;
+}
+#endif
+
+bool IsInputDecodeKernelSupported(InputDecodeKernel kernel) {
+    switch (kernel) {
+    case InputDecodeKernel::Scalar:
+        return true;
+    case InputDecodeKernel::Sse41:
+#if DS_INPUT_DECODE_X86
+        return CpuSupportsSse41();
+#else
+        return false;
+#endif
+    case InputDecodeKernel::Avx2:
+#if DS_INPUT_DECODE_X86
+        return CpuSupportsAvx2();
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+InputDecodeKernel ActiveInputDecodeKernel() {
+    static const InputDecodeKernel kernel = IsInputDecodeKernelSupported(InputDecodeKernel::Avx2)    ? InputDecodeKernel::Avx2
+                                            : IsInputDecodeKernelSupported(InputDecodeKernel::Sse41) ? InputDecodeKernel::Sse41
+                                                                                                     : InputDecodeKernel::Scalar;
+    return kernel;
+}
+
+void DecodeInputReports(InputDecodeKernel kernel, const report::InputReportData* reports, size_t reportCount, const InputColumns& out) {
+    const auto* reportBytes = reinterpret_cast<const uint8_t*>(reports);
+    size_t decoded = 0;
+#if DS_INPUT_DECODE_X86
+    switch (kernel) {
+    case InputDecodeKernel::Scalar:
+        break;
+    case InputDecodeKernel::Sse41:
+        decoded = DecodeSse41(reportBytes, reportCount, out);
+        break;
+    case InputDecodeKernel::Avx2:
+        decoded = DecodeAvx2(reportBytes, reportCount, out);
+        break;
+    }
+#else
+    (void)kernel;
+#endif
+    // reports that don't fill a whole block
+    DecodeScalar(reportBytes, decoded, reportCount, out);
+}
+
+void DecodeInputReports(const report::InputReportData* reports, size_t reportCount, const InputColumns& out) {
+    DecodeInputReports(ActiveInputDecodeKernel(), reports, reportCount, out);
+}
+
+} // namespace ds
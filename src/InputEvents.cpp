@@ -0,0 +1,91 @@
+#include <Daisy/InputEvents.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+namespace ds {
+
+constexpr size_t AxisCount = 6;
+/// Axes before this one are stick axes
+constexpr size_t StickAxisCount = 4;
+
+static std::array<uint8_t, AxisCount> AxisValues(const ControllerInput& input) {
+    return {input.analog.leftStick.x, input.analog.leftStick.y, input.analog.rightStick.x, input.analog.rightStick.y, input.analog.l2, input.analog.r2};
+}
+
+uint8_t StickDeflection(uint8_t value) { return static_cast<uint8_t>(std::min(2 * std::abs(value - 128), 255)); }
+
+/// Values the thresholds apply to, the deflection for stick axes and the raw value for triggers
+static std::array<uint8_t, AxisCount> AxisLevels(const std::array<uint8_t, AxisCount>& values) {
+    std::array<uint8_t, AxisCount> levels = values;
+    for (size_t i = 0; i < StickAxisCount; i++) {
+        levels[i] = StickDeflection(values[i]);
+    }
+    return levels;
+}
+
+void InputEventDetector::Process(const ControllerInput& input, SpscRing<InputEvent>& events) {
+    const auto axisValues = AxisValues(input);
+    const auto axisLevels = AxisLevels(axisValues);
+    if (!hasPrevious) {
+        previousButtons = input.buttons;
+        previousHatSwitch = input.hatSwitch;
+        for (size_t i = 0; i < AxisCount; i++) {
+            SetFlags(pressedAxes, static_cast<InputAxes>(1 << i), axisLevels[i] >= subscription.axisPressThreshold);
+        }
+        hasPrevious = true;
+        return;
+    }
+
+    InputEvent event{};
+    event.sensorTimestamp = input.sensorTimestamp;
+
+    auto changedButtons = static_cast<uint16_t>((previousButtons & ~input.buttons) | (input.buttons & ~previousButtons)) &
+                          static_cast<uint16_t>(subscription.buttons);
+    while (changedButtons != 0) {
+        const auto button = static_cast<PressedButtons>(changedButtons & -changedButtons);
+        changedButtons &= changedButtons - 1;
+
+        event.type = HasAnyFlag(input.buttons, button) ? InputEventType::ButtonPressed : InputEventType::ButtonReleased;
+        event.button = button;
+        events.Push(event);
+    }
+    event.button = static_cast<PressedButtons>(0);
+
+    auto changedHat = static_cast<uint8_t>((previousHatSwitch & ~input.hatSwitch) | (input.hatSwitch & ~previousHatSwitch)) &
+                      static_cast<uint8_t>(subscription.hatSwitch);
+    while (changedHat != 0) {
+        const auto direction = static_cast<HatSwitch>(changedHat & -changedHat);
+        changedHat &= changedHat - 1;
+
+        event.type = HasAnyFlag(input.hatSwitch, direction) ? InputEventType::HatPressed : InputEventType::HatReleased;
+        event.hatSwitch = direction;
+        events.Push(event);
+    }
+    event.hatSwitch = HatSwitch::None;
+
+    if (subscription.axes != InputAxes::None) {
+        for (size_t i = 0; i < AxisCount; i++) {
+            const auto axisFlag = static_cast<InputAxes>(1 << i);
+            if (!HasAnyFlag(subscription.axes, axisFlag))
+                continue;
+
+            const bool wasPressed = HasAnyFlag(pressedAxes, axisFlag);
+            const bool isPressed = wasPressed ? axisLevels[i] >= subscription.axisReleaseThreshold : axisLevels[i] >= subscription.axisPressThreshold;
+            if (wasPressed == isPressed)
+                continue;
+
+            SetFlags(pressedAxes, axisFlag, isPressed);
+            event.type = isPressed ? InputEventType::AxisPressed : InputEventType::AxisReleased;
+            event.axis = static_cast<InputAxis>(i);
+            event.axisValue = axisValues[i];
+            events.Push(event);
+        }
+    }
+
+    previousButtons = input.buttons;
+    previousHatSwitch = input.hatSwitch;
+}
+
+} // namespace ds
@@ -0,0 +1,58 @@
+#include <Daisy/LatencyHistogram.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ds {
+
+uint32_t LatencyHistogramSnapshot::Percentile(double fraction) const {
+    if (count == 0)
+        return 0;
+
+    const double clamped = std::clamp(fraction, 0.0, 1.0);
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped * static_cast<double>(count))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= rank)
+            return std::min(latency_buckets::UpperBound(i), max);
+    }
+    return max;
+}
+
+void LatencyHistogram::Record(uint64_t microseconds) {
+    const auto value = static_cast<uint32_t>(std::min<uint64_t>(microseconds, UINT32_MAX));
+    buckets[latency_buckets::IndexOf(value)].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+
+    // the extremes settle quickly, after that these are plain loads
+    uint32_t current = min.load(std::memory_order_relaxed);
+    while (value < current && !min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+    current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::Snapshot(LatencyHistogramSnapshot* out) const {
+    // the count is summed up here rather than kept, recording is the hot side
+    out->count = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        out->buckets[i] = buckets[i].load(std::memory_order_relaxed);
+        out->count += out->buckets[i];
+    }
+    out->sum = sum.load(std::memory_order_relaxed);
+    out->min = out->count != 0 ? min.load(std::memory_order_relaxed) : 0;
+    out->max = max.load(std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Reset() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    sum.store(0, std::memory_order_relaxed);
+    min.store(UINT32_MAX, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+} // namespace ds
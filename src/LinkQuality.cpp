@@ -0,0 +1,69 @@
+#include <Daisy/Crc32.hpp>
+#include <Daisy/LinkQuality.hpp>
+#include <Daisy/Report.hpp>
+#include <Daisy/Stats.hpp>
+
+namespace ds {
+
+/// The sequence number counts in the upper half of the byte, the lower half holds flags
+constexpr uint8_t SequenceShift = 4;
+constexpr uint8_t SequenceMask = 0xf;
+
+bool LinkQualityMonitor::Process(const uint8_t* reportData, size_t reportSize) {
+    if (reportSize <= offsetof(report::BluetoothInputReport, sequenceNumber) || !CheckBluetoothInputCrc(reportData, reportSize)) {
+        corruptSinceValid++;
+        IncrementRelaxed(framesCorrupt, 1);
+        Push(Frame::Corrupt);
+        return false;
+    }
+
+    const auto sequence = static_cast<uint8_t>(reportData[offsetof(report::BluetoothInputReport, sequenceNumber)] >> SequenceShift);
+    if (hasSequence) {
+        // corrupt frames used up sequence numbers of the gap, they were already counted
+        const uint32_t gap = static_cast<uint8_t>(sequence - lastSequence - 1) & SequenceMask;
+        const uint32_t lost = gap > corruptSinceValid ? gap - corruptSinceValid : 0;
+        IncrementRelaxed(framesLost, lost);
+        for (uint32_t i = 0; i < lost; i++) {
+            Push(Frame::Lost);
+        }
+    }
+    lastSequence = sequence;
+    hasSequence = true;
+    corruptSinceValid = 0;
+
+    IncrementRelaxed(framesReceived, 1);
+    Push(Frame::Received);
+    return true;
+}
+
+void LinkQualityMonitor::Push(Frame frame) {
+    const auto count = [this](Frame kind, int32_t amount) {
+        if (kind == Frame::Lost) {
+            IncrementRelaxed(windowLost, amount);
+        } else if (kind == Frame::Corrupt) {
+            IncrementRelaxed(windowCorrupt, amount);
+        }
+    };
+
+    if (filled == window.size()) {
+        count(window[cursor], -1);
+    } else {
+        filled++;
+        windowFrames.store(filled, std::memory_order_relaxed);
+    }
+    window[cursor] = frame;
+    count(frame, 1);
+    cursor = (cursor + 1) % window.size();
+}
+
+void LinkQualityMonitor::Snapshot(LinkQuality* out) const {
+    out->windowFrames = windowFrames.load(std::memory_order_relaxed);
+    const float frames = out->windowFrames != 0 ? static_cast<float>(out->windowFrames) : 1.0f;
+    out->lossRate = static_cast<float>(windowLost.load(std::memory_order_relaxed)) / frames;
+    out->corruptionRate = static_cast<float>(windowCorrupt.load(std::memory_order_relaxed)) / frames;
+    out->framesReceived = framesReceived.load(std::memory_order_relaxed);
+    out->framesLost = framesLost.load(std::memory_order_relaxed);
+    out->framesCorrupt = framesCorrupt.load(std::memory_order_relaxed);
+}
+
+} // namespace ds
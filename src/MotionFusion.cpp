@@ -0,0 +1,216 @@
+#include <Daisy/MotionFusion.hpp>
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define DS_MOTION_FUSION_SSE 1
+#include <emmintrin.h>
+#else
+#define DS_MOTION_FUSION_SSE 0
+#endif
+
+namespace ds {
+
+constexpr float RadiansPerDegree = 3.14159265358979f / 180.0f;
+
+MotionSample ToMotionSample(const ControllerInput& input, float dt) {
+    // controller axes are x right, y up out of the face and z towards the player
+    const auto& rate = input.angularVelocity;
+    const auto& accel = input.acceleration;
+
+    MotionSample sample{};
+    sample.gyro = {rate.pitch * RadiansPerDegree, -rate.roll * RadiansPerDegree, rate.yaw * RadiansPerDegree};
+    sample.accel = {accel.x, -accel.z, accel.y};
+    sample.dt = dt;
+    return sample;
+}
+
+// the filters are written once against a lane type, float for a single controller and Float4 for four of them,
+// both only use correctly rounded operations in the same order, so the results match bit for bit
+
+static inline float RSqrt(float value) { return 1.0f / std::sqrt(value); }
+static inline float KeepIfPositive(float test, float value) { return test > 0.0f ? value : 0.0f; }
+
+#if DS_MOTION_FUSION_SSE
+struct Float4 {
+    Float4(float value) : v(_mm_set1_ps(value)) {}
+    Float4(__m128 value) : v(value) {}
+
+    __m128 v;
+};
+
+static inline Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+static inline Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+static inline Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+static inline Float4 operator-(Float4 a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+static inline Float4& operator+=(Float4& a, Float4 b) { return a = a + b; }
+static inline Float4& operator-=(Float4& a, Float4 b) { return a = a - b; }
+static inline Float4& operator*=(Float4& a, Float4 b) { return a = a * b; }
+static inline Float4 RSqrt(Float4 value) { return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(value.v)); }
+static inline Float4 KeepIfPositive(Float4 test, Float4 value) { return _mm_and_ps(_mm_cmpgt_ps(test.v, _mm_setzero_ps()), value.v); }
+#endif
+
+template <typename V>
+struct Lanes {
+    V qw, qx, qy, qz;
+    V ix, iy, iz;
+};
+
+template <typename V>
+struct SampleLanes {
+    V gx, gy, gz;
+    V ax, ay, az;
+    V dt;
+};
+
+/// Returns the squared norm of the accelerometer and normalizes it, a zero vector stays zero
+template <typename V>
+static V NormalizeAccel(SampleLanes<V>& sample) {
+    const V norm = sample.ax * sample.ax + sample.ay * sample.ay + sample.az * sample.az;
+    const V scale = KeepIfPositive(norm, RSqrt(norm));
+    sample.ax *= scale;
+    sample.ay *= scale;
+    sample.az *= scale;
+    return norm;
+}
+
+template <typename V>
+static void NormalizeOrientation(Lanes<V>& lanes) {
+    const V scale = RSqrt(lanes.qw * lanes.qw + lanes.qx * lanes.qx + lanes.qy * lanes.qy + lanes.qz * lanes.qz);
+    lanes.qw *= scale;
+    lanes.qx *= scale;
+    lanes.qy *= scale;
+    lanes.qz *= scale;
+}
+
+/// Madgwick's IMU filter: the gyroscope rate is integrated, minus a normalized gradient step that rotates the
+/// gravity direction predicted by the orientation towards the measured one
+template <typename V>
+static void StepMadgwick(Lanes<V>& q, SampleLanes<V> s, V beta) {
+    V dw = V(0.5f) * (-q.qx * s.gx - q.qy * s.gy - q.qz * s.gz);
+    V dx = V(0.5f) * (q.qw * s.gx + q.qy * s.gz - q.qz * s.gy);
+    V dy = V(0.5f) * (q.qw * s.gy - q.qx * s.gz + q.qz * s.gx);
+    V dz = V(0.5f) * (q.qw * s.gz + q.qx * s.gy - q.qy * s.gx);
+
+    const V accelNorm = NormalizeAccel(s);
+    const V w2 = V(2.0f) * q.qw, x2 = V(2.0f) * q.qx, y2 = V(2.0f) * q.qy, z2 = V(2.0f) * q.qz;
+    const V w4 = V(4.0f) * q.qw, x4 = V(4.0f) * q.qx, y4 = V(4.0f) * q.qy;
+    const V x8 = V(8.0f) * q.qx, y8 = V(8.0f) * q.qy;
+    const V ww = q.qw * q.qw, xx = q.qx * q.qx, yy = q.qy * q.qy, zz = q.qz * q.qz;
+
+    V gw = w4 * yy + y2 * s.ax + w4 * xx - x2 * s.ay;
+    V gx = x4 * zz - z2 * s.ax + V(4.0f) * ww * q.qx - w2 * s.ay - x4 + x8 * xx + x8 * yy + x4 * s.az;
+    V gy = V(4.0f) * ww * q.qy + w2 * s.ax + y4 * zz - z2 * s.ay - y4 + y8 * xx + y8 * yy + y4 * s.az;
+    V gz = V(4.0f) * xx * q.qz - x2 * s.ax + V(4.0f) * yy * q.qz - y2 * s.ay;
+    // no correction without gravity, and none once the gradient vanishes
+    const V gradientNorm = gw * gw + gx * gx + gy * gy + gz * gz;
+    const V step = KeepIfPositive(accelNorm, KeepIfPositive(gradientNorm, beta * RSqrt(gradientNorm)));
+    dw -= step * gw;
+    dx -= step * gx;
+    dy -= step * gy;
+    dz -= step * gz;
+
+    q.qw += dw * s.dt;
+    q.qx += dx * s.dt;
+    q.qy += dy * s.dt;
+    q.qz += dz * s.dt;
+    NormalizeOrientation(q);
+}
+
+/// Mahony's complementary filter: the cross product of measured and predicted gravity is fed back into the gyroscope rate
+template <typename V>
+static void StepMahony(Lanes<V>& q, SampleLanes<V> s, V kp, V ki) {
+    const V accelNorm = NormalizeAccel(s);
+    const V vx = q.qx * q.qz - q.qw * q.qy;
+    const V vy = q.qw * q.qx + q.qy * q.qz;
+    const V vz = q.qw * q.qw - V(0.5f) + q.qz * q.qz;
+    const V ex = KeepIfPositive(accelNorm, s.ay * vz - s.az * vy);
+    const V ey = KeepIfPositive(accelNorm, s.az * vx - s.ax * vz);
+    const V ez = KeepIfPositive(accelNorm, s.ax * vy - s.ay * vx);
+
+    q.ix += V(2.0f) * ki * ex * s.dt;
+    q.iy += V(2.0f) * ki * ey * s.dt;
+    q.iz += V(2.0f) * ki * ez * s.dt;
+    const V gx = (s.gx + q.ix + V(2.0f) * kp * ex) * (V(0.5f) * s.dt);
+    const V gy = (s.gy + q.iy + V(2.0f) * kp * ey) * (V(0.5f) * s.dt);
+    const V gz = (s.gz + q.iz + V(2.0f) * kp * ez) * (V(0.5f) * s.dt);
+
+    const V w = q.qw, x = q.qx, y = q.qy;
+    q.qw += -x * gx - y * gy - q.qz * gz;
+    q.qx += w * gx + y * gz - q.qz * gy;
+    q.qy += w * gy - x * gz + q.qz * gx;
+    q.qz += w * gz + x * gy - y * gx;
+    NormalizeOrientation(q);
+}
+
+template <typename V>
+static void Step(const MotionFusionSettings& settings, Lanes<V>& lanes, const SampleLanes<V>& sample) {
+    switch (settings.filter) {
+    case MotionFilter::Madgwick:
+        StepMadgwick(lanes, sample, V(settings.beta));
+        break;
+    case MotionFilter::Mahony:
+        StepMahony(lanes, sample, V(settings.kp), V(settings.ki));
+        break;
+    }
+}
+
+void UpdateMotionFusion(const MotionFusionSettings& settings, const MotionSample& sample, MotionFusionState* state) {
+    Lanes<float> lanes{state->orientation.w, state->orientation.x,   state->orientation.y,  state->orientation.z,
+                       state->integralError.x, state->integralError.y, state->integralError.z};
+    Step(settings, lanes, SampleLanes<float>{sample.gyro.x, sample.gyro.y, sample.gyro.z, sample.accel.x, sample.accel.y, sample.accel.z, sample.dt});
+    state->orientation = {lanes.qw, lanes.qx, lanes.qy, lanes.qz};
+    state->integralError = {lanes.ix, lanes.iy, lanes.iz};
+}
+
+MotionFusionBank::MotionFusionBank(size_t laneCount, MotionFusionSettings settings)
+    : settings(settings), laneCount(laneCount), qw(laneCount, 1.0f), qx(laneCount), qy(laneCount), qz(laneCount), ix(laneCount), iy(laneCount),
+      iz(laneCount) {}
+
+void MotionFusionBank::Update(const MotionSample* samples) {
+    size_t lane = 0;
+#if DS_MOTION_FUSION_SSE
+    const auto load = [](const float* column) { return Float4(_mm_loadu_ps(column)); };
+    const auto store = [](float* column, Float4 value) { _mm_storeu_ps(column, value.v); };
+    for (; lane + 4 <= laneCount; lane += 4) {
+        const MotionSample* s = samples + lane;
+        const auto gather = [s](auto field) { return Float4(_mm_setr_ps(field(s[0]), field(s[1]), field(s[2]), field(s[3]))); };
+        const SampleLanes<Float4> sample{
+            gather([](const MotionSample& m) { return m.gyro.x; }),  gather([](const MotionSample& m) { return m.gyro.y; }),
+            gather([](const MotionSample& m) { return m.gyro.z; }),  gather([](const MotionSample& m) { return m.accel.x; }),
+            gather([](const MotionSample& m) { return m.accel.y; }), gather([](const MotionSample& m) { return m.accel.z; }),
+            gather([](const MotionSample& m) { return m.dt; }),
+        };
+
+        Lanes<Float4> lanes{load(&qw[lane]), load(&qx[lane]), load(&qy[lane]), load(&qz[lane]), load(&ix[lane]), load(&iy[lane]), load(&iz[lane])};
+        Step(settings, lanes, sample);
+        store(&qw[lane], lanes.qw);
+        store(&qx[lane], lanes.qx);
+        store(&qy[lane], lanes.qy);
+        store(&qz[lane], lanes.qz);
+        store(&ix[lane], lanes.ix);
+        store(&iy[lane], lanes.iy);
+        store(&iz[lane], lanes.iz);
+    }
+#endif
+
+    for (; lane < laneCount; lane++) {
+        MotionFusionState state{{qw[lane], qx[lane], qy[lane], qz[lane]}, {ix[lane], iy[lane], iz[lane]}};
+        UpdateMotionFusion(settings, samples[lane], &state);
+        qw[lane] = state.orientation.w;
+        qx[lane] = state.orientation.x;
+        qy[lane] = state.orientation.y;
+        qz[lane] = state.orientation.z;
+        ix[lane] = state.integralError.x;
+        iy[lane] = state.integralError.y;
+        iz[lane] = state.integralError.z;
+    }
+}
+
+void MotionFusionBank::Reset(size_t lane) {
+    qw[lane] = 1.0f;
+    qx[lane] = qy[lane] = qz[lane] = 0.0f;
+    ix[lane] = iy[lane] = iz[lane] = 0.0f;
+}
+
+} // namespace ds
@@ -0,0 +1,141 @@
+#include <Daisy/OutputState.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+using namespace ds::report;
+
+namespace ds {
+
+namespace {
+
+struct FieldRange {
+    uint8_t offset;
+    uint8_t size;
+};
+
+#define DS_FIELD(name) FieldRange{static_cast<uint8_t>(offsetof(OutputReportData, name)), static_cast<uint8_t>(sizeof(OutputReportData::name))}
+
+/// Fields applied by one or more bits of a change flag byte
+struct FieldGroup {
+    uint8_t flagsOffset;
+    uint8_t mask;
+    std::array<FieldRange, 2> fields;
+    /// One-off command rather than state, sent every time and never remembered
+    bool command = false;
+};
+
+constexpr uint8_t Flags1Offset = offsetof(OutputReportData, flags1);
+constexpr uint8_t Flags2Offset = offsetof(OutputReportData, flags2);
+constexpr uint8_t Flags3Offset = offsetof(OutputReportData, flags3);
+constexpr std::array<uint8_t, 3> FlagsOffsets = {Flags1Offset, Flags2Offset, Flags3Offset};
+constexpr FieldRange NoField{0, 0};
+
+// mirrors which fields @see OutputBuilder writes for every flag
+constexpr std::array<FieldGroup, 13> FieldGroups = {{
+    {Flags1Offset, static_cast<uint8_t>(ChangeFlags1::EnableHaptics), {DS_FIELD(rightMotor), DS_FIELD(leftMotor)}},
+    {Flags1Offset, static_cast<uint8_t>(ChangeFlags1::RightTriggerEffects), {DS_FIELD(rightTrigger), NoField}},
+    {Flags1Offset, static_cast<uint8_t>(ChangeFlags1::LeftTriggerEffects), {DS_FIELD(leftTrigger), NoField}},
+    {Flags1Offset, static_cast<uint8_t>(ChangeFlags1::AudioVolumeChange), {DS_FIELD(headphoneVolume), DS_FIELD(speakerVolume)}},
+    {Flags1Offset, static_cast<uint8_t>(ChangeFlags1::SpeakerToggle), {DS_FIELD(audioFlags), NoField}},
+    {Flags1Offset, static_cast<uint8_t>(ChangeFlags1::MicVolumeChange), {DS_FIELD(micVolume), NoField}},
+    {Flags2Offset, static_cast<uint8_t>(ChangeFlags2::ToggleMicLed), {DS_FIELD(micLed), NoField}},
+    {Flags2Offset, static_cast<uint8_t>(ChangeFlags2::ToggleFullMute), {DS_FIELD(audioMute), NoField}},
+    {Flags2Offset, static_cast<uint8_t>(ChangeFlags2::ToggleLedStrips), {DS_FIELD(lightbarColor), DS_FIELD(playerLedBrightness)}},
+    {Flags2Offset, static_cast<uint8_t>(ChangeFlags2::TogglePlayerIndicator), {DS_FIELD(playerLedFlags), NoField}},
+    {Flags2Offset, static_cast<uint8_t>(ChangeFlags2::MotorPowerChange), {DS_FIELD(hapticsMuffle), NoField}},
+    {Flags3Offset, static_cast<uint8_t>(ChangeFlags3::PlayerLedBrightness), {DS_FIELD(playerLedBrightness), NoField}},
+    {Flags3Offset, static_cast<uint8_t>(ChangeFlags3::UnInterruptableLed), {DS_FIELD(lightbarPulseOptions), NoField}, true},
+}};
+
+#undef DS_FIELD
+
+const uint8_t* Bytes(const OutputReportData& data) { return reinterpret_cast<const uint8_t*>(&data); }
+uint8_t* Bytes(OutputReportData& data) { return reinterpret_cast<uint8_t*>(&data); }
+
+void CopyFields(const FieldGroup& group, OutputReportData& to, const OutputReportData& from) {
+    for (const auto& field : group.fields) {
+        if (field.size != 0) {
+            std::memcpy(Bytes(to) + field.offset, Bytes(from) + field.offset, field.size);
+        }
+    }
+}
+
+bool IsPresent(const FieldGroup& group, const OutputReportData& data) { return (Bytes(data)[group.flagsOffset] & group.mask) != 0; }
+
+bool FieldsEqual(const FieldGroup& group, const OutputReportData& left, const OutputReportData& right) {
+    for (const auto& field : group.fields) {
+        if (field.size != 0 && std::memcmp(Bytes(left) + field.offset, Bytes(right) + field.offset, field.size) != 0)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+OutputReportData OutputState::Diff(const OutputReportData& data) const {
+    OutputReportData reduced = data;
+
+    // a flag is only dropped if every group it belongs to is unchanged, so collect the changed ones first
+    const std::array<uint8_t, 3> known = {static_cast<uint8_t>(known1), static_cast<uint8_t>(known2), static_cast<uint8_t>(known3)};
+    std::array<uint8_t, 3> tracked{};
+    std::array<uint8_t, 3> changed{};
+    for (const auto& group : FieldGroups) {
+        const size_t index = group.flagsOffset == Flags1Offset ? 0 : group.flagsOffset == Flags2Offset ? 1 : 2;
+        const uint8_t present = Bytes(data)[group.flagsOffset] & group.mask;
+        if (present == 0)
+            continue;
+
+        tracked[index] |= present;
+        if (group.command || (known[index] & present) != present || !FieldsEqual(group, applied, data)) {
+            changed[index] |= present;
+        }
+    }
+
+    for (size_t i = 0; i < FlagsOffsets.size(); i++) {
+        // untracked bits pass through
+        Bytes(reduced)[FlagsOffsets[i]] &= static_cast<uint8_t>(~tracked[i] | changed[i]);
+    }
+    return reduced;
+}
+
+void OutputState::Apply(const OutputReportData& data) {
+    for (const auto& group : FieldGroups) {
+        if (!group.command && IsPresent(group, data)) {
+            CopyFields(group, applied, data);
+        }
+    }
+
+    known1 |= data.flags1;
+    known2 |= data.flags2;
+    known3 |= data.flags3;
+}
+
+OutputReportData OutputState::Merge(const OutputReportData& pending, const OutputReportData& data) {
+    OutputReportData merged = data;
+    for (const auto& group : FieldGroups) {
+        if (IsPresent(group, pending) && !IsPresent(group, data)) {
+            CopyFields(group, merged, pending);
+        }
+    }
+    // groups can share fields, the later output has to win for those as well
+    for (const auto& group : FieldGroups) {
+        if (IsPresent(group, data)) {
+            CopyFields(group, merged, data);
+        }
+    }
+
+    merged.flags1 |= pending.flags1;
+    merged.flags2 |= pending.flags2;
+    merged.flags3 |= pending.flags3;
+    return merged;
+}
+
+void OutputState::Reset() { *this = OutputState{}; }
+
+bool OutputState::IsEmpty(const OutputReportData& data) {
+    return data.flags1 == ChangeFlags1::None && data.flags2 == ChangeFlags2::None && data.flags3 == ChangeFlags3::Off;
+}
+
+} // namespace ds
@@ -0,0 +1,181 @@
+#include <Daisy/Recording.hpp>
+
+#include <cerrno>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ds {
+
+Result ReportRecorder::Open(const char* path) {
+    if (!path)
+        return Result::INVALID_PARAMETER;
+    Close();
+
+    std::lock_guard lock(mutex);
+    error = Result::OK;
+    file = std::fopen(path, "wb");
+    if (!file)
+        return Result(Result::FILE_IO, static_cast<uint32_t>(errno));
+
+    // todo: big endian support
+    const RecordingHeader header{RecordingMagic, RecordingVersion};
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        std::fclose(file);
+        file = nullptr;
+        return Result(Result::FILE_IO, static_cast<uint32_t>(errno));
+    }
+
+    start = std::chrono::steady_clock::now();
+    open.store(true, std::memory_order_release);
+    return Result::OK;
+}
+
+Result ReportRecorder::Close() {
+    std::lock_guard lock(mutex);
+    open.store(false, std::memory_order_release);
+    if (file) {
+        if (std::fclose(file) != 0 && error == Result::OK) {
+            error = Result(Result::FILE_IO, static_cast<uint32_t>(errno));
+        }
+        file = nullptr;
+    }
+    return error;
+}
+
+void ReportRecorder::RecordConnected(uint32_t controllerId, const report::HidReportProperties& properties) {
+    Write(RecordType::Connected, controllerId, &properties, sizeof(properties));
+}
+
+void ReportRecorder::RecordDisconnected(uint32_t controllerId) { Write(RecordType::Disconnected, controllerId, nullptr, 0); }
+
+void ReportRecorder::RecordInput(uint32_t controllerId, const void* reportData, size_t reportSize) {
+    Write(RecordType::Input, controllerId, reportData, reportSize);
+}
+
+void ReportRecorder::RecordOutput(uint32_t controllerId, const void* reportData, size_t reportSize) {
+    Write(RecordType::Output, controllerId, reportData, reportSize);
+}
+
+void ReportRecorder::RecordFeatureReport(uint32_t controllerId, const void* reportData, size_t reportSize) {
+    Write(RecordType::FeatureReport, controllerId, reportData, reportSize);
+}
+
+void ReportRecorder::Write(RecordType type, uint32_t controllerId, const void* payload, size_t payloadSize) {
+    if (!IsOpen() || payloadSize > UINT16_MAX)
+        return;
+
+    std::lock_guard lock(mutex);
+    if (!file)
+        return;
+
+    RecordHeader header{};
+    header.timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    header.controllerId = controllerId;
+    header.type = type;
+    header.payloadSize = static_cast<uint16_t>(payloadSize);
+    if (std::fwrite(&header, sizeof(header), 1, file) == 1 && (payloadSize == 0 || std::fwrite(payload, payloadSize, 1, file) == 1))
+        return;
+
+    error = Result(Result::FILE_IO, static_cast<uint32_t>(errno));
+    open.store(false, std::memory_order_release);
+    std::fclose(file);
+    file = nullptr;
+}
+
+#if defined(_WIN32)
+Result MappedFile::Open(const char* path) {
+    if (!path)
+        return Result::INVALID_PARAMETER;
+    Close();
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return Result(Result::FILE_IO, GetLastError());
+    fileHandle = file;
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize)) {
+        const DWORD lastError = GetLastError();
+        Close();
+        return Result(Result::FILE_IO, lastError);
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    if (size == 0)
+        return Result::OK;
+
+    mappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle) {
+        const DWORD lastError = GetLastError();
+        Close();
+        return Result(Result::FILE_IO, lastError);
+    }
+
+    data = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        const DWORD lastError = GetLastError();
+        Close();
+        return Result(Result::FILE_IO, lastError);
+    }
+    return Result::OK;
+}
+
+void MappedFile::Close() {
+    if (data)
+        UnmapViewOfFile(data);
+    if (mappingHandle)
+        CloseHandle(mappingHandle);
+    if (fileHandle)
+        CloseHandle(fileHandle);
+    data = nullptr;
+    size = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+#else
+Result MappedFile::Open(const char* path) {
+    if (!path)
+        return Result::INVALID_PARAMETER;
+    Close();
+
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return Result(Result::FILE_IO, static_cast<uint32_t>(errno));
+
+    struct stat fileStat {};
+    if (fstat(fd, &fileStat) != 0) {
+        const int lastError = errno;
+        close(fd);
+        return Result(Result::FILE_IO, static_cast<uint32_t>(lastError));
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    void* mapping = nullptr;
+    if (fileStat.st_size != 0) {
+        mapping = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    const int lastError = errno;
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return Result(Result::FILE_IO, static_cast<uint32_t>(lastError));
+
+    data = static_cast<const uint8_t*>(mapping);
+    size = static_cast<size_t>(fileStat.st_size);
+    return Result::OK;
+}
+
+void MappedFile::Close() {
+    if (data)
+        munmap(const_cast<uint8_t*>(data), size);
+    data = nullptr;
+    size = 0;
+}
+#endif
+
+} // namespace ds
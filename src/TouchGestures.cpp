@@ -0,0 +1,199 @@
+#include <Daisy/TouchGestures.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ds {
+
+constexpr float Pi = 3.14159265358979f;
+
+static float Distance(Vec2<float> a, Vec2<float> b) { return std::hypot(b.x - a.x, b.y - a.y); }
+static float Angle(Vec2<float> a, Vec2<float> b) { return std::atan2(b.y - a.y, b.x - a.x); }
+static Vec2<float> Center(Vec2<float> a, Vec2<float> b) { return {(a.x + b.x) / 2.0f, (a.y + b.y) / 2.0f}; }
+static Vec2<float> ToFloat(Vec2<uint16_t> position) { return {static_cast<float>(position.x), static_cast<float>(position.y)}; }
+
+static bool IsVerticalEdge(TouchEdge edge) { return edge == TouchEdge::Left || edge == TouchEdge::Right; }
+
+void TouchGestureRecognizer::Process(const ControllerInput& input, SpscRing<TouchGestureEvent>& events) {
+    if (hasPrevious) {
+        now += input.sensorTimestamp - lastTimestamp;
+    }
+    lastTimestamp = input.sensorTimestamp;
+    hasPrevious = true;
+
+    const TouchPoint* points[] = {&input.touchData.point1, &input.touchData.point2};
+    const auto findPoint = [&points](uint8_t id) -> const TouchPoint* {
+        for (const auto* point : points) {
+            if (point->isTouching && point->id == id)
+                return point;
+        }
+        return nullptr;
+    };
+
+    // lifted fingers go first, a new finger reusing the slot shouldn't look like a lifted one moving
+    for (auto& contact : contacts) {
+        if (contact.active && !findPoint(contact.id)) {
+            EndContact(contact, events);
+        }
+    }
+
+    bool moved = false;
+    for (const auto* point : points) {
+        if (!point->isTouching)
+            continue;
+        auto* contact = std::find_if(std::begin(contacts), std::end(contacts), [point](const Contact& c) { return c.active && c.id == point->id; });
+        if (contact == std::end(contacts)) {
+            BeginContact(*point, events);
+            continue;
+        }
+
+        const auto position = ToFloat(point->pos);
+        if (position.x != contact->last.x || position.y != contact->last.y) {
+            MoveContact(*contact, position, events);
+            moved = true;
+        }
+    }
+
+    if (pinching && moved) {
+        UpdatePinch(events, TouchGesturePhase::Change);
+    }
+}
+
+void TouchGestureRecognizer::BeginContact(const TouchPoint& point, SpscRing<TouchGestureEvent>& events) {
+    auto* contact = std::find_if(std::begin(contacts), std::end(contacts), [](const Contact& c) { return !c.active; });
+    if (contact == std::end(contacts))
+        return;
+
+    const auto position = ToFloat(point.pos);
+    *contact = Contact{true, point.id, position, position, now, EdgeAt(position), false};
+
+    auto& other = contacts[contact == &contacts[0] ? 1 : 0];
+    if (!other.active)
+        return;
+
+    multiTouch = true;
+    if (other.scrolling) {
+        auto event = MakeEvent(TouchGestureType::EdgeScroll, TouchGesturePhase::End, other.last, 0.0f);
+        event.edge = other.edge;
+        events.Push(event);
+        other.scrolling = false;
+    }
+    pinching = true;
+    pinchStartDistance = std::max(Distance(contacts[0].last, contacts[1].last), 1.0f);
+    pinchAngle = Angle(contacts[0].last, contacts[1].last);
+    pinchRotation = 0.0f;
+    UpdatePinch(events, TouchGesturePhase::Begin);
+}
+
+void TouchGestureRecognizer::MoveContact(Contact& contact, Vec2<float> position, SpscRing<TouchGestureEvent>& events) {
+    const auto previous = contact.last;
+    contact.last = position;
+    if (multiTouch || contact.edge == TouchEdge::None)
+        return;
+
+    const bool vertical = IsVerticalEdge(contact.edge);
+    if (contact.scrolling) {
+        auto event = MakeEvent(TouchGestureType::EdgeScroll, TouchGesturePhase::Change, position, vertical ? position.y - previous.y : position.x - previous.x);
+        event.edge = contact.edge;
+        events.Push(event);
+        return;
+    }
+
+    // moving along the edge starts scrolling, moving away from it first makes it an ordinary touch
+    const float along = vertical ? position.y - contact.start.y : position.x - contact.start.x;
+    const float across = vertical ? position.x - contact.start.x : position.y - contact.start.y;
+    if (std::abs(across) > settings.tapMaxMovement && std::abs(across) >= std::abs(along)) {
+        contact.edge = TouchEdge::None;
+    } else if (std::abs(along) > settings.tapMaxMovement) {
+        contact.scrolling = true;
+        auto event = MakeEvent(TouchGestureType::EdgeScroll, TouchGesturePhase::Begin, position, along);
+        event.edge = contact.edge;
+        events.Push(event);
+    }
+}
+
+void TouchGestureRecognizer::EndContact(Contact& contact, SpscRing<TouchGestureEvent>& events) {
+    contact.active = false;
+    const bool othersActive = std::any_of(std::begin(contacts), std::end(contacts), [](const Contact& c) { return c.active; });
+
+    if (pinching) {
+        UpdatePinch(events, TouchGesturePhase::End);
+        pinching = false;
+    } else if (contact.scrolling) {
+        auto event = MakeEvent(TouchGestureType::EdgeScroll, TouchGesturePhase::End, contact.last, 0.0f);
+        event.edge = contact.edge;
+        events.Push(event);
+    } else if (!multiTouch) {
+        const float duration = static_cast<float>(now - contact.startTime) / SensorTimestampTicksPerSecond;
+        const float distance = Distance(contact.start, contact.last);
+        if (duration <= settings.tapMaxDuration && distance <= settings.tapMaxMovement) {
+            events.Push(MakeEvent(TouchGestureType::Tap, TouchGesturePhase::Begin, contact.start, 0.0f));
+            const float sinceLastTap = static_cast<float>(now - lastTapTime) / SensorTimestampTicksPerSecond;
+            if (hasLastTap && sinceLastTap <= settings.doubleTapMaxInterval && Distance(lastTapPosition, contact.start) <= settings.doubleTapMaxDistance) {
+                events.Push(MakeEvent(TouchGestureType::DoubleTap, TouchGesturePhase::Begin, contact.start, 0.0f));
+                hasLastTap = false;
+            } else {
+                hasLastTap = true;
+                lastTapTime = now;
+                lastTapPosition = contact.start;
+            }
+        } else if (duration > 0.0f && distance >= settings.swipeMinDistance && distance / duration >= settings.swipeMinVelocity) {
+            const float dx = contact.last.x - contact.start.x;
+            const float dy = contact.last.y - contact.start.y;
+            auto event = MakeEvent(TouchGestureType::Swipe, TouchGesturePhase::Begin, contact.last, distance / duration);
+            if (std::abs(dx) >= std::abs(dy)) {
+                event.direction = dx > 0.0f ? SwipeDirection::Right : SwipeDirection::Left;
+            } else {
+                event.direction = dy > 0.0f ? SwipeDirection::Down : SwipeDirection::Up;
+            }
+            events.Push(event);
+        }
+    }
+
+    if (!othersActive) {
+        multiTouch = false;
+    }
+}
+
+void TouchGestureRecognizer::UpdatePinch(SpscRing<TouchGestureEvent>& events, TouchGesturePhase phase) {
+    const auto a = contacts[0].last;
+    const auto b = contacts[1].last;
+    // the angle is unwrapped step by step, so turning past half a revolution keeps counting
+    const float angle = Angle(a, b);
+    float step = angle - pinchAngle;
+    if (step > Pi) {
+        step -= 2.0f * Pi;
+    } else if (step < -Pi) {
+        step += 2.0f * Pi;
+    }
+    pinchAngle = angle;
+    pinchRotation += step;
+
+    auto event = MakeEvent(TouchGestureType::Pinch, phase, Center(a, b), Distance(a, b) / pinchStartDistance);
+    event.rotation = pinchRotation;
+    events.Push(event);
+}
+
+TouchGestureEvent TouchGestureRecognizer::MakeEvent(TouchGestureType type, TouchGesturePhase phase, Vec2<float> position, float value) const {
+    TouchGestureEvent event{};
+    event.sensorTimestamp = lastTimestamp;
+    event.type = type;
+    event.phase = phase;
+    event.position = {static_cast<uint16_t>(position.x), static_cast<uint16_t>(position.y)};
+    event.value = value;
+    return event;
+}
+
+TouchEdge TouchGestureRecognizer::EdgeAt(Vec2<float> position) const {
+    if (position.x < settings.edgeMargin)
+        return TouchEdge::Left;
+    if (position.x >= TouchpadWidth - settings.edgeMargin)
+        return TouchEdge::Right;
+    if (position.y < settings.edgeMargin)
+        return TouchEdge::Top;
+    if (position.y >= TouchpadHeight - settings.edgeMargin)
+        return TouchEdge::Bottom;
+    return TouchEdge::None;
+}
+
+} // namespace ds
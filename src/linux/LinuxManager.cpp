@@ -0,0 +1,465 @@
+#include <Daisy/Report.hpp>
+#include <Daisy/linux/LinuxManager.hpp>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/hidraw.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+namespace ds {
+
+constexpr uint32_t NETLINK_KERNEL_GROUP = 1;
+constexpr uint32_t NETLINK_UDEV_GROUP = 2;
+constexpr uint64_t MONITOR_EVENT_TAG = UINT64_MAX;
+constexpr int READ_TIMEOUT_MS = 2;
+
+/// Computes the largest input and output report sizes from a hid report descriptor
+///
+/// The sizes include the report id byte, matching what windows reports in HIDP_CAPS
+static report::HidReportProperties ParseReportDescriptor(const uint8_t* descriptor, size_t descriptorSize) {
+    struct GlobalState {
+        uint32_t reportSize = 0;
+        uint32_t reportCount = 0;
+        uint8_t reportId = 0;
+    };
+
+    std::array<uint32_t, 256> inputBits{};
+    std::array<uint32_t, 256> outputBits{};
+    std::vector<GlobalState> stack{};
+    GlobalState state{};
+    bool usesReportIds = false;
+
+    size_t i = 0;
+    while (i < descriptorSize) {
+        const uint8_t prefix = descriptor[i++];
+        if (prefix == 0xfe) { // long item, [ prefix | dataSize | longItemTag | data... ]
+            if (i >= descriptorSize)
+                break;
+            i += 2 + descriptor[i];
+            continue;
+        }
+
+        const size_t dataSize = (prefix & 0x3) == 3 ? 4 : (prefix & 0x3);
+        if (i + dataSize > descriptorSize)
+            break;
+
+        uint32_t value = 0;
+        for (size_t b = 0; b < dataSize; b++) {
+            value |= static_cast<uint32_t>(descriptor[i + b]) << (8 * b);
+        }
+        i += dataSize;
+
+        const uint8_t type = (prefix >> 2) & 0x3;
+        const uint8_t tag = (prefix >> 4) & 0xf;
+        if (type == 0) { // main
+            if (tag == 0x8) {
+                inputBits[state.reportId] += state.reportSize * state.reportCount;
+            } else if (tag == 0x9) {
+                outputBits[state.reportId] += state.reportSize * state.reportCount;
+            }
+        } else if (type == 1) { // global
+            switch (tag) {
+            case 0x7:
+                state.reportSize = value;
+                break;
+            case 0x8:
+                state.reportId = static_cast<uint8_t>(value);
+                usesReportIds = true;
+                break;
+            case 0x9:
+                state.reportCount = value;
+                break;
+            case 0xa:
+                stack.push_back(state);
+                break;
+            case 0xb:
+                if (!stack.empty()) {
+                    state = stack.back();
+                    stack.pop_back();
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    const uint32_t idSize = usesReportIds ? 1 : 0;
+    const auto toBytes = [idSize](uint32_t bits) { return static_cast<uint16_t>(bits == 0 ? 0 : (bits + 7) / 8 + idSize); };
+
+    report::HidReportProperties properties{};
+    properties.inputReportByteLength = toBytes(*std::max_element(inputBits.begin(), inputBits.end()));
+    properties.outputReportByteLength = toBytes(*std::max_element(outputBits.begin(), outputBits.end()));
+    return properties;
+}
+
+Result LinuxManager::Create(std::function<void(ControllerHandle)> onConnected, std::function<void(ControllerHandle)> onDisconnect, LinuxManager* outManager) {
+    if (!outManager) {
+        return Result::INVALID_PARAMETER;
+    }
+
+    LinuxManager manager{};
+    manager.onConnected = std::move(onConnected);
+    manager.onDisconnect = std::move(onDisconnect);
+
+    manager.epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (manager.epollFd.handle == CloseFd::INVALID) {
+        return Result(Result::NOTIFICATION_REGISTER, errno);
+    }
+
+    manager.readEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (manager.readEpollFd.handle == CloseFd::INVALID) {
+        return Result(Result::NOTIFICATION_REGISTER, errno);
+    }
+
+    manager.monitorFd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    if (manager.monitorFd.handle == CloseFd::INVALID) {
+        return Result(Result::NOTIFICATION_REGISTER, errno);
+    }
+
+    // when udev is running we listen for its events instead of the kernel ones,
+    // by the time udev broadcasts an event the device node has the right permissions applied
+    sockaddr_nl address{};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = access("/run/udev/control", F_OK) == 0 ? NETLINK_UDEV_GROUP : NETLINK_KERNEL_GROUP;
+    if (bind(manager.monitorFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        return Result(Result::NOTIFICATION_REGISTER, errno);
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = MONITOR_EVENT_TAG;
+    if (epoll_ctl(manager.epollFd, EPOLL_CTL_ADD, manager.monitorFd, &event) != 0) {
+        return Result(Result::NOTIFICATION_REGISTER, errno);
+    }
+
+    *outManager = std::move(manager);
+    return Result::OK;
+}
+
+void LinuxManager::Tick() {
+    bool expected = true;
+    if (this->wantsEnumeration.CompareExchangeStrong(expected, true, std::memory_order_acquire)) {
+        EnumerateDevices();
+        this->wantsEnumeration.Store(false, std::memory_order_release);
+    }
+
+    ProcessEvents();
+}
+
+Result LinuxManager::EnumerateDevices() {
+    DIR* devDirectory = opendir("/dev");
+    if (!devDirectory) {
+        return Result(Result::DEVICE_ENUMERATION, errno);
+    }
+
+    std::vector<std::string> devicePaths{};
+    while (dirent* entry = readdir(devDirectory)) {
+        if (std::strncmp(entry->d_name, "hidraw", 6) == 0) {
+            devicePaths.push_back(std::string("/dev/") + entry->d_name);
+        }
+    }
+    closedir(devDirectory);
+
+    for (const auto& devicePath : devicePaths) {
+        ProbeDevice(devicePath);
+    }
+
+    return Result::OK;
+}
+
+void LinuxManager::ProbeDevice(const std::string& devicePath) {
+    if (FindController(devicePath).IsValid())
+        return;
+
+    FdHandle deviceFd = open(devicePath.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (deviceFd.handle == CloseFd::INVALID)
+        return;
+
+    hidraw_devinfo deviceInfo{};
+    if (ioctl(deviceFd, HIDIOCGRAWINFO, &deviceInfo) != 0)
+        return;
+    if (static_cast<uint16_t>(deviceInfo.vendor) != report::VENDOR_ID || static_cast<uint16_t>(deviceInfo.product) != report::PRODUCT_ID)
+        return;
+
+    int descriptorSize = 0;
+    if (ioctl(deviceFd, HIDIOCGRDESCSIZE, &descriptorSize) != 0)
+        return;
+
+    hidraw_report_descriptor descriptor{};
+    descriptor.size = static_cast<uint32_t>(descriptorSize);
+    if (ioctl(deviceFd, HIDIOCGRDESC, &descriptor) != 0)
+        return;
+
+    LinuxControllerData controllerData{};
+    controllerData.devicePath = devicePath;
+    controllerData.properties = ParseReportDescriptor(descriptor.value, descriptor.size);
+    controllerData.hidFd = std::move(deviceFd);
+
+    OnControllerConnected(std::move(controllerData));
+}
+
+void LinuxManager::ProcessEvents() {
+    std::array<epoll_event, 16> events{};
+    std::vector<ControllerHandle> removedControllers{};
+    std::vector<std::string> addedDevices{};
+
+    // events that don't fit are level-triggered and get picked up on the next tick
+    const int eventCount = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 0);
+    for (int i = 0; i < eventCount; i++) {
+        const auto& event = events[i];
+        if (event.data.u64 == MONITOR_EVENT_TAG) {
+            ProcessHotplugEvents(addedDevices);
+        } else if (event.events & (EPOLLHUP | EPOLLERR)) {
+            const auto handle = ControllerHandle::FromBits(event.data.u64);
+            if (this->controllers.Contains(handle))
+                this->controllers[handle].disconnected.Store(true, std::memory_order_relaxed);
+        }
+    }
+
+    // removals go first so a handle that gets reused by an arrival can't be confused with the removed one
+    for (auto handle : this->connectedControllers) {
+        if (this->controllers[handle].disconnected.Load(std::memory_order_relaxed))
+            removedControllers.push_back(handle);
+    }
+    for (auto removed : removedControllers) {
+        OnControllerDisconnect(removed);
+    }
+
+    for (const auto& devicePath : addedDevices) {
+        ProbeDevice(devicePath);
+    }
+}
+
+void LinuxManager::ProcessHotplugEvents(std::vector<std::string>& addedDevices) {
+    std::array<char, 8192> buffer{};
+    while (true) {
+        const ssize_t received = recv(monitorFd, buffer.data(), buffer.size() - 1, 0);
+        if (received <= 0)
+            break;
+        buffer[static_cast<size_t>(received)] = '\0';
+
+        // udev events are prefixed with a header pointing to the properties,
+        // kernel events start with a "action@devpath" line followed by the properties
+        size_t offset = 0;
+        size_t end = static_cast<size_t>(received);
+        if (received >= 24 && std::memcmp(buffer.data(), "libudev", 8) == 0) {
+            uint32_t propertiesOffset = 0;
+            uint32_t propertiesLength = 0;
+            std::memcpy(&propertiesOffset, buffer.data() + 16, sizeof(propertiesOffset));
+            std::memcpy(&propertiesLength, buffer.data() + 20, sizeof(propertiesLength));
+            if (propertiesOffset >= end || propertiesLength > end - propertiesOffset)
+                continue;
+            offset = propertiesOffset;
+            end = propertiesOffset + propertiesLength;
+        } else {
+            offset = std::strlen(buffer.data()) + 1;
+        }
+
+        std::string_view action{};
+        std::string_view subsystem{};
+        std::string_view deviceName{};
+        while (offset < end) {
+            const std::string_view property(buffer.data() + offset);
+            offset += property.size() + 1;
+
+            if (property.rfind("ACTION=", 0) == 0) {
+                action = property.substr(7);
+            } else if (property.rfind("SUBSYSTEM=", 0) == 0) {
+                subsystem = property.substr(10);
+            } else if (property.rfind("DEVNAME=", 0) == 0) {
+                deviceName = property.substr(8);
+            }
+        }
+
+        if (subsystem != "hidraw" || deviceName.empty())
+            continue;
+
+        // the kernel reports the node name relative to /dev, udev reports the full path
+        std::string devicePath = deviceName[0] == '/' ? std::string(deviceName) : "/dev/" + std::string(deviceName);
+        if (devicePath.rfind("/dev/hidraw", 0) != 0 || devicePath.find('/', 5) != std::string::npos)
+            continue;
+
+        if (action == "add") {
+            addedDevices.push_back(std::move(devicePath));
+        } else if (action == "remove") {
+            addedDevices.erase(std::remove(addedDevices.begin(), addedDevices.end(), devicePath), addedDevices.end());
+            auto handle = FindController(devicePath);
+            if (handle.IsValid())
+                this->controllers[handle].disconnected.Store(true, std::memory_order_relaxed);
+        }
+    }
+}
+
+LinuxManager::ControllerHandle LinuxManager::FindController(const std::string& devicePath) const {
+    const auto it = this->controllersByPath.find(devicePath);
+    return it != this->controllersByPath.end() ? it->second : ControllerHandle{};
+}
+
+const std::vector<LinuxManager::ControllerHandle>& LinuxManager::GetConnectedControllers() const { return connectedControllers; }
+
+Result LinuxManager::GetReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize) {
+    Result res = PollReport(controller, reportData, reportSize, readSize);
+    if (res != Result::TIMEOUT)
+        return res;
+    auto& controllerData = this->controllers[controller];
+
+    pollfd pollData{};
+    pollData.fd = controllerData.hidFd;
+    pollData.events = POLLIN;
+    const int ready = poll(&pollData, 1, READ_TIMEOUT_MS);
+    if (ready == 0)
+        return Result::TIMEOUT;
+    if (ready > 0 && (pollData.revents & (POLLHUP | POLLERR))) {
+        controllerData.disconnected.Store(true, std::memory_order_relaxed);
+        return Result(Result::USB_COMMUNICATION, ENODEV);
+    }
+    return PollReport(controller, reportData, reportSize, readSize);
+}
+
+Result LinuxManager::PollReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize) {
+    if (!readSize)
+        return Result::INVALID_PARAMETER;
+    if (!this->controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    auto& controllerData = this->controllers[controller];
+
+    const ssize_t numberOfBytesRead = read(controllerData.hidFd, reportData, reportSize);
+    if (numberOfBytesRead < 0) {
+        const int lastError = errno;
+        if (lastError == EAGAIN)
+            return Result::TIMEOUT;
+        if (lastError == ENODEV || lastError == EIO)
+            controllerData.disconnected.Store(true, std::memory_order_relaxed);
+        return Result(Result::USB_COMMUNICATION, static_cast<uint32_t>(lastError));
+    }
+    *readSize = static_cast<size_t>(numberOfBytesRead);
+
+    return Result::OK;
+}
+
+Result LinuxManager::WaitForReports(uint32_t timeoutMs) {
+    std::array<epoll_event, 16> events{};
+    const int timeout = static_cast<int>(std::min<uint32_t>(timeoutMs, std::numeric_limits<int>::max()));
+    const int eventCount = epoll_wait(readEpollFd, events.data(), static_cast<int>(events.size()), timeout);
+    if (eventCount < 0) {
+        // a signal interrupting the wait is treated like the wait running out
+        return errno == EINTR ? Result(Result::TIMEOUT) : Result(Result::USB_COMMUNICATION, static_cast<uint32_t>(errno));
+    }
+    return eventCount == 0 ? Result(Result::TIMEOUT) : Result(Result::OK);
+}
+
+Result LinuxManager::SetReportsWaited(ControllerHandle controller, bool waited) {
+    if (!this->controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+
+    // hangups and errors still end the wait, like for every other controller
+    epoll_event event{};
+    event.events = waited ? static_cast<uint32_t>(EPOLLIN) : 0u;
+    event.data.u64 = controller.ToBits();
+    if (epoll_ctl(readEpollFd, EPOLL_CTL_MOD, this->controllers[controller].hidFd, &event) < 0)
+        return Result(Result::USB_COMMUNICATION, static_cast<uint32_t>(errno));
+    return Result::OK;
+}
+
+Result LinuxManager::SendReport(ControllerHandle controller, const void* reportData, size_t reportSize) {
+    if (!this->controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    auto& controllerData = this->controllers[controller];
+
+    // hidraw forwards the buffer as-is, so anything past the device's output report (bluetooth report padding) is trimmed
+    if (controllerData.properties.outputReportByteLength != 0)
+        reportSize = std::min<size_t>(reportSize, controllerData.properties.outputReportByteLength);
+
+    if (write(controllerData.hidFd, reportData, reportSize) < 0) {
+        const int lastError = errno;
+        if (lastError == ENODEV || lastError == EIO)
+            controllerData.disconnected.Store(true, std::memory_order_relaxed);
+        return Result(Result::USB_COMMUNICATION, static_cast<uint32_t>(lastError));
+    }
+
+    return Result::OK;
+}
+
+Result LinuxManager::GetFeatureReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize) {
+    if (!reportData || reportSize == 0 || !readSize)
+        return Result::INVALID_PARAMETER;
+    if (!this->controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    auto& controllerData = this->controllers[controller];
+
+    const int numberOfBytesRead = ioctl(controllerData.hidFd, HIDIOCGFEATURE(reportSize), reportData);
+    if (numberOfBytesRead < 0) {
+        const int lastError = errno;
+        if (lastError == ENODEV || lastError == EIO)
+            controllerData.disconnected.Store(true, std::memory_order_relaxed);
+        return Result(Result::USB_COMMUNICATION, static_cast<uint32_t>(lastError));
+    }
+    *readSize = static_cast<size_t>(numberOfBytesRead);
+
+    return Result::OK;
+}
+
+Result LinuxManager::GetHidProperties(ControllerHandle controller, report::HidReportProperties* outProperties) {
+    if (!this->controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    *outProperties = this->controllers[controller].properties;
+    return Result::OK;
+}
+
+Result LinuxManager::GetUserData(ControllerHandle controller, void** outUserData) {
+    if (!outUserData)
+        return Result::INVALID_PARAMETER;
+    if (!this->controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    *outUserData = this->controllers[controller].userData;
+    return Result::OK;
+}
+
+Result LinuxManager::SetUserData(ControllerHandle controller, void* userData) {
+    if (!this->controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    this->controllers[controller].userData = userData;
+    return Result::OK;
+}
+
+LinuxManager::ControllerHandle LinuxManager::OnControllerConnected(LinuxControllerData controllerData) {
+    auto handle = this->controllers.Add(std::move(controllerData));
+    this->controllersByPath.emplace(this->controllers[handle].devicePath, handle);
+    this->connectedControllers.push_back(handle);
+
+    // hangups and errors are always reported, reads themselves don't go through the epoll set
+    epoll_event event{};
+    event.events = 0;
+    event.data.u64 = handle.ToBits();
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, this->controllers[handle].hidFd, &event);
+
+    event.events = EPOLLIN;
+    epoll_ctl(readEpollFd, EPOLL_CTL_ADD, this->controllers[handle].hidFd, &event);
+
+    onConnected(handle);
+    return handle;
+}
+void LinuxManager::OnControllerDisconnect(ControllerHandle controller) {
+    onDisconnect(controller);
+    this->connectedControllers.erase(std::remove(this->connectedControllers.begin(), this->connectedControllers.end(), controller),
+                                     this->connectedControllers.end());
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, this->controllers[controller].hidFd, nullptr);
+    epoll_ctl(readEpollFd, EPOLL_CTL_DEL, this->controllers[controller].hidFd, nullptr);
+    this->controllersByPath.erase(this->controllers[controller].devicePath);
+    this->controllers.Remove(controller);
+}
+
+} // namespace ds
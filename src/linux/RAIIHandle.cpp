@@ -0,0 +1,14 @@
+#include <Daisy/linux/RAIIHandle.hpp>
+
+#include <unistd.h>
+
+namespace ds {
+
+void CloseFd::operator()(int& fd) const {
+    if (fd != INVALID) {
+        close(fd);
+        fd = INVALID;
+    }
+}
+
+} // namespace ds
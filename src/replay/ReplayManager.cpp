@@ -0,0 +1,248 @@
+#include <Daisy/replay/ReplayManager.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace ds {
+
+Result ReplayManager::Create(std::function<void(ControllerHandle)> onConnected, std::function<void(ControllerHandle)> onDisconnect,
+                             ReplayManager* outManager) {
+    if (!outManager) {
+        return Result::INVALID_PARAMETER;
+    }
+
+    ReplayManager manager{};
+    manager.onConnected = std::move(onConnected);
+    manager.onDisconnect = std::move(onDisconnect);
+    *outManager = std::move(manager);
+    return Result::OK;
+}
+
+void ReplayManager::Tick() {
+    RecordHeader header{};
+    while (ReadRecord(hotplugCursor, &header)) {
+        if (header.type != RecordType::Connected && header.type != RecordType::Disconnected) {
+            hotplugCursor = NextRecord(hotplugCursor, header);
+            continue;
+        }
+        if (!IsDue(header.timestampNs))
+            break;
+
+        // as fast as possible the controllers still have to see every report that was recorded before the hotplug event
+        if (mode == ReplayMode::AsFastAsPossible) {
+            const bool behind = std::any_of(connectedControllers.begin(), connectedControllers.end(),
+                                            [this](ControllerHandle handle) { return controllers[handle].cursor < hotplugCursor; });
+            if (behind)
+                break;
+        }
+
+        const size_t payloadOffset = hotplugCursor + sizeof(RecordHeader);
+        hotplugCursor = NextRecord(hotplugCursor, header);
+        if (header.type == RecordType::Connected) {
+            ReplayControllerData controllerData{};
+            controllerData.recordedId = header.controllerId;
+            std::memcpy(&controllerData.properties, file->Data() + payloadOffset, std::min<size_t>(header.payloadSize, sizeof(controllerData.properties)));
+            controllerData.cursor = hotplugCursor;
+
+            auto handle = controllers.Add(std::move(controllerData));
+            connectedControllers.push_back(handle);
+            onConnected(handle);
+        } else {
+            const auto connected = std::find_if(connectedControllers.begin(), connectedControllers.end(), [this, &header](ControllerHandle handle) {
+                return controllers[handle].recordedId == header.controllerId;
+            });
+            if (connected != connectedControllers.end()) {
+                Disconnect(*connected);
+            }
+        }
+    }
+}
+
+Result ReplayManager::EnumerateDevices() { return Result::OK; }
+
+const std::vector<ReplayManager::ControllerHandle>& ReplayManager::GetConnectedControllers() const { return connectedControllers; }
+
+Result ReplayManager::GetReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize) {
+    if (!readSize)
+        return Result::INVALID_PARAMETER;
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    auto& controllerData = controllers[controller];
+
+    const size_t offset = FindInput(controllerData);
+    RecordHeader header{};
+    if (!ReadRecord(offset, &header) || !IsDue(header.timestampNs))
+        return Result::TIMEOUT;
+
+    *readSize = std::min<size_t>(reportSize, header.payloadSize);
+    std::memcpy(reportData, file->Data() + offset + sizeof(RecordHeader), *readSize);
+    controllerData.cursor = NextRecord(offset, header);
+    return Result::OK;
+}
+
+Result ReplayManager::PollReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize) {
+    return GetReport(controller, reportData, reportSize, readSize);
+}
+
+Result ReplayManager::WaitForReports(uint32_t timeoutMs) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true) {
+        auto wakeUp = deadline;
+        for (auto handle : connectedControllers) {
+            if (!controllers[handle].reportsWaited.Load(std::memory_order_relaxed))
+                continue;
+            RecordHeader header{};
+            if (!ReadRecord(FindInput(controllers[handle]), &header))
+                continue;
+            if (IsDue(header.timestampNs))
+                return Result::OK;
+            wakeUp = std::min(wakeUp, start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(header.timestampNs)));
+        }
+
+        if (std::chrono::steady_clock::now() >= deadline)
+            return Result::TIMEOUT;
+        std::this_thread::sleep_until(wakeUp);
+    }
+}
+
+Result ReplayManager::SendReport(ControllerHandle controller, const void* reportData, size_t reportSize) {
+    DS_UNUSED(reportData);
+    DS_UNUSED(reportSize);
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    return Result::OK;
+}
+
+Result ReplayManager::GetFeatureReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize) {
+    if (!reportData || reportSize == 0 || !readSize)
+        return Result::INVALID_PARAMETER;
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    const auto& controllerData = controllers[controller];
+
+    // feature reports are recorded right after the connection, before any input of the controller
+    auto* bytes = static_cast<uint8_t*>(reportData);
+    RecordHeader header{};
+    for (size_t offset = controllerData.cursor; ReadRecord(offset, &header); offset = NextRecord(offset, header)) {
+        if (header.controllerId != controllerData.recordedId)
+            continue;
+        if (header.type != RecordType::FeatureReport)
+            break;
+
+        const uint8_t* payload = file->Data() + offset + sizeof(RecordHeader);
+        if (header.payloadSize != 0 && payload[0] == bytes[0]) {
+            *readSize = std::min<size_t>(reportSize, header.payloadSize);
+            std::memcpy(bytes, payload, *readSize);
+            return Result::OK;
+        }
+    }
+    return Result::USB_COMMUNICATION;
+}
+
+Result ReplayManager::GetHidProperties(ControllerHandle controller, report::HidReportProperties* outProperties) {
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    *outProperties = controllers[controller].properties;
+    return Result::OK;
+}
+
+Result ReplayManager::GetUserData(ControllerHandle controller, void** outUserData) {
+    if (!outUserData)
+        return Result::INVALID_PARAMETER;
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    *outUserData = controllers[controller].userData;
+    return Result::OK;
+}
+
+Result ReplayManager::SetReportsWaited(ControllerHandle controller, bool waited) {
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    controllers[controller].reportsWaited.Store(waited, std::memory_order_relaxed);
+    return Result::OK;
+}
+
+Result ReplayManager::SetUserData(ControllerHandle controller, void* userData) {
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    controllers[controller].userData = userData;
+    return Result::OK;
+}
+
+Result ReplayManager::Open(const char* path, ReplayMode replayMode) {
+    // the cursors of the connected controllers point into the previous recording
+    const std::vector<ControllerHandle> connected = connectedControllers;
+    for (auto handle : connected) {
+        Disconnect(handle);
+    }
+    hotplugCursor = 0;
+
+    Result res = file->Open(path);
+    if (res != Result::OK)
+        return res;
+
+    // todo: big endian support
+    RecordingHeader header{};
+    if (file->Size() < sizeof(header)) {
+        file->Close();
+        return Result::FILE_IO;
+    }
+    std::memcpy(&header, file->Data(), sizeof(header));
+    if (header.magic != RecordingMagic || header.version != RecordingVersion) {
+        file->Close();
+        return Result::FILE_IO;
+    }
+
+    mode = replayMode;
+    start = std::chrono::steady_clock::now();
+    hotplugCursor = sizeof(header);
+    return Result::OK;
+}
+
+bool ReplayManager::IsFinished() {
+    RecordHeader header{};
+    if (ReadRecord(hotplugCursor, &header))
+        return false;
+    return std::none_of(connectedControllers.begin(), connectedControllers.end(),
+                        [this, &header](ControllerHandle handle) { return ReadRecord(FindInput(controllers[handle]), &header); });
+}
+
+bool ReplayManager::ReadRecord(size_t offset, RecordHeader* outHeader) const {
+    const size_t size = file->Size();
+    if (offset < sizeof(RecordingHeader) || offset > size || size - offset < sizeof(RecordHeader))
+        return false;
+
+    std::memcpy(outHeader, file->Data() + offset, sizeof(RecordHeader));
+    // a recording cut off mid-write ends at the last complete record
+    return size - offset - sizeof(RecordHeader) >= outHeader->payloadSize;
+}
+
+size_t ReplayManager::FindInput(ReplayControllerData& controllerData) const {
+    RecordHeader header{};
+    while (ReadRecord(controllerData.cursor, &header)) {
+        if (header.controllerId == controllerData.recordedId) {
+            if (header.type == RecordType::Input)
+                return controllerData.cursor;
+            // the id may get reused by a controller connected later
+            if (header.type == RecordType::Disconnected)
+                break;
+        }
+        controllerData.cursor = NextRecord(controllerData.cursor, header);
+    }
+    return file->Size();
+}
+
+bool ReplayManager::IsDue(uint64_t timestampNs) const {
+    if (mode == ReplayMode::AsFastAsPossible)
+        return true;
+    return std::chrono::steady_clock::now() - start >= std::chrono::nanoseconds(timestampNs);
+}
+
+void ReplayManager::Disconnect(ControllerHandle controller) {
+    onDisconnect(controller);
+    connectedControllers.erase(std::remove(connectedControllers.begin(), connectedControllers.end(), controller), connectedControllers.end());
+    controllers.Remove(controller);
+}
+
+} // namespace ds
@@ -0,0 +1,318 @@
+#include <Daisy/Crc32.hpp>
+#include <Daisy/virtual/VirtualManager.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace ds {
+
+constexpr uint8_t USBInputReportId = 0x01;
+constexpr uint8_t BluetoothInputReportId = 0x31;
+constexpr report::HidReportProperties USBProperties = {64, 48};
+constexpr report::HidReportProperties BluetoothProperties = {78, 78};
+
+Result VirtualManager::Create(std::function<void(ControllerHandle)> onConnected, std::function<void(ControllerHandle)> onDisconnect,
+                              VirtualManager* outManager) {
+    if (!outManager) {
+        return Result::INVALID_PARAMETER;
+    }
+
+    VirtualManager manager{};
+    manager.onConnected = std::move(onConnected);
+    manager.onDisconnect = std::move(onDisconnect);
+    *outManager = std::move(manager);
+    return Result::OK;
+}
+
+void VirtualManager::Tick() {
+    std::vector<ControllerHandle> connected{};
+    std::vector<ControllerHandle> removed{};
+    {
+        std::lock_guard lock(*mutex);
+        connected = std::move(createdControllers);
+        createdControllers.clear();
+        for (auto handle : connected) {
+            controllers[handle].connected = true;
+            connectedControllers.push_back(handle);
+        }
+        for (auto handle : connectedControllers) {
+            if (controllers[handle].pendingRemoval)
+                removed.push_back(handle);
+        }
+    }
+
+    // callbacks call back into the manager, so they run without the lock held
+    for (auto handle : connected) {
+        onConnected(handle);
+    }
+    for (auto handle : removed) {
+        onDisconnect(handle);
+
+        std::lock_guard lock(*mutex);
+        connectedControllers.erase(std::remove(connectedControllers.begin(), connectedControllers.end(), handle), connectedControllers.end());
+        controllers.Remove(handle);
+    }
+}
+
+Result VirtualManager::EnumerateDevices() { return Result::OK; }
+
+const std::vector<VirtualManager::ControllerHandle>& VirtualManager::GetConnectedControllers() const { return connectedControllers; }
+
+Result VirtualManager::GetReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize) {
+    if (!readSize)
+        return Result::INVALID_PARAMETER;
+
+    std::lock_guard lock(*mutex);
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    auto& controllerData = controllers[controller];
+
+    GenerateDueReports(controllerData);
+    if (controllerData.inputQueue.empty())
+        return Result::TIMEOUT;
+
+    const auto& queued = controllerData.inputQueue.front();
+    *readSize = std::min(reportSize, queued.size());
+    std::memcpy(reportData, queued.data(), *readSize);
+    controllerData.inputQueue.pop_front();
+    return Result::OK;
+}
+
+Result VirtualManager::PollReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize) {
+    return GetReport(controller, reportData, reportSize, readSize);
+}
+
+Result VirtualManager::WaitForReports(uint32_t timeoutMs) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    std::unique_lock lock(*mutex);
+    while (true) {
+        auto wakeUp = deadline;
+        for (auto handle : connectedControllers) {
+            auto& controllerData = controllers[handle];
+            if (!controllerData.reportsWaited)
+                continue;
+            GenerateDueReports(controllerData);
+            if (!controllerData.inputQueue.empty())
+                return Result::OK;
+            if (controllerData.generator)
+                wakeUp = std::min(wakeUp, NextGeneratedReport(controllerData));
+        }
+
+        if (std::chrono::steady_clock::now() >= deadline)
+            return Result::TIMEOUT;
+        reportQueued->wait_until(lock, wakeUp);
+    }
+}
+
+Result VirtualManager::SendReport(ControllerHandle controller, const void* reportData, size_t reportSize) {
+    std::lock_guard lock(*mutex);
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+
+    const auto* bytes = static_cast<const uint8_t*>(reportData);
+    controllers[controller].sentReports.emplace_back(bytes, bytes + reportSize);
+    return Result::OK;
+}
+
+Result VirtualManager::GetFeatureReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize) {
+    if (!reportData || reportSize == 0 || !readSize)
+        return Result::INVALID_PARAMETER;
+
+    std::lock_guard lock(*mutex);
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+
+    auto* bytes = static_cast<uint8_t*>(reportData);
+    for (const auto& featureReport : controllers[controller].featureReports) {
+        if (featureReport[0] != bytes[0])
+            continue;
+        *readSize = std::min(reportSize, featureReport.size());
+        std::memcpy(bytes, featureReport.data(), *readSize);
+        return Result::OK;
+    }
+    // a real device stalls the request
+    return Result::USB_COMMUNICATION;
+}
+
+Result VirtualManager::GetHidProperties(ControllerHandle controller, report::HidReportProperties* outProperties) {
+    std::lock_guard lock(*mutex);
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    *outProperties = controllers[controller].properties;
+    return Result::OK;
+}
+
+Result VirtualManager::GetUserData(ControllerHandle controller, void** outUserData) {
+    if (!outUserData)
+        return Result::INVALID_PARAMETER;
+
+    std::lock_guard lock(*mutex);
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    *outUserData = controllers[controller].userData;
+    return Result::OK;
+}
+
+Result VirtualManager::SetReportsWaited(ControllerHandle controller, bool waited) {
+    std::lock_guard lock(*mutex);
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    controllers[controller].reportsWaited = waited;
+    return Result::OK;
+}
+
+Result VirtualManager::SetUserData(ControllerHandle controller, void* userData) {
+    std::lock_guard lock(*mutex);
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    controllers[controller].userData = userData;
+    return Result::OK;
+}
+
+VirtualManager::ControllerHandle VirtualManager::CreateController(VirtualTransport transport, size_t inputQueueLimit) {
+    VirtualControllerData controllerData{};
+    controllerData.transport = transport;
+    controllerData.properties = transport == VirtualTransport::Usb ? USBProperties : BluetoothProperties;
+    controllerData.inputQueueLimit = std::max<size_t>(inputQueueLimit, 1);
+
+    std::lock_guard lock(*mutex);
+    auto handle = controllers.Add(std::move(controllerData));
+    createdControllers.push_back(handle);
+    return handle;
+}
+
+Result VirtualManager::DestroyController(ControllerHandle controller) {
+    std::lock_guard lock(*mutex);
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+
+    auto& controllerData = controllers[controller];
+    if (!controllerData.connected) {
+        // never reported as connected, so there is nobody to tell about the removal
+        createdControllers.erase(std::remove(createdControllers.begin(), createdControllers.end(), controller), createdControllers.end());
+        controllers.Remove(controller);
+        return Result::OK;
+    }
+
+    controllerData.pendingRemoval = true;
+    return Result::OK;
+}
+
+Result VirtualManager::InjectReport(ControllerHandle controller, const report::InputReportData& data) {
+    std::lock_guard lock(*mutex);
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+
+    PushReport(controllers[controller], data);
+    reportQueued->notify_all();
+    return Result::OK;
+}
+
+Result VirtualManager::InjectRawReport(ControllerHandle controller, const void* reportData, size_t reportSize) {
+    if (!reportData)
+        return Result::INVALID_PARAMETER;
+
+    std::lock_guard lock(*mutex);
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+
+    PushRawReport(controllers[controller], static_cast<const uint8_t*>(reportData), reportSize);
+    reportQueued->notify_all();
+    return Result::OK;
+}
+
+Result VirtualManager::SetFeatureReport(ControllerHandle controller, const void* reportData, size_t reportSize) {
+    if (!reportData || reportSize == 0)
+        return Result::INVALID_PARAMETER;
+
+    std::lock_guard lock(*mutex);
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+
+    const auto* bytes = static_cast<const uint8_t*>(reportData);
+    auto& featureReports = controllers[controller].featureReports;
+    featureReports.erase(std::remove_if(featureReports.begin(), featureReports.end(),
+                                        [bytes](const std::vector<uint8_t>& featureReport) { return featureReport[0] == bytes[0]; }),
+                         featureReports.end());
+    featureReports.emplace_back(bytes, bytes + reportSize);
+    return Result::OK;
+}
+
+Result VirtualManager::SetReportGenerator(ControllerHandle controller, VirtualReportGenerator generator, double rateHz) {
+    if (generator && rateHz <= 0.0)
+        return Result::INVALID_PARAMETER;
+
+    std::lock_guard lock(*mutex);
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+
+    auto& controllerData = controllers[controller];
+    controllerData.generator = std::move(generator);
+    controllerData.generatorRateHz = rateHz;
+    controllerData.generatorStart = std::chrono::steady_clock::now();
+    controllerData.generatedFrames = 0;
+    reportQueued->notify_all();
+    return Result::OK;
+}
+
+Result VirtualManager::TakeSentReports(ControllerHandle controller, std::vector<std::vector<uint8_t>>* outReports) {
+    if (!outReports)
+        return Result::INVALID_PARAMETER;
+
+    std::lock_guard lock(*mutex);
+    if (!controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+
+    *outReports = std::move(controllers[controller].sentReports);
+    controllers[controller].sentReports.clear();
+    return Result::OK;
+}
+
+void VirtualManager::PushReport(VirtualControllerData& controllerData, const report::InputReportData& data) {
+    std::vector<uint8_t> reportData(controllerData.properties.inputReportByteLength);
+    if (controllerData.transport == VirtualTransport::Usb) {
+        reportData[0] = USBInputReportId;
+        std::memcpy(reportData.data() + 1, &data, sizeof(data));
+    } else {
+        reportData[0] = BluetoothInputReportId;
+        reportData[1] = static_cast<uint8_t>(controllerData.sequenceNumber++ << 4);
+        std::memcpy(reportData.data() + 2, &data, sizeof(data));
+
+        // todo: big endian support
+        const size_t crcOffset = reportData.size() - sizeof(uint32_t);
+        const uint32_t crc = Crc32(BluetoothInputCrcSeed, reportData.data(), crcOffset, false);
+        std::memcpy(reportData.data() + crcOffset, &crc, sizeof(crc));
+    }
+
+    PushRawReport(controllerData, reportData.data(), reportData.size());
+}
+
+void VirtualManager::PushRawReport(VirtualControllerData& controllerData, const uint8_t* reportData, size_t reportSize) {
+    if (controllerData.inputQueue.size() >= controllerData.inputQueueLimit)
+        controllerData.inputQueue.pop_front();
+    controllerData.inputQueue.emplace_back(reportData, reportData + reportSize);
+}
+
+void VirtualManager::GenerateDueReports(VirtualControllerData& controllerData) {
+    if (!controllerData.generator)
+        return;
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - controllerData.generatorStart;
+    const auto dueFrames = static_cast<uint64_t>(elapsed.count() * controllerData.generatorRateHz);
+
+    // frames that would overflow the queue anyway are skipped instead of generated and dropped
+    if (dueFrames - controllerData.generatedFrames > controllerData.inputQueueLimit)
+        controllerData.generatedFrames = dueFrames - controllerData.inputQueueLimit;
+
+    for (; controllerData.generatedFrames < dueFrames; controllerData.generatedFrames++) {
+        PushReport(controllerData, controllerData.generator(controllerData.generatedFrames));
+    }
+}
+
+std::chrono::steady_clock::time_point VirtualManager::NextGeneratedReport(const VirtualControllerData& controllerData) {
+    const std::chrono::duration<double> offset((controllerData.generatedFrames + 1) / controllerData.generatorRateHz);
+    return controllerData.generatorStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset);
+}
+
+} // namespace ds
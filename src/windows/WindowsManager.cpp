@@ -9,25 +9,87 @@
 // clang-format on
 
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <cwctype>
+#include <unordered_set>
 
 namespace ds {
 
 GUID HID_GUID;
 
-void OnDeviceAdded(WindowsManager* self) { self->wantsEnumeration.Store(true, std::memory_order_release); }
-void OnDeviceRemoved(WindowsManager* self) { self->wantsEnumeration.Store(true, std::memory_order_release); }
+/// How long @see WindowsManager::GetReport waits for a report, ms
+constexpr DWORD READ_TIMEOUT_MS = 2;
+
+struct PendingRead {
+    HANDLE device;
+    /// Manual reset, signalled once the read completed
+    WinHandle event;
+    OVERLAPPED overlapped;
+    std::vector<uint8_t> buffer;
+    /// Whether a read was started and its report not taken yet, it may have completed already
+    bool inFlight;
+};
+
+void CancelRead::operator()(PendingRead* read) const {
+    if (read->inFlight) {
+        CancelIoEx(read->device, &read->overlapped);
+        // the os may still write into the buffer until the cancellation completed
+        DWORD numberOfBytesRead = 0;
+        GetOverlappedResult(read->device, &read->overlapped, &numberOfBytesRead, true);
+    }
+    delete read;
+}
+
+/// Starts the next read, if it fails to start the event gets signalled so waiters come back and the next poll reports the error
+static DWORD StartRead(PendingRead& read) {
+    read.overlapped = {};
+    read.overlapped.hEvent = read.event.handle;
+    ResetEvent(read.event.handle);
+    if (!ReadFile(read.device, read.buffer.data(), static_cast<DWORD>(read.buffer.size()), nullptr, &read.overlapped)) {
+        const DWORD lastError = GetLastError();
+        if (lastError != ERROR_IO_PENDING) {
+            SetEvent(read.event.handle);
+            return lastError;
+        }
+    }
+    read.inFlight = true;
+    return ERROR_SUCCESS;
+}
+
+/// Device paths are case insensitive, notifications and setupapi don't report them with the same casing
+static std::wstring DeviceKey(std::wstring devicePath) {
+    std::transform(devicePath.begin(), devicePath.end(), devicePath.begin(), [](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+    return devicePath;
+}
+
+void OnDeviceArrived(WindowsManager* self, const wchar_t* devicePath) {
+    std::lock_guard lock(*self->hotplugMutex);
+    self->pendingHotplug.arrivedPaths.emplace_back(devicePath);
+}
+void OnDeviceRemoved(WindowsManager* self, const wchar_t* devicePath) {
+    std::lock_guard lock(*self->hotplugMutex);
+    self->pendingHotplug.removedPaths.emplace_back(devicePath);
+}
+void OnDeviceRemoved(WindowsManager* self, Handle<WindowsControllerData> controller) {
+    std::lock_guard lock(*self->hotplugMutex);
+    self->pendingHotplug.removedControllers.push_back(controller);
+}
 
 static DWORD CALLBACK DeviceNotificationCallback(HCMNOTIFICATION notification, PVOID context, CM_NOTIFY_ACTION action, PCM_NOTIFY_EVENT_DATA eventData,
                                                  DWORD eventDataSize) {
     DS_UNUSED(notification);
-    DS_UNUSED(eventData);
     DS_UNUSED(eventDataSize);
 
+    if (eventData->FilterType != CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE)
+        return ERROR_SUCCESS;
+
     auto manager = static_cast<WindowsManager*>(context);
+    const wchar_t* devicePath = eventData->u.DeviceInterface.SymbolicLink;
     if (action == CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL) {
-        OnDeviceAdded(manager);
+        OnDeviceArrived(manager, devicePath);
     } else if (action == CM_NOTIFY_ACTION_DEVICEINTERFACEREMOVAL) {
-        OnDeviceRemoved(manager);
+        OnDeviceRemoved(manager, devicePath);
     }
     return ERROR_SUCCESS;
 }
@@ -38,15 +100,16 @@ static DWORD CALLBACK SpecificDeviceNotificationCallback(HCMNOTIFICATION notific
     DS_UNUSED(eventData);
     DS_UNUSED(eventDataSize);
 
-    auto manager = static_cast<WindowsManager*>(context);
+    auto notificationContext = static_cast<DeviceNotificationContext*>(context);
     switch (action) {
     case CM_NOTIFY_ACTION_DEVICEQUERYREMOVE:
     case CM_NOTIFY_ACTION_DEVICEREMOVEPENDING:
     case CM_NOTIFY_ACTION_DEVICEREMOVECOMPLETE:
-        OnDeviceRemoved(manager); // todo: pass the handle into this callback so we don't needlessly re-enumerate the whole list
+        OnDeviceRemoved(notificationContext->manager, WindowsManager::ControllerHandle::FromBits(notificationContext->controller));
         break;
     case CM_NOTIFY_ACTION_DEVICEQUERYREMOVEFAILED:
-        OnDeviceAdded(manager);
+        // the device stays after all, it gets probed again once the removal queued above went through
+        OnDeviceArrived(notificationContext->manager, notificationContext->devicePath.c_str());
         break;
     default:
         break;
@@ -87,6 +150,8 @@ void WindowsManager::Tick() {
         EnumerateDevices();
         this->wantsEnumeration.Store(false, std::memory_order_release);
     }
+
+    ProcessHotplugEvents();
 }
 
 Result WindowsManager::EnumerateDevices() {
@@ -99,7 +164,7 @@ Result WindowsManager::EnumerateDevices() {
     SP_DEVICE_INTERFACE_DATA interfaceData{};
     interfaceData.cbSize = sizeof(SP_DEVICE_INTERFACE_DATA);
 
-    std::vector<ControllerHandle> keptControllers{};
+    std::unordered_set<std::wstring> presentDevices{};
     while (SetupDiEnumDeviceInterfaces(deviceList, nullptr, &HID_GUID, memberIndex, &interfaceData)) {
         memberIndex++;
 
@@ -115,67 +180,15 @@ Result WindowsManager::EnumerateDevices() {
             continue;
         }
 
+        // tracked controllers are not opened again
         std::wstring devicePath(interfaceDetail->DevicePath);
-
-        WinHandle deviceHandle =
-            CreateFileW(devicePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
-        if (deviceHandle.handle == INVALID_HANDLE_VALUE) {
-            continue;
-        }
-
-        HIDD_ATTRIBUTES hidAttributes;
-        if (!HidD_GetAttributes(deviceHandle, &hidAttributes)) {
-            continue;
-        }
-
-        if (hidAttributes.VendorID == report::VENDOR_ID && hidAttributes.ProductID == report::PRODUCT_ID) {
-            PHIDP_PREPARSED_DATA preparsedData{};
-            if (!HidD_GetPreparsedData(deviceHandle, &preparsedData))
-                continue;
-
-            auto _ = ds::raii([preparsedData]() { HidD_FreePreparsedData(preparsedData); });
-
-            HIDP_CAPS caps{};
-            if (HidP_GetCaps(preparsedData, &caps) != HIDP_STATUS_SUCCESS)
-                continue;
-
-            // skipping if the controller has already been added
-            bool alreadyConnected = false;
-            for (auto [handle, controller] : this->controllers) {
-                if (controller.devicePath == devicePath) {
-                    keptControllers.push_back(handle);
-                    alreadyConnected = true;
-                    break;
-                }
-            }
-            if (alreadyConnected)
-                continue;
-
-            WinHandle readEventHandle = CreateEventW(nullptr, true, false, L"Daisy_Read");
-            if (!readEventHandle)
-                continue;
-
-            WindowsControllerData controllerData{};
-            controllerData.devicePath = std::move(devicePath);
-            controllerData.hidHandle = std::move(deviceHandle);
-            controllerData.properties = {caps.InputReportByteLength, caps.OutputReportByteLength};
-            controllerData.readEventHandle = std::move(readEventHandle);
-
-            CM_NOTIFY_FILTER filter{};
-            filter.cbSize = sizeof(filter);
-            filter.FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEHANDLE;
-            filter.u.DeviceHandle.hTarget = controllerData.hidHandle.handle;
-
-            CM_Register_Notification(&filter, this, SpecificDeviceNotificationCallback, reinterpret_cast<HCMNOTIFICATION*>(&controllerData.deviceNotification));
-
-            auto handle = OnControllerConnected(std::move(controllerData));
-            keptControllers.push_back(handle);
-        }
+        presentDevices.insert(DeviceKey(devicePath));
+        ProbeDevice(devicePath);
     }
 
     std::vector<ControllerHandle> removedControllers{};
-    for (auto [handle, _] : this->controllers) {
-        if (std::find(keptControllers.begin(), keptControllers.end(), handle) == keptControllers.end()) {
+    for (const auto& [deviceKey, handle] : this->controllersByPath) {
+        if (presentDevices.find(deviceKey) == presentDevices.end()) {
             removedControllers.push_back(handle);
         }
     }
@@ -186,44 +199,175 @@ Result WindowsManager::EnumerateDevices() {
     return Result::OK;
 }
 
+void WindowsManager::ProbeDevice(const std::wstring& devicePath) {
+    if (FindController(devicePath).IsValid())
+        return;
+
+    // overlapped, so reads can be polled and waited on together, and don't hold up writes
+    WinHandle deviceHandle = CreateFileW(devicePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                                         FILE_FLAG_OVERLAPPED, nullptr);
+    if (deviceHandle.handle == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    HIDD_ATTRIBUTES hidAttributes;
+    if (!HidD_GetAttributes(deviceHandle, &hidAttributes)) {
+        return;
+    }
+    if (hidAttributes.VendorID != report::VENDOR_ID || hidAttributes.ProductID != report::PRODUCT_ID) {
+        return;
+    }
+
+    PHIDP_PREPARSED_DATA preparsedData{};
+    if (!HidD_GetPreparsedData(deviceHandle, &preparsedData))
+        return;
+
+    auto _ = ds::raii([preparsedData]() { HidD_FreePreparsedData(preparsedData); });
+
+    HIDP_CAPS caps{};
+    if (HidP_GetCaps(preparsedData, &caps) != HIDP_STATUS_SUCCESS)
+        return;
+
+    std::unique_ptr<PendingRead, CancelRead> pendingRead(new PendingRead{});
+    pendingRead->device = deviceHandle.handle;
+    pendingRead->event = CreateEventW(nullptr, true, false, nullptr); // unnamed, a named event would be shared between all controllers
+    if (!pendingRead->event.handle)
+        return;
+    pendingRead->buffer.resize(caps.InputReportByteLength);
+    // reads are always pending from here on, that's what waiting for reports waits on
+    if (StartRead(*pendingRead) != ERROR_SUCCESS)
+        return;
+
+    WinHandle writeEventHandle = CreateEventW(nullptr, true, false, nullptr);
+    if (!writeEventHandle.handle)
+        return;
+
+    WindowsControllerData controllerData{};
+    controllerData.devicePath = devicePath;
+    controllerData.hidHandle = std::move(deviceHandle);
+    controllerData.properties = {caps.InputReportByteLength, caps.OutputReportByteLength};
+    controllerData.featureReportByteLength = caps.FeatureReportByteLength;
+    controllerData.pendingRead = std::move(pendingRead);
+    controllerData.writeEventHandle = std::move(writeEventHandle);
+    controllerData.writeMutex = std::make_unique<std::mutex>();
+
+    OnControllerConnected(std::move(controllerData));
+}
+
+void WindowsManager::ProcessHotplugEvents() {
+    // taken out of the lock, tearing down a controller waits for its notification callbacks which take the lock as well
+    HotplugEvents events{};
+    {
+        std::lock_guard lock(*this->hotplugMutex);
+        std::swap(events, this->pendingHotplug);
+    }
+
+    // removals go first so a device that got removed and re-added reconnects under a new handle
+    for (const auto& devicePath : events.removedPaths) {
+        events.removedControllers.push_back(FindController(devicePath));
+    }
+    for (auto removed : events.removedControllers) {
+        // a removal is usually reported by several notifications
+        if (this->controllers.Contains(removed))
+            OnControllerDisconnect(removed);
+    }
+
+    for (const auto& devicePath : events.arrivedPaths) {
+        ProbeDevice(devicePath);
+    }
+}
+
+WindowsManager::ControllerHandle WindowsManager::FindController(const std::wstring& devicePath) const {
+    const auto it = this->controllersByPath.find(DeviceKey(devicePath));
+    return it != this->controllersByPath.end() ? it->second : ControllerHandle{};
+}
+
 const std::vector<WindowsManager::ControllerHandle>& WindowsManager::GetConnectedControllers() const { return connectedControllers; }
 
+static Result ReadError(WindowsManager* manager, WindowsManager::ControllerHandle controller, HANDLE device, DWORD lastError) {
+    if (lastError == ERROR_DEVICE_NOT_CONNECTED) {
+        HidD_FlushQueue(device);
+        OnDeviceRemoved(manager, controller);
+    }
+    return Result(Result::USB_COMMUNICATION, lastError);
+}
+
 Result WindowsManager::GetReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize) {
+    Result res = PollReport(controller, reportData, reportSize, readSize);
+    if (res != Result::TIMEOUT)
+        return res;
+    auto& controllerData = this->controllers[controller];
+
+    WaitForSingleObject(controllerData.pendingRead->event.handle, READ_TIMEOUT_MS);
+    res = PollReport(controller, reportData, reportSize, readSize);
+    if (res == Result::TIMEOUT) {
+        HidD_FlushQueue(controllerData.hidHandle); // need to flush queue because there might be a case
+                                                   // where the bluetooth device was disconnected but windows might not detect it
+                                                   // and we will keep timing out on a disconnected controller
+    }
+    return res;
+}
+
+Result WindowsManager::PollReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize) {
     if (!readSize)
         return Result::INVALID_PARAMETER;
     if (!this->controllers.Contains(controller))
         return Result::CONTROLLER_NOT_FOUND;
     auto& controllerData = this->controllers[controller];
+    PendingRead& read = *controllerData.pendingRead;
 
-    OVERLAPPED overlapped{};
-    overlapped.hEvent = controllerData.readEventHandle;
-    overlapped.Offset = overlapped.OffsetHigh = 0;
+    if (!read.inFlight) {
+        const DWORD lastError = StartRead(read);
+        if (lastError != ERROR_SUCCESS)
+            return ReadError(this, controller, controllerData.hidHandle, lastError);
+    }
 
     DWORD numberOfBytesRead = 0;
-    DWORD lastError = 0;
-    ResetEvent(controllerData.readEventHandle);
-    if (!ReadFile(controllerData.hidHandle, reportData, static_cast<DWORD>(reportSize), &numberOfBytesRead, &overlapped)) {
-        lastError = GetLastError();
-        if (lastError != ERROR_IO_PENDING) {
-            if (lastError == ERROR_DEVICE_NOT_CONNECTED) {
-                HidD_FlushQueue(controllerData.hidHandle);
-                OnDeviceRemoved(this);
-            }
-            return Result(Result::USB_COMMUNICATION, lastError);
-        }
-    }
-    if (!GetOverlappedResultEx(controllerData.hidHandle, &overlapped, &numberOfBytesRead, 2, false)) {
-        lastError = GetLastError();
-        if (lastError == WAIT_TIMEOUT) {
-            HidD_FlushQueue(controllerData.hidHandle); // need to flush queue because there might be a case
-                                                       // where the bluetooth device was disconnected but windows might not detect it
-                                                       // and we will keep timing out on a disconnected controller
+    if (!GetOverlappedResultEx(controllerData.hidHandle, &read.overlapped, &numberOfBytesRead, 0, false)) {
+        const DWORD lastError = GetLastError();
+        if (lastError == ERROR_IO_INCOMPLETE || lastError == WAIT_TIMEOUT)
             return Result::TIMEOUT;
+        read.inFlight = false;
+        return ReadError(this, controller, controllerData.hidHandle, lastError);
+    }
+    read.inFlight = false;
+    *readSize = std::min<size_t>(numberOfBytesRead, reportSize);
+    std::memcpy(reportData, read.buffer.data(), *readSize);
+
+    // a failure to start is reported by the next poll
+    StartRead(read);
+    return Result::OK;
+}
+
+Result WindowsManager::WaitForReports(uint32_t timeoutMs) {
+    std::array<HANDLE, MAXIMUM_WAIT_OBJECTS> events{};
+    DWORD eventCount = 0;
+    for (auto handle : this->connectedControllers) {
+        if (eventCount == events.size())
+            break;
+        auto& controllerData = this->controllers[handle];
+        if (controllerData.reportsWaited.Load(std::memory_order_relaxed)) {
+            events[eventCount++] = controllerData.pendingRead->event.handle;
         }
-        return Result(Result::USB_COMMUNICATION, lastError);
     }
-    *readSize = numberOfBytesRead;
+    if (eventCount == 0) {
+        Sleep(timeoutMs);
+        return Result::TIMEOUT;
+    }
+
+    // the event of a report nobody took yet stays signalled, so this returns right away until it's read
+    const DWORD res = WaitForMultipleObjects(eventCount, events.data(), false, timeoutMs);
+    if (res == WAIT_TIMEOUT)
+        return Result::TIMEOUT;
+    if (res == WAIT_FAILED)
+        return Result(Result::USB_COMMUNICATION, GetLastError());
+    return Result::OK;
+}
 
+Result WindowsManager::SetReportsWaited(ControllerHandle controller, bool waited) {
+    if (!this->controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    this->controllers[controller].reportsWaited.Store(waited, std::memory_order_relaxed);
     return Result::OK;
 }
 
@@ -232,13 +376,42 @@ Result WindowsManager::SendReport(ControllerHandle controller, const void* repor
         return Result::CONTROLLER_NOT_FOUND;
     auto& controllerData = this->controllers[controller];
 
+    // only writes queue up behind each other, the pending read of the controller doesn't hold them up
+    std::lock_guard writeLock(*controllerData.writeMutex);
+    OVERLAPPED overlapped{};
+    overlapped.hEvent = controllerData.writeEventHandle.handle;
+
     DWORD numberOfBytesWritten = 0;
-    if (!WriteFile(controllerData.hidHandle.handle, reportData, static_cast<DWORD>(reportSize), &numberOfBytesWritten, nullptr)) {
+    BOOL written = WriteFile(controllerData.hidHandle.handle, reportData, static_cast<DWORD>(reportSize), nullptr, &overlapped);
+    if (!written && GetLastError() == ERROR_IO_PENDING) {
+        written = GetOverlappedResult(controllerData.hidHandle.handle, &overlapped, &numberOfBytesWritten, true);
+    }
+    if (!written) {
+        DWORD lastError = GetLastError();
+        if (lastError == ERROR_DEVICE_NOT_CONNECTED)
+            OnDeviceRemoved(this, controller);
+        return Result(Result::USB_COMMUNICATION, lastError);
+    }
+
+    return Result::OK;
+}
+
+Result WindowsManager::GetFeatureReport(ControllerHandle controller, void* reportData, size_t reportSize, size_t* readSize) {
+    if (!reportData || !readSize)
+        return Result::INVALID_PARAMETER;
+    if (!this->controllers.Contains(controller))
+        return Result::CONTROLLER_NOT_FOUND;
+    auto& controllerData = this->controllers[controller];
+    if (controllerData.featureReportByteLength == 0 || reportSize < controllerData.featureReportByteLength)
+        return Result::INVALID_PARAMETER;
+
+    if (!HidD_GetFeature(controllerData.hidHandle.handle, reportData, controllerData.featureReportByteLength)) {
         DWORD lastError = GetLastError();
         if (lastError == ERROR_DEVICE_NOT_CONNECTED)
-            OnDeviceRemoved(this);
+            OnDeviceRemoved(this, controller);
         return Result(Result::USB_COMMUNICATION, lastError);
     }
+    *readSize = controllerData.featureReportByteLength;
 
     return Result::OK;
 }
@@ -268,7 +441,19 @@ Result WindowsManager::SetUserData(ControllerHandle controller, void* userData)
 
 WindowsManager::ControllerHandle WindowsManager::OnControllerConnected(WindowsControllerData controllerData) {
     auto handle = this->controllers.Add(std::move(controllerData));
+    auto& addedData = this->controllers[handle];
+    this->controllersByPath.emplace(DeviceKey(addedData.devicePath), handle);
     this->connectedControllers.push_back(handle);
+
+    // registered once the handle is known, so the removal of this device doesn't need a lookup
+    addedData.notificationContext = std::make_unique<DeviceNotificationContext>(DeviceNotificationContext{this, handle.ToBits(), addedData.devicePath});
+    CM_NOTIFY_FILTER filter{};
+    filter.cbSize = sizeof(filter);
+    filter.FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEHANDLE;
+    filter.u.DeviceHandle.hTarget = addedData.hidHandle.handle;
+    CM_Register_Notification(&filter, addedData.notificationContext.get(), SpecificDeviceNotificationCallback,
+                             reinterpret_cast<HCMNOTIFICATION*>(&addedData.deviceNotification.handle));
+
     onConnected(handle);
     return handle;
 }
@@ -276,7 +461,8 @@ void WindowsManager::OnControllerDisconnect(ControllerHandle controller) {
     onDisconnect(controller);
     this->connectedControllers.erase(std::remove(this->connectedControllers.begin(), this->connectedControllers.end(), controller),
                                      this->connectedControllers.end());
+    this->controllersByPath.erase(DeviceKey(this->controllers[controller].devicePath));
     this->controllers.Remove(controller);
 }
 
-} // namespace ds
\ No newline at end of file
+} // namespace ds